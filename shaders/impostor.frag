@@ -0,0 +1,57 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ViewPosition;
+flat in vec3 Center;
+flat in float Radius;
+flat in vec4 InverseRotation;
+
+uniform mat4 projection;
+uniform mat3 inverseView;  // view to world rotation
+uniform sampler2D bodyTexture;
+
+const float PI = 3.14159265359;
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+// Of two derivatives of the same longitude, the one without the jump
+float seamless(float wrapped, float shifted)
+{
+    return abs(wrapped) < abs(shifted) ? wrapped : shifted;
+}
+
+void main()
+{
+    // Nearest hit of the eye ray with the sphere. Everything is computed
+    // before a miss is discarded, so the derivatives below stay defined
+    vec3 ray = normalize(ViewPosition);
+    float along = dot(ray, Center);
+    float h = along * along - (dot(Center, Center) - Radius * Radius);
+    vec3 hit = ray * (along - sqrt(max(h, 0.0)));
+
+    // Mapped like the mesh: u from +x towards +z around the body's axis, v
+    // from the north pole down. Normalised rather than divided by the
+    // radius: far away the hit is off the surface by enough for asin to
+    // smear the poles
+    vec3 normal = rotate(InverseRotation, inverseView * normalize(hit - Center));
+    float longitude = atan(normal.z, normal.x) / (2.0 * PI);  // -0.5..0.5
+    vec2 uv = vec2(fract(longitude),
+                   0.5 - asin(clamp(normal.y, -1.0, 1.0)) / PI);
+
+    // uv.x jumps where longitude is 0 and longitude where it is 0.5; the
+    // smaller derivative is the true one, so the seam keeps its mip level
+    vec2 dx = vec2(seamless(dFdx(uv.x), dFdx(longitude)), dFdx(uv.y));
+    vec2 dy = vec2(seamless(dFdy(uv.x), dFdy(longitude)), dFdy(uv.y));
+    FragColor = textureGrad(bodyTexture, uv, dx, dy);
+
+    vec4 clip = projection * vec4(hit, 1.0);
+    gl_FragDepth = (gl_DepthRange.diff * clip.z / clip.w +
+                    gl_DepthRange.near + gl_DepthRange.far) * 0.5;
+
+    if (h < 0.0) {
+        discard;
+    }
+}
@@ -0,0 +1,40 @@
+#version 330 core
+// One quad per sphere, facing the eye and just large enough to hold its
+// silhouette; the fragment shader ray-casts the sphere inside it
+layout (location = 0) in vec2 aCorner;            // -1..1
+layout (location = 1) in vec4 aSphere;            // world centre, radius
+layout (location = 2) in vec4 aInverseRotation;   // world to body quaternion
+
+out vec3 ViewPosition;
+flat out vec3 Center;
+flat out float Radius;
+flat out vec4 InverseRotation;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    vec3 center = (view * vec4(aSphere.xyz, 1.0)).xyz;
+    float radius = aSphere.w;
+
+    vec3 axis = normalize(center);
+    vec3 side = cross(axis, vec3(0.0, 1.0, 0.0));
+    if (dot(side, side) < 1e-6) {
+        side = cross(axis, vec3(1.0, 0.0, 0.0));
+    }
+    side = normalize(side);
+    vec3 up = cross(side, axis);
+
+    // The rays grazing the sphere form a cone around the axis; through the
+    // centre it is wider than the radius
+    float distanceSquared = dot(center, center);
+    float extent = radius * sqrt(distanceSquared /
+                                 max(distanceSquared - radius * radius, 1e-6));
+
+    ViewPosition = center + (side * aCorner.x + up * aCorner.y) * extent;
+    Center = center;
+    Radius = radius;
+    InverseRotation = aInverseRotation;
+    gl_Position = projection * vec4(ViewPosition, 1.0);
+}
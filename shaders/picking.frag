@@ -0,0 +1,16 @@
+#version 330 core
+// Writes the body's handle (index + 1, generation); 0 is background
+layout (location = 0) out uvec2 BodyId;
+
+in vec2 TexCoord;
+uniform uvec2 bodyId;
+// Rings: texels the ring pass would discard do not pick either
+uniform bool alphaTest;
+uniform sampler2D alphaTexture;
+
+void main() {
+    if (alphaTest && texture(alphaTexture, TexCoord).a < 0.01) {
+        discard;
+    }
+    BodyId = bodyId;
+}
@@ -5,6 +5,7 @@
 #ifndef SOLAR_SYSTEM_OPENGL_APPCONFIG_H
 #define SOLAR_SYSTEM_OPENGL_APPCONFIG_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -12,10 +13,83 @@ struct AppConfig {
   static constexpr const char* WINDOW_NAME = "Solar System Simulation";
   static constexpr bool ENABLE_GL_DEPTH_TEST = true;
   static constexpr float TIME_SCALE = 1.0f;
+  // Orbits are stepped on their own thread at a fixed rate and interpolated
+  // for rendering; false steps them on the render thread every frame
+  static constexpr bool SIMULATION_THREAD = true;
+  static constexpr float SIMULATION_STEPS_PER_SECOND = 120.0f;
+  // Render on a dedicated thread that owns the GL context; the main thread
+  // then only pumps OS events and input, INPUT_POLL_RATE times a second, so
+  // a blocking swap never delays input
+  static constexpr bool RENDER_THREAD = false;
+  static constexpr double INPUT_POLL_RATE = 1000.0;
+  // Frame pacing (FramePacer). SWAP_INTERVAL: 0 vsync off, 1 on, -1
+  // adaptive. TARGET_FPS caps the frame rate, 0 leaves it to vsync. Low
+  // latency mode starts each frame as late as its cost allows, finishing
+  // LOW_LATENCY_SAFETY_MS before the deadline
+  static constexpr int SWAP_INTERVAL = 1;
+  static constexpr double TARGET_FPS = 60.0;
+  static constexpr bool LOW_LATENCY_MODE = false;
+  static constexpr double LOW_LATENCY_SAFETY_MS = 1.5;
+  // Only draw when input, the simulation, texture streaming or the HUD
+  // changed; otherwise sleep in glfwWaitEventsTimeout, waking every
+  // IDLE_TIMEOUT seconds to check. SOLAR_ON_DEMAND=0|1 overrides it
+  static constexpr bool ON_DEMAND_RENDERING = false;
+  static constexpr double ON_DEMAND_IDLE_TIMEOUT = 0.5;
   static constexpr unsigned int SCR_WIDTH = 1920;
   static constexpr  unsigned int SCR_HEIGHT = 1080;
   static const std::vector<std::string> SKYBOX_FACES;
+  // Produced by the bake_textures target, faces are used when it is missing
+  static constexpr const char* SKYBOX_BAKED = "../textures/skybox.ktx";
   static constexpr float DISTANCE_SCALE_FACTOR = 0.1f;
+  // Built by the pack_assets target; loose files are used when it is missing
+  static constexpr const char* ASSET_PACK_PATH = "../assets.pak";
+  // Logger output file next to the console output; "" logs to console only
+  static constexpr const char* LOG_FILE_PATH = "";
+  // Texture streaming
+  static constexpr unsigned int TEXTURE_LOADER_THREADS = 0;  // 0 = auto
+  static constexpr size_t TEXTURE_UPLOAD_BUDGET_BYTES = 16 * 1024 * 1024;
+  // Baked textures larger than MIN_RESIDENT_SIZE keep only the mips their
+  // on-screen size needs, within VRAM_BUDGET
+  static constexpr bool TEXTURE_STREAMING = true;
+  static constexpr size_t TEXTURE_STREAMING_VRAM_BUDGET = 256 * 1024 * 1024;
+  static constexpr unsigned int TEXTURE_STREAMING_MIN_RESIDENT_SIZE = 256;
+  // Memory budgets (MemoryTracker); categories near budget show red on the
+  // M page
+  static constexpr size_t GPU_TEXTURE_BUDGET_BYTES = 512 * 1024 * 1024;
+  static constexpr size_t GPU_MESH_BUDGET_BYTES = 64 * 1024 * 1024;
+  static constexpr size_t GPU_STREAMING_BUDGET_BYTES = 64 * 1024 * 1024;
+  static constexpr size_t CPU_TEXTURE_BUDGET_BYTES = 256 * 1024 * 1024;
+  // Transient per-frame data (UI strings, render queue);
+  // each thread bumps through its own SLICE of the block
+  static constexpr size_t FRAME_ARENA_BYTES = 2 * 1024 * 1024;
+  static constexpr size_t FRAME_ARENA_SLICE_BYTES = 64 * 1024;
+  // Body spatial index (SphereBvh): rebuilt and refitted on worker threads
+  // from this many bodies up
+  static constexpr size_t SPATIAL_INDEX_PARALLEL_MIN_BODIES = 16384;
+  // Pick with an ID pass read back from the GPU instead of casting a ray
+  // through the spatial index; the body nearest the crosshair within a
+  // REGION pixel square wins. SOLAR_GPU_PICKING=0|1 overrides it
+  static constexpr bool GPU_PICKING = false;
+  static constexpr unsigned int GPU_PICKING_REGION = 7;
+  // Bodies hidden behind large ones are culled against a software depth
+  // buffer of BUFFER_WIDTH x HEIGHT, rasterised by THREADS workers (0 = on
+  // the render thread). SOLAR_OCCLUSION_CULLING=0|1 overrides it
+  static constexpr bool OCCLUSION_CULLING = true;
+  static constexpr unsigned int OCCLUSION_BUFFER_WIDTH = 256;
+  static constexpr unsigned int OCCLUSION_BUFFER_HEIGHT = 128;
+  static constexpr size_t OCCLUSION_CULLING_THREADS = 2;
+  // Body meshes: each body draws the coarsest level of detail whose
+  // silhouette stays within MAX_ERROR_PIXELS of the true sphere, and only
+  // drops a level once it fits with HYSTERESIS to spare. Levels are
+  // subdivided icosahedra instead of UV spheres with ICOSPHERE
+  static constexpr float SPHERE_LOD_MAX_ERROR_PIXELS = 0.5f;
+  static constexpr float SPHERE_LOD_HYSTERESIS = 0.25f;
+  static constexpr bool SPHERE_LOD_ICOSPHERE = false;
+  // Bodies at most this many pixels in radius on screen are ray-cast on
+  // instanced quads instead of drawn as meshes. SOLAR_IMPOSTORS=0|1
+  // overrides IMPOSTORS
+  static constexpr bool IMPOSTORS = true;
+  static constexpr float IMPOSTOR_MAX_SCREEN_RADIUS = 24.0f;
 };
 
 #endif  // SOLAR_SYSTEM_OPENGL_APPCONFIG_H
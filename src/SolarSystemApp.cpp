@@ -11,13 +11,28 @@
 
 #include <graphics/buffer/BufferManager.h>
 #include <graphics/mesh/MeshGenerator.h>
-#include <rendering/renderables/scene/CelestialBody.h>
+#include <rendering/Scene.h>
 #include <rendering/renderables/scene/Skybox.h>
 
+#include <celestialbody/BodyComponents.h>
 #include <celestialbody/CelestialBodyFactory.h>
+#include <celestialbody/OrbitSimulation.h>
+#include <core/filesystem/VirtualFileSystem.h>
+#include <core/memory/AllocationTracker.h>
+#include <core/memory/FrameArena.h>
+#include <core/memory/MemoryTracker.h>
 
 #include <iostream>
 
+namespace {
+void applyBodyState(const BodyState& state, OrbitComponent& orbit,
+                    TransformComponent& transform) {
+  transform.position = state.position;
+  orbit.velocity = state.velocity;
+  orbit.angle = state.orbitAngle;
+}
+}  // namespace
+
 const std::vector<std::string> AppConfig::SKYBOX_FACES = {
     "../textures/skybox1.png",
     "../textures/skybox2.png",
@@ -37,6 +52,21 @@ bool SolarSystemApp::initialize() {
   try {
     std::cout << "Initializing Solar System Application..." << std::endl;
 
+    MemoryTracker::setBudget(MemoryCategory::Textures, MemoryDomain::GPU,
+                             AppConfig::GPU_TEXTURE_BUDGET_BYTES);
+    MemoryTracker::setBudget(MemoryCategory::Meshes, MemoryDomain::GPU,
+                             AppConfig::GPU_MESH_BUDGET_BYTES);
+    MemoryTracker::setBudget(MemoryCategory::StreamingBuffers,
+                             MemoryDomain::GPU,
+                             AppConfig::GPU_STREAMING_BUDGET_BYTES);
+    MemoryTracker::setBudget(MemoryCategory::Textures, MemoryDomain::CPU,
+                             AppConfig::CPU_TEXTURE_BUDGET_BYTES);
+    FrameArena::initialize(AppConfig::FRAME_ARENA_BYTES,
+                           AppConfig::FRAME_ARENA_SLICE_BYTES);
+
+    // Mounted before anything loads so every asset resolves through the pack
+    VirtualFileSystem::mount(AppConfig::ASSET_PACK_PATH);
+
     bufferManager_ = std::make_unique<BufferManager>();
     textureManager_ = std::make_unique<TextureManager>();
     meshGenerator_ = std::make_unique<MeshGenerator>();
@@ -44,8 +74,8 @@ bool SolarSystemApp::initialize() {
     engine_ = std::make_unique<Engine>(AppConfig::ENABLE_GL_DEPTH_TEST,
                                        *bufferManager_);
 
-    skybox_ = std::make_unique<Skybox>(*bufferManager_, *textureManager_);
-    renderables_.push_back(skybox_.get());
+    skybox_ = std::make_unique<Skybox>(*bufferManager_, *textureManager_,
+                                       engine_->getShaderManager());
 
     if (!initializePlanets(*bufferManager_, *textureManager_,
                            *meshGenerator_)) {
@@ -53,6 +83,10 @@ bool SolarSystemApp::initialize() {
       return false;
     }
 
+    if (AppConfig::SIMULATION_THREAD) {
+      startSimulation();
+    }
+
     std::cout << "Solar System Application initialized successfully!"
               << std::endl;
     return true;
@@ -66,52 +100,131 @@ bool SolarSystemApp::initialize() {
 bool SolarSystemApp::initializePlanets(BufferManager& bufferManager,
                                        TextureManager& textureManager,
                                        MeshGenerator& meshGenerator) {
-  CelestialBodyFactory::createSolarSystem(bufferManager, meshGenerator,
-                                          textureManager);
+  bodyRegistry_ = std::make_unique<BodyRegistry>(textureManager);
+  CelestialBodyFactory::createSolarSystem(*bodyRegistry_, bufferManager,
+                                          meshGenerator, textureManager);
 
-  auto& bodies = CelestialBodyFactory::getCelestialBodies();
-  if (bodies.empty()) {
+  if (bodyRegistry_->size() == 0) {
     std::cerr << "Failed to create any planets" << std::endl;
     return false;
   }
 
-  for (const auto& body : bodies) {
-    renderables_.push_back(body.get());
-  }
-
-  std::cout << "Created " << bodies.size() << " celestial bodies"
+  std::cout << "Created " << bodyRegistry_->size() << " celestial bodies"
             << std::endl;
+  bodyRegistry_->updateSpatialIndex();
 
   return true;
 }
 
 void SolarSystemApp::run() {
-  engine_->run([this](const Engine::FrameContext& frameContext) {
-    for (const auto& body : renderables_) {
-        body->update(frameContext.deltaTime * AppConfig::TIME_SCALE);
+  const Scene scene{*bodyRegistry_, skybox_.get(), *textureManager_};
+  engine_->run([this](Engine::FrameContext& frameContext) {
+    {
+      ALLOCATION_ZONE("STREAMING");
+      textureManager_->processPendingUploads(
+          AppConfig::TEXTURE_UPLOAD_BUDGET_BYTES);
+      textureManager_->updateStreaming(AppConfig::TEXTURE_UPLOAD_BUDGET_BYTES);
+
+      // Keep drawing while textures stream in, and once more after the
+      // last upload so it shows up
+      const bool streaming = textureManager_->hasPendingWork();
+      frameContext.needsRedraw |= streaming || wasStreaming_;
+      wasStreaming_ = streaming;
     }
 
-    if (frameContext.shouldTerminate) {
-      shutdown();
-      // glfwSetWindowShouldClose(, true);
+    {
+      ALLOCATION_ZONE("SIMULATION");
+      if (simulation_) {
+        simulation_->setPaused(frameContext.paused);
+        frameContext.needsRedraw |= applySimulationState();
+      } else if (!frameContext.paused) {
+        updateOrbits(frameContext.deltaTime * AppConfig::TIME_SCALE);
+        frameContext.needsRedraw = true;
+      }
+      // Picking and culling query the index, keep it on the new positions
+      if (frameContext.needsRedraw) {
+        bodyRegistry_->updateSpatialIndex();
+      }
     }
-  }, renderables_);
+  }, scene);
+
+  // The loop has returned, nothing of this frame is still running
+  shutdown();
+}
+
+void SolarSystemApp::startSimulation() {
+  std::vector<OrbitComponent> orbits;
+  std::vector<BodyState> states;
+  simulatedBodies_.clear();
+  bodyRegistry_->getWorld().each<const OrbitComponent,
+                                 const TransformComponent>(
+      [&](BodyHandle body, const OrbitComponent& orbit,
+          const TransformComponent& transform) {
+        simulatedBodies_.push_back(body);
+        orbits.push_back(orbit);
+        states.push_back({transform.position, orbit.velocity, orbit.angle});
+      });
+
+  bodyStates_ = states;
+  simulation_ = std::make_unique<OrbitSimulation>(
+      orbits, states, AppConfig::SIMULATION_STEPS_PER_SECOND,
+      AppConfig::TIME_SCALE);
+  simulation_->start();
+}
+
+void SolarSystemApp::updateOrbits(float deltaTime) {
+  bodyRegistry_->getWorld().each<OrbitComponent, TransformComponent>(
+      [deltaTime](Entity, OrbitComponent& orbit,
+                  TransformComponent& transform) {
+        BodyState state{transform.position, orbit.velocity, orbit.angle};
+        if (OrbitSimulation::advanceOrbit(orbit, state, deltaTime)) {
+          applyBodyState(state, orbit, transform);
+        }
+      });
+}
+
+bool SolarSystemApp::applySimulationState() {
+  const bool changed = simulation_->sample(bodyStates_);
+
+  // Snapshots are indexed like simulatedBodies_
+  World& world = bodyRegistry_->getWorld();
+  for (size_t i = 0; i < simulatedBodies_.size() && i < bodyStates_.size();
+       i++) {
+    auto* orbit = world.get<OrbitComponent>(simulatedBodies_[i]);
+    auto* transform = world.get<TransformComponent>(simulatedBodies_[i]);
+    if (orbit && transform) {
+      applyBodyState(bodyStates_[i], *orbit, *transform);
+    }
+  }
+  return changed;
 }
 
 void SolarSystemApp::shutdown() {
   std::cout << "\n=== Starting Solar System Cleanup ===\n";
 
+  // Stop stepping before the bodies it mirrors go away
+  if (simulation_) {
+    std::cout << "\nStopping simulation thread...\n" << std::endl;
+    simulation_.reset();
+  }
+
   if (skybox_) {
     std::cout << "\nDestroying skybox...\n" << std::endl;
     skybox_.reset();
   }
 
-  if (!renderables_.empty()) {
-    std::cout << "\nDestroying " << renderables_.size()
-              << " renderables...\n" << std::endl;
-    renderables_.clear();
+  simulatedBodies_.clear();
+  if (bodyRegistry_) {
+    std::cout << "\nDestroying " << bodyRegistry_->size()
+              << " celestial bodies...\n" << std::endl;
+    bodyRegistry_.reset();
+  }
+
+  // Textures own GL objects, release them while the context is still alive
+  if (textureManager_) {
+    std::cout << "\nDestroying texture manager...\n" << std::endl;
+    textureManager_.reset();
   }
-  CelestialBodyFactory::clear();
 
   if (meshGenerator_) {
     std::cout << "\nDestroying mesh generator...\n" << std::endl;
@@ -128,5 +241,12 @@ void SolarSystemApp::shutdown() {
     bufferManager_.reset();
   }
 
+  // Last: the engine's audio and any loaded asset may still view the pack
+  VirtualFileSystem::unmount();
+  FrameArena::shutdown();
+
+  // Anything still "current" here was never released
+  MemoryTracker::printReport();
+
   std::cout << "=== Solar System Cleanup Complete ===\n\n";
 }
\ No newline at end of file
@@ -6,10 +6,10 @@
 #define SOLAR_SYSTEM_APP_H
 
 
-#include <deque>
 #include <memory>
+#include <vector>
 
-#include <rendering/renderables/scene/ISceneRenderable.h>
+#include <celestialbody/BodyRegistry.h>
 
 class WindowManager;
 class InputManager;
@@ -23,6 +23,8 @@ class Ring;
 class TextRenderer;
 class MeshGenerator;
 class TextureManager;
+class OrbitSimulation;
+struct BodyState;
 
 class SolarSystemApp {
  public:
@@ -42,12 +44,21 @@ class SolarSystemApp {
   std::unique_ptr<Skybox> skybox_;
   std::unique_ptr<MeshGenerator> meshGenerator_;
   std::unique_ptr<TextureManager> textureManager_;
-
-  std::deque<ISceneRenderable*> renderables_;
+  std::unique_ptr<BodyRegistry> bodyRegistry_;
+  std::unique_ptr<OrbitSimulation> simulation_;
+  std::vector<BodyState> bodyStates_;  // interpolated each frame
+  // Each simulated body, in snapshot order
+  std::vector<BodyHandle> simulatedBodies_;
+  bool wasStreaming_ = false;
 
   bool initializePlanets(BufferManager& bufferManager,
                          TextureManager& textureManager,
                          MeshGenerator& meshGenerator);
+  void startSimulation();
+  // Steps the orbits on this thread (SIMULATION_THREAD off)
+  void updateOrbits(float deltaTime);
+  // true if a new simulation step arrived
+  bool applySimulationState();
 };
 
 #endif  // SOLAR_SYSTEM_APP_H
\ No newline at end of file
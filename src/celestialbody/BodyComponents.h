@@ -0,0 +1,57 @@
+#ifndef SOLAR_SYSTEM_OPENGL_BODYCOMPONENTS_H
+#define SOLAR_SYSTEM_OPENGL_BODYCOMPONENTS_H
+
+#include <CelestialBodyTypes.h>
+#include <core/resources/Handle.h>
+#include <graphics/mesh/MeshLod.h>
+
+#include "glm/detail/type_vec3.hpp"
+
+// Components of a celestial body entity. They are plain data stored in the
+// World's packed arrays; behaviour lives in the passes that query them.
+
+// Circular orbit around the origin. Bodies that do not orbit (the Sun) have
+// no OrbitComponent.
+struct OrbitComponent {
+  float semiMajorAxis;  // scene units
+  float eccentricity;
+  float period;  // seconds
+  float angle;   // current position in orbit (radians)
+  glm::vec3 velocity;
+};
+
+struct TransformComponent {
+  glm::vec3 position;
+  glm::vec3 scale;
+  glm::vec3 rotationAxis;
+  float rotationSpeed;  // degrees per second of scene time
+};
+
+// Textured sphere drawn with the shared body mesh and shader. The VAO and
+// its levels of detail belong to a mesh the BodyRegistry keeps alive; the
+// body owns one reference to its texture, released with the body.
+struct RenderComponent {
+  unsigned int vao;
+  unsigned int indexCount;  // drawn from the first index without lods
+  TextureHandle texture;
+  // Ranges of the VAO's indices, finest first; picked per frame from the
+  // body's size on screen
+  const MeshLodChain* lods = nullptr;
+};
+
+// Flat ring quad around the body, drawn after every opaque body
+struct RingComponent {
+  unsigned int vao;
+  unsigned int indexCount;
+  TextureHandle texture;
+  float extent;  // quad width in model space
+};
+
+struct MetadataComponent {
+  BodyType type;
+  float mass;    // kg
+  float radius;  // meters
+  const char* texturePath;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_BODYCOMPONENTS_H
@@ -0,0 +1,200 @@
+#include "BodyRegistry.h"
+
+#include <AppConfig.h>
+#include <celestialbody/BodyComponents.h>
+#include <core/memory/MemoryTracker.h>
+#include <core/texturing/TextureManager.h>
+#include <core/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <utility>
+
+BodyRegistry::BodyRegistry(TextureManager& textureManager)
+    : textureManager_(textureManager) {}
+
+BodyRegistry::~BodyRegistry() { clear(); }
+
+void BodyRegistry::addRecord(BodyHandle handle, BodyId id,
+                             const std::string& name, const BodyInfo& info) {
+  if (records_.size() <= handle.index) {
+    records_.resize(handle.index + 1);
+  }
+  records_[handle.index] = {id, info, bodies_.size()};
+  records_[handle.index].info.name = name;
+  bodies_.push_back(handle);
+  byId_.emplace(id, handle);
+  byName_.emplace(name, handle);
+  indexDirty_ = true;
+  updateTrackedBytes();
+}
+
+void BodyRegistry::remove(BodyHandle handle) {
+  if (!isValid(handle)) {
+    return;
+  }
+  const Record& record = records_[handle.index];
+  byId_.erase(record.id);
+  byName_.erase(record.info.name);
+
+  // Swap-remove keeps the list packed, as HandlePool does for its values
+  const BodyHandle last = bodies_.back();
+  bodies_[record.position] = last;
+  records_[last.index].position = record.position;
+  bodies_.pop_back();
+  records_[handle.index] = {};
+  releaseResources(handle);
+  world_.destroy(handle);
+  indexDirty_ = true;
+  updateTrackedBytes();
+}
+
+void BodyRegistry::clear() {
+  for (const BodyHandle handle : bodies_) {
+    releaseResources(handle);
+  }
+  world_.clear();
+  bodies_.clear();
+  records_.clear();
+  byId_.clear();
+  byName_.clear();
+  sharedMeshes_.clear();
+  sharedLods_.clear();
+  spatialIndex_.clear();
+  indexedBodies_.clear();
+  indexedSpheres_.clear();
+  indexDirty_ = true;
+  updateTrackedBytes();
+}
+
+bool BodyRegistry::isValid(BodyHandle handle) const {
+  return world_.isAlive(handle);
+}
+
+BodyHandle BodyRegistry::findById(BodyId id) const {
+  const auto it = byId_.find(id);
+  return it == byId_.end() ? BodyHandle{} : it->second;
+}
+
+BodyHandle BodyRegistry::findByName(std::string_view name) const {
+  const auto it = byName_.find(normalizeName(name));
+  return it == byName_.end() ? BodyHandle{} : it->second;
+}
+
+const BodyInfo* BodyRegistry::getInfo(BodyHandle handle) const {
+  return isValid(handle) ? &records_[handle.index].info : nullptr;
+}
+
+BodyId BodyRegistry::getId(BodyHandle handle) const {
+  return isValid(handle) ? records_[handle.index].id : 0;
+}
+
+unsigned int BodyRegistry::addSharedMesh(BufferHandle mesh) {
+  const unsigned int vao = mesh.getVAO();
+  sharedMeshes_.push_back(std::move(mesh));
+  return vao;
+}
+
+const MeshLodChain* BodyRegistry::addSharedLods(MeshLodChain lods) {
+  sharedLods_.push_back(std::move(lods));
+  return &sharedLods_.back();
+}
+
+void BodyRegistry::updateSpatialIndex() {
+  // Sphere ids follow the world's iteration order, which only changes when
+  // bodies or their components are added or removed; components changed
+  // through getWorld() bypass indexDirty_, so the order is checked as well
+  const bool wasDirty = indexDirty_;
+  if (wasDirty) {
+    indexedBodies_.clear();
+  }
+  indexedSpheres_.clear();
+  world_.each<const TransformComponent>(
+      [&](Entity body, const TransformComponent& transform) {
+        const size_t sphere = indexedSpheres_.size();
+        if (wasDirty) {
+          indexedBodies_.push_back(body);
+        } else if (sphere >= indexedBodies_.size() ||
+                   indexedBodies_[sphere] != body) {
+          indexDirty_ = true;
+          indexedBodies_.resize(sphere);
+          indexedBodies_.push_back(body);
+        }
+        const glm::vec3& scale = transform.scale;
+        indexedSpheres_.emplace_back(
+            transform.position, std::max(scale.x, std::max(scale.y, scale.z)));
+      });
+  if (indexedBodies_.size() != indexedSpheres_.size()) {
+    indexDirty_ = true;
+    indexedBodies_.resize(indexedSpheres_.size());
+  }
+
+  ThreadPool* pool = nullptr;
+  if (indexedSpheres_.size() >= AppConfig::SPATIAL_INDEX_PARALLEL_MIN_BODIES) {
+    if (!indexPool_) {
+      indexPool_ = std::make_unique<ThreadPool>();
+    }
+    pool = indexPool_.get();
+  }
+
+  if (indexDirty_ || spatialIndex_.size() != indexedSpheres_.size() ||
+      spatialIndex_.isDegraded()) {
+    spatialIndex_.build(indexedSpheres_.data(), indexedSpheres_.size(), pool);
+    indexDirty_ = false;
+    updateTrackedBytes();
+  } else {
+    spatialIndex_.refit(indexedSpheres_.data(), indexedSpheres_.size(), pool);
+  }
+}
+
+BodyHandle BodyRegistry::raycast(const glm::vec3& origin,
+                                 const glm::vec3& direction,
+                                 float& distance) const {
+  SphereBvh::RayHit hit;
+  if (!spatialIndex_.raycast(origin, direction,
+                             std::numeric_limits<float>::max(), hit)) {
+    return {};
+  }
+  distance = hit.distance;
+  return indexedBodies_[hit.sphere];
+}
+
+void BodyRegistry::queryNearest(const glm::vec3& point, size_t k,
+                                std::vector<BodyHandle>& out) const {
+  std::vector<SphereBvh::Neighbor> neighbors;
+  spatialIndex_.queryNearest(point, k, neighbors);
+  out.clear();
+  for (const SphereBvh::Neighbor& neighbor : neighbors) {
+    out.push_back(indexedBodies_[neighbor.sphere]);
+  }
+}
+
+void BodyRegistry::releaseResources(BodyHandle handle) {
+  if (const auto* render = world_.get<RenderComponent>(handle)) {
+    textureManager_.releaseTexture(render->texture);
+  }
+  if (const auto* ring = world_.get<RingComponent>(handle)) {
+    textureManager_.releaseTexture(ring->texture);
+  }
+}
+
+void BodyRegistry::updateTrackedBytes() {
+  const size_t bytes =
+      world_.getComponentBytes() + records_.size() * sizeof(Record) +
+      spatialIndex_.getMemoryBytes() +
+      indexedBodies_.capacity() * sizeof(BodyHandle) +
+      indexedSpheres_.capacity() * sizeof(glm::vec4);
+  MemoryTracker::resize(MemoryCategory::Simulation, MemoryDomain::CPU,
+                        trackedBytes_, bytes);
+  trackedBytes_ = bytes;
+}
+
+std::string BodyRegistry::normalizeName(std::string_view name) {
+  // Names are shown on the HUD, whose font only has upper case
+  std::string normalized(name);
+  for (char& c : normalized) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+  return normalized;
+}
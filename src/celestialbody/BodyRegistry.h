@@ -0,0 +1,143 @@
+#ifndef SOLAR_SYSTEM_OPENGL_BODYREGISTRY_H
+#define SOLAR_SYSTEM_OPENGL_BODYREGISTRY_H
+
+#include <CelestialBodyTypes.h>
+#include <core/ecs/World.h>
+#include <core/spatial/SphereBvh.h>
+#include <graphics/buffer/BufferHandle.h>
+#include <graphics/mesh/MeshLod.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class TextureManager;
+class ThreadPool;
+
+// A body's handle is its entity: generational, so a handle to a removed
+// body is rejected instead of resolving to whatever reused its slot
+using BodyHandle = Entity;
+// Stable catalog id (NAIF ids for the solar system), unlike handles it
+// survives a reload
+using BodyId = uint32_t;
+
+// Owns the body entities, their names and catalog ids, and the GPU meshes
+// they share. Every lookup (handle, id or name) is O(1), and there is no
+// limit on the number of bodies.
+class BodyRegistry {
+ public:
+  // Bodies hand their texture references back to textureManager when they
+  // are removed, so it must outlive the registry
+  explicit BodyRegistry(TextureManager& textureManager);
+  ~BodyRegistry();
+
+  BodyRegistry(const BodyRegistry&) = delete;
+  BodyRegistry& operator=(const BodyRegistry&) = delete;
+
+  // Creates a body entity with the given components, which take over the
+  // texture references in them. Returns an invalid handle if the id or name
+  // is already taken; the references then stay with the caller.
+  template <typename... Ts>
+  BodyHandle add(BodyId id, const BodyInfo& info, const Ts&... components) {
+    const std::string name = normalizeName(info.name);
+    if (byId_.count(id) > 0 || byName_.count(name) > 0) {
+      return {};
+    }
+    const BodyHandle handle = world_.create(components...);
+    addRecord(handle, id, name, info);
+    return handle;
+  }
+
+  void remove(BodyHandle handle);
+  void clear();
+
+  bool isValid(BodyHandle handle) const;
+  // Invalid handle if there is no such body
+  BodyHandle findById(BodyId id) const;
+  // Case-insensitive
+  BodyHandle findByName(std::string_view name) const;
+
+  // nullptr for an invalid handle
+  const BodyInfo* getInfo(BodyHandle handle) const;
+  BodyId getId(BodyHandle handle) const;
+
+  // Every body once; removal moves the last body into the gap, so the
+  // order is only stable while nothing is removed
+  const std::vector<BodyHandle>& getBodies() const { return bodies_; }
+  size_t size() const { return bodies_.size(); }
+
+  World& getWorld() { return world_; }
+  const World& getWorld() const { return world_; }
+
+  // Keeps a mesh alive for as long as the bodies may reference it; returns
+  // its VAO
+  unsigned int addSharedMesh(BufferHandle mesh);
+  // Keeps the levels of detail of a shared mesh for as long as the bodies
+  // may reference them; the pointer is stable until clear()
+  const MeshLodChain* addSharedLods(MeshLodChain lods);
+
+  // Spatial queries run on a BVH over the bodies' bounding spheres (the
+  // transform's position and largest scale axis) as of the last
+  // updateSpatialIndex(), which refits it after the bodies moved and
+  // rebuilds it after adds, removes or once refitting has loosened it.
+  // Until then a removed body may still be reported; check isValid().
+  void updateSpatialIndex();
+  // Nearest body the ray hits, distance in units of the direction's length;
+  // invalid handle on a miss
+  BodyHandle raycast(const glm::vec3& origin, const glm::vec3& direction,
+                     float& distance) const;
+  // f(handle) for each body not fully outside the frustum planes
+  template <typename F>
+  void queryFrustum(const SphereBvh::Frustum& frustum, F&& f) const {
+    spatialIndex_.queryFrustum(
+        frustum, [&](uint32_t sphere) { f(indexedBodies_[sphere]); });
+  }
+  // f(handle) for each body within radius of center
+  template <typename F>
+  void queryRadius(const glm::vec3& center, float radius, F&& f) const {
+    spatialIndex_.queryRadius(
+        center, radius, [&](uint32_t sphere) { f(indexedBodies_[sphere]); });
+  }
+  // Up to k bodies whose surfaces are closest to point, nearest first
+  void queryNearest(const glm::vec3& point, size_t k,
+                    std::vector<BodyHandle>& out) const;
+  const SphereBvh& getSpatialIndex() const { return spatialIndex_; }
+
+ private:
+  struct Record {
+    BodyId id = 0;
+    BodyInfo info;
+    size_t position = 0;  // in bodies_, for O(1) removal
+  };
+
+  TextureManager& textureManager_;
+  World world_;
+  std::vector<BodyHandle> bodies_;
+  // Indexed by handle index
+  std::vector<Record> records_;
+  std::unordered_map<BodyId, BodyHandle> byId_;
+  std::unordered_map<std::string, BodyHandle> byName_;
+  std::vector<BufferHandle> sharedMeshes_;
+  std::deque<MeshLodChain> sharedLods_;
+  size_t trackedBytes_ = 0;
+
+  SphereBvh spatialIndex_;
+  // Indexed by BVH sphere id
+  std::vector<BodyHandle> indexedBodies_;
+  std::vector<glm::vec4> indexedSpheres_;
+  bool indexDirty_ = true;
+  // Created once there are enough bodies to build in parallel
+  std::unique_ptr<ThreadPool> indexPool_;
+
+  void addRecord(BodyHandle handle, BodyId id, const std::string& name,
+                 const BodyInfo& info);
+  void releaseResources(BodyHandle handle);
+  void updateTrackedBytes();
+  static std::string normalizeName(std::string_view name);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_BODYREGISTRY_H
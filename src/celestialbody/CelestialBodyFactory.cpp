@@ -4,39 +4,103 @@
 #include "CelestialBodyFactory.h"
 
 #include <AppConfig.h>
-#include <rendering/renderables/scene/CelestialBody.h>
-
-std::vector<std::unique_ptr<CelestialBody>> CelestialBodyFactory::celestialBodies_;
+#include <celestialbody/BodyComponents.h>
+#include <core/texturing/TextureManager.h>
+#include <graphics/buffer/BufferManager.h>
+#include <graphics/mesh/MeshGenerator.h>
+
+#include <iostream>
+
+namespace {
+constexpr float RING_EXTENT = 6.0f;  // ring quad width in model space
+constexpr unsigned int RING_INDEX_COUNT = 6;
+
+const std::vector<VertexAttribute>& meshAttributes() {
+  static const std::vector<VertexAttribute> attributes = {
+      // position
+      {0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0},
+      // texCoord
+      {1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
+       (void*)(3 * sizeof(float))}};
+  return attributes;
+}
+}  // namespace
 
 void CelestialBodyFactory::createSolarSystem(
-    BufferManager& bufferManager, MeshGenerator& meshGenerator,
-    TextureManager& textureManager) {
-  const auto configs = getSolarSystemConfig();
-
-  for (const auto& config : configs) {
-    BodyProps bodyProps{config.type,
-                        config.mass,
-                        config.radius,
-                        config.semiMajorAxis,  // FIX: was orbitalPeriod (wrong!)
-                        config.eccentricity,
-                        config.orbitalPeriod,
-                        config.currentRotationAngle,
-                        config.position,
-                        config.velocity,
-                        config.texturePath,
-                        config.hasRing};
-    celestialBodies_.push_back(
-        std::make_unique<CelestialBody>(bodyProps, bufferManager, meshGenerator, textureManager));
-  }
-}
+    BodyRegistry& registry, BufferManager& bufferManager,
+    MeshGenerator& meshGenerator, TextureManager& textureManager) {
+  // Unit sphere at every level of detail, scaled per body by its
+  // transform. The CPU copy is only needed for the upload.
+  const SphereLodMeshData sphere = meshGenerator.generateSphereLods(
+      1.0f, AppConfig::SPHERE_LOD_ICOSPHERE ? SphereTopology::Icosphere
+                                            : SphereTopology::Uv);
+  const unsigned int sphereVAO = registry.addSharedMesh(
+      bufferManager.createBufferSet("Body_Sphere", sphere.vertices,
+                                    sphere.indices, meshAttributes()));
+  const MeshLodChain* sphereLods = registry.addSharedLods(sphere.lods);
+
+  unsigned int ringVAO = 0;
+  for (const auto& config : getSolarSystemConfig()) {
+    const TransformComponent transform{config.position, getScale(config.type),
+                                       getRotationAxis(config.type),
+                                       getRotationSpeed(config.type)};
+    const RenderComponent render{
+        sphereVAO, sphere.lods.front().indexCount,
+        textureManager.createTexture(config.texturePath, GL_TEXTURE_2D,
+                                     GL_REPEAT, GL_LINEAR),
+        sphereLods};
+    const MetadataComponent metadata{config.type, config.mass, config.radius,
+                                     config.texturePath};
+    const OrbitComponent orbit{config.semiMajorAxis, config.eccentricity,
+                               config.orbitalPeriod,
+                               config.currentRotationAngle, config.velocity};
+    const BodyId id = getCatalogId(config.type);
+    const BodyInfo& info = getBodyInfo(config.type);
+
+    // The component set picks the archetype: the Sun does not orbit, and
+    // only ringed bodies carry a RingComponent
+    BodyHandle body;
+    if (config.orbitalPeriod <= 0.0f) {
+      body = registry.add(id, info, transform, render, metadata);
+    } else if (config.hasRing) {
+      if (ringVAO == 0) {
+        const float half = RING_EXTENT * 0.5f;
+        const std::vector ringVertices = {
+            // Positions (x, y, z)  // Texture coords (u, v)
+            -half, 0.0f, -half,     0.0f, 0.0f,  // Bottom left
+            half,  0.0f, -half,     1.0f, 0.0f,  // Bottom right
+            half,  0.0f, half,      1.0f, 1.0f,  // Top right
+            -half, 0.0f, half,      0.0f, 1.0f   // Top left
+        };
+        const std::vector<unsigned int> ringIndices = {0, 1, 2, 2, 3, 0};
+        ringVAO = registry.addSharedMesh(bufferManager.createBufferSet(
+            "Body_Ring", ringVertices, ringIndices, meshAttributes()));
+      }
+      // Every ringed body holds its own reference to the shared texture
+      const RingComponent ring{
+          ringVAO, RING_INDEX_COUNT,
+          textureManager.createTexture("../textures/saturn_ring.png",
+                                       GL_TEXTURE_2D, GL_CLAMP_TO_EDGE,
+                                       GL_LINEAR),
+          RING_EXTENT};
+      body = registry.add(id, info, orbit, transform, render, ring, metadata);
+      if (!body.isValid()) {
+        textureManager.releaseTexture(ring.texture);
+      }
+    } else {
+      body = registry.add(id, info, orbit, transform, render, metadata);
+    }
 
-const std::vector<std::unique_ptr<CelestialBody>>& CelestialBodyFactory::getCelestialBodies() {
-  return celestialBodies_;
-}
+    if (!body.isValid()) {
+      textureManager.releaseTexture(render.texture);
+      std::cerr << "Body " << info.name << " (" << id
+                << ") is already registered" << std::endl;
+    }
+  }
 
-void CelestialBodyFactory::clear() {
-  celestialBodies_.clear();
-  std::cout << "CelestialBodyFactory::clear()" << std::endl;
+  std::cout << "Created " << registry.size() << " body entities in "
+            << registry.getWorld().getArchetypeCount() << " archetypes"
+            << std::endl;
 }
 
 std::vector<BodyProps> CelestialBodyFactory::getSolarSystemConfig() {
@@ -151,36 +215,38 @@ glm::vec3 CelestialBodyFactory::getRotationAxis(const BodyType type) {
   return glm::vec3(0.0f, 1.0f, 0.1f);  // Standard rotation
 }
 
-BodyInfo CelestialBodyFactory::getBodyInfo(const BodyType type) {
-  switch (type) {
-    case Sun:
-      return {"SUN", 0.0f, 5505.0f, "STAR", 333000.0f, 1392700.0f, 0};
-    case Mercury:
-      return {"MERCURY", 0.39f, 167.0f, "TERRESTRIAL", 0.055f, 4879.0f, 0};
-    case Venus:
-      return {"VENUS", 0.72f, 464.0f, "TERRESTRIAL", 0.815f, 12104.0f, 0};
-    case Earth:
-      return {"EARTH", 1.0f, 15.0f, "TERRESTRIAL", 1.0f, 12742.0f, 1};
-    case Mars:
-      return {"MARS", 1.52f, -65.0f, "TERRESTRIAL", 0.107f, 6779.0f, 2};
-    case Jupiter:
-      return {"JUPITER", 5.20f, -110.0f, "GAS GIANT", 317.8f, 139820.0f, 79};
-    case Saturn:
-      return {"SATURN", 9.58f, -140.0f, "GAS GIANT", 95.2f, 116460.0f, 82};
-    case Uranus:
-      return {"URANUS", 19.22f, -195.0f, "ICE GIANT", 14.5f, 50724.0f, 27};
-    case Neptune:
-      return {"NEPTUNE", 30.05f, -200.0f, "ICE GIANT", 17.1f, 49244.0f, 14};
-    default:
-      return {"UNKNOWN", 0.0f, 0.0f, "UNKNOWN", 0.0f, 0.0f, 0};
+const BodyInfo& CelestialBodyFactory::getBodyInfo(const BodyType type) {
+  // Built once and indexed by BodyType, so the per-frame UI lookups copy
+  // nothing
+  static const BodyInfo bodyInfos[] = {
+      {"SUN", 0.0f, 5505.0f, "STAR", 333000.0f, 1392700.0f, 0},
+      {"MERCURY", 0.39f, 167.0f, "TERRESTRIAL", 0.055f, 4879.0f, 0},
+      {"VENUS", 0.72f, 464.0f, "TERRESTRIAL", 0.815f, 12104.0f, 0},
+      {"EARTH", 1.0f, 15.0f, "TERRESTRIAL", 1.0f, 12742.0f, 1},
+      {"MARS", 1.52f, -65.0f, "TERRESTRIAL", 0.107f, 6779.0f, 2},
+      {"JUPITER", 5.20f, -110.0f, "GAS GIANT", 317.8f, 139820.0f, 79},
+      {"SATURN", 9.58f, -140.0f, "GAS GIANT", 95.2f, 116460.0f, 82},
+      {"URANUS", 19.22f, -195.0f, "ICE GIANT", 14.5f, 50724.0f, 27},
+      {"NEPTUNE", 30.05f, -200.0f, "ICE GIANT", 17.1f, 49244.0f, 14},
+      {"UNKNOWN", 0.0f, 0.0f, "UNKNOWN", 0.0f, 0.0f, 0}};
+
+  if (type < Sun || type > Unknown) {
+    return bodyInfos[Unknown];
   }
+  return bodyInfos[type];
 }
 
-BodyProps CelestialBodyFactory::getBodyProps(const BodyType type) {
-  for (auto& body : celestialBodies_) {
-    if (body->getBodyProps().type == type) {
-      return body->getBodyProps();
-    }
+BodyId CelestialBodyFactory::getCatalogId(const BodyType type) {
+  switch (type) {
+    case Sun: return 10;
+    case Mercury: return 199;
+    case Venus: return 299;
+    case Earth: return 399;
+    case Mars: return 499;
+    case Jupiter: return 599;
+    case Saturn: return 699;
+    case Uranus: return 799;
+    case Neptune: return 899;
+    default: return 0;
   }
-  return {};
-}
\ No newline at end of file
+}
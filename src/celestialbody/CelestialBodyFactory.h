@@ -6,32 +6,30 @@
 #define PLANET_FACTORY_H
 
 #include <CelestialBodyTypes.h>
+#include <celestialbody/BodyRegistry.h>
 
-#include <memory>
 #include <vector>
 
-class CelestialBody;
 class BufferManager;
 class MeshGenerator;
 class TextureManager;
 
 class CelestialBodyFactory {
  public:
-  static void createSolarSystem(BufferManager& bufferManager,
+  // Adds one body per configured planet to the registry. Every body shares
+  // one sphere mesh; only the texture differs.
+  static void createSolarSystem(BodyRegistry& registry,
+                                BufferManager& bufferManager,
                                 MeshGenerator& meshGenerator,
                                 TextureManager& textureManager);
-  static const std::vector<std::unique_ptr<CelestialBody>>& getCelestialBodies();
-  static void clear();
 
   static std::vector<BodyProps> getSolarSystemConfig();
   static float getRotationSpeed(BodyType type);
   static glm::vec3 getScale(BodyType type);
   static glm::vec3 getRotationAxis(BodyType type);
-  static BodyInfo getBodyInfo(BodyType type);
-  static BodyProps getBodyProps(BodyType type);
-
- private:
-  static std::vector<std::unique_ptr<CelestialBody>> celestialBodies_;
+  static const BodyInfo& getBodyInfo(BodyType type);
+  // NAIF id of the planet (199 Mercury ... 899 Neptune, 10 the Sun)
+  static BodyId getCatalogId(BodyType type);
 };
 
 #endif  // PLANET_FACTORY_H
\ No newline at end of file
@@ -4,66 +4,42 @@
 
 #include "CelestialBodyPicker.h"
 
-#include <celestialbody/CelestialBodyFactory.h>
 #include <core/Camera.h>
-#include <helpers/RayIntersection.h>
-#include <rendering/renderables/scene/CelestialBody.h>
+#include <core/logging/Logger.h>
 
-#include <iostream>
 #include <limits>
 
 CelestialBodyPicker::SelectionResult CelestialBodyPicker::pickBody(
-    const Camera& camera,
-    const std::function<void(int)>& onBodyPicked) {
-
-
-  SelectionResult result{false, 0, std::numeric_limits<float>::max()};
-  auto& celestialBodies = CelestialBodyFactory::getCelestialBodies();
+    const Camera& camera, const BodyRegistry& registry,
+    const std::function<void(BodyHandle)>& onBodyPicked) {
+  SelectionResult result{false, BodyHandle{},
+                         std::numeric_limits<float>::max()};
 
   glm::vec3 rayOrigin = camera.Position;
   glm::vec3 rayDirection = camera.getRayDirection();
 
-  std::cout << "Ray Origin: (" << rayOrigin.x << ", " << rayOrigin.y << ", "
-            << rayOrigin.z << ")" << std::endl;
-  std::cout << "Ray Direction: (" << rayDirection.x << ", " << rayDirection.y
-            << ", " << rayDirection.z << ")" << std::endl;
-
-  for (size_t i = 0; i < celestialBodies.size(); i++) {
-    float sphereRadius = CelestialBodyFactory::getScale(celestialBodies[i]->getBodyProps().type).x;
-    float distance;
-
-    if (RayIntersection::raySphereIntersection(
-            rayOrigin, rayDirection,
-            celestialBodies[i]->getBodyProps().position, sphereRadius,
-            distance)) {
-      std::cout << "  Hit planet " << i << " at distance " << distance
-                << " (radius: " << sphereRadius << ")" << std::endl;
-
-      if (distance < result.distance) {
-        result.hit = true;
-        result.planetIndex = i;
-        result.distance = distance;
-      }
-    }
+  LOG_DEBUG("Ray origin: (%.2f, %.2f, %.2f) direction: (%.3f, %.3f, %.3f)",
+            rayOrigin.x, rayOrigin.y, rayOrigin.z, rayDirection.x,
+            rayDirection.y, rayDirection.z);
+
+  float distance;
+  const BodyHandle body =
+      registry.raycast(rayOrigin, rayDirection, distance);
+  if (registry.isValid(body)) {
+    LOG_TRACE("  Hit body %u at distance %.2f", registry.getId(body),
+              distance);
+    result.hit = true;
+    result.body = body;
+    result.distance = distance;
   }
 
-  int selectedPlanetIndex = -1;
   if (result.hit) {
-    std::cout << "Selected body: "
-              << CelestialBodyFactory::getBodyInfo(
-                     celestialBodies[result.planetIndex]->getBodyProps().type)
-                     .name
-              << std::endl;
-    selectedPlanetIndex = static_cast<int>(result.planetIndex);
-
-    if (selectedPlanetIndex >= 0 &&
-        selectedPlanetIndex < static_cast<int>(celestialBodies.size())) {
-    }
+    LOG_INFO("Selected body: %s",
+             registry.getInfo(result.body)->name.c_str());
   } else {
-    selectedPlanetIndex = -1;
-    std::cout << "No celestial body selected" << std::endl;
+    LOG_DEBUG("No celestial body selected");
   }
 
-  onBodyPicked(selectedPlanetIndex);
+  onBodyPicked(result.body);
   return result;
 }
\ No newline at end of file
@@ -4,26 +4,23 @@
 
 #ifndef SOLAR_SYSTEM_OPENGL_CELESTIALBODYPICKER_H
 #define SOLAR_SYSTEM_OPENGL_CELESTIALBODYPICKER_H
-#include <functional>
-#include <memory>
-#include <vector>
+#include <celestialbody/BodyRegistry.h>
 
-#include "glm/detail/type_vec.hpp"
+#include <functional>
 
 class Camera;
-class CelestialBody;
 
 class CelestialBodyPicker {
   struct SelectionResult {
     bool hit;
-    size_t planetIndex;
+    BodyHandle body;  // invalid if nothing was hit
     float distance;
   };
 
  public:
   static SelectionResult pickBody(
-      const Camera& camera,
-      const std::function<void(int)>& onBodyPicked);
+      const Camera& camera, const BodyRegistry& registry,
+      const std::function<void(BodyHandle)>& onBodyPicked);
 };
 
 #endif  // SOLAR_SYSTEM_OPENGL_CELESTIALBODYPICKER_H
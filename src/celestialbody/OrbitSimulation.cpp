@@ -0,0 +1,205 @@
+#include "OrbitSimulation.h"
+
+#include <utils/math_utils.h>
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+OrbitSimulation::OrbitSimulation(const std::vector<OrbitComponent>& orbits,
+                                 const std::vector<BodyState>& initialStates,
+                                 float stepsPerSecond, float timeScale)
+    : orbits_(orbits),
+      states_(initialStates),
+      stepDuration_(1.0 / std::max(1.0f, stepsPerSecond)),
+      timeScale_(timeScale) {
+  states_.resize(orbits_.size());
+
+  // Sized up front: from here on snapshot copies never reallocate
+  snapshots_.forEach([this](SimulationSnapshot& snapshot) {
+    snapshot.bodies = states_;
+  });
+  previous_.bodies = states_;
+  current_.bodies = states_;
+}
+
+OrbitSimulation::~OrbitSimulation() { stop(); }
+
+void OrbitSimulation::start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(clockMutex_);
+    startTime_ = Clock::now();
+    pausedAt_ = startTime_;
+    pausedTotal_ = Clock::duration::zero();
+  }
+  thread_ = std::thread(&OrbitSimulation::run, this);
+  std::cout << "Simulation thread started: " << orbits_.size() << " bodies at "
+            << 1.0 / stepDuration_.count() << " steps/s" << std::endl;
+}
+
+void OrbitSimulation::stop() {
+  {
+    std::lock_guard<std::mutex> lock(clockMutex_);
+    if (!running_.exchange(false)) {
+      return;
+    }
+  }
+  clockChanged_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void OrbitSimulation::setPaused(bool paused) {
+  {
+    std::lock_guard<std::mutex> lock(clockMutex_);
+    if (paused == paused_) {
+      return;
+    }
+    const Clock::time_point now = Clock::now();
+    if (paused) {
+      pausedAt_ = now;
+    } else {
+      pausedTotal_ += now - pausedAt_;
+    }
+    paused_ = paused;
+  }
+  clockChanged_.notify_all();
+  std::cout << (paused ? "Simulation paused" : "Simulation resumed")
+            << std::endl;
+}
+
+bool OrbitSimulation::isPaused() const {
+  std::lock_guard<std::mutex> lock(clockMutex_);
+  return paused_;
+}
+
+void OrbitSimulation::run() {
+  const double step = stepDuration_.count();
+  // Falling further behind than this drops the backlog instead of running
+  // a burst of catch-up steps
+  const double maxLag = step * 8;
+  const float stepSeconds = static_cast<float>(step);
+
+  uint64_t stepIndex = 0;
+  double nextStep = step;
+  while (running_.load(std::memory_order_acquire)) {
+    {
+      std::unique_lock<std::mutex> lock(clockMutex_);
+      if (paused_) {
+        clockChanged_.wait(lock, [this] {
+          return !paused_ || !running_.load(std::memory_order_acquire);
+        });
+        continue;
+      }
+      const double remaining = nextStep - simulationTimeLocked();
+      if (remaining > 0.0) {
+        // Woken early by pause/stop, or on time; either way look again
+        clockChanged_.wait_for(lock,
+                               std::chrono::duration<double>(remaining));
+        continue;
+      }
+    }
+
+    for (size_t i = 0; i < states_.size(); ++i) {
+      advanceOrbit(orbits_[i], states_[i], stepSeconds * timeScale_);
+    }
+    ++stepIndex;
+
+    SimulationSnapshot& snapshot = snapshots_.writeBuffer();
+    snapshot.time = nextStep;
+    snapshot.step = stepIndex;
+    std::copy(states_.begin(), states_.end(), snapshot.bodies.begin());
+    snapshots_.publish();
+    publishedSteps_.store(stepIndex, std::memory_order_release);
+
+    nextStep += step;
+    const double now = simulationTime();
+    if (now - nextStep > maxLag) {
+      nextStep = now;
+    }
+  }
+}
+
+bool OrbitSimulation::sample(std::vector<BodyState>& states) {
+  const bool changed = snapshots_.update();
+  if (changed) {
+    std::swap(previous_, current_);
+    const SimulationSnapshot& latest = snapshots_.readBuffer();
+    current_.time = latest.time;
+    current_.step = latest.step;
+    std::copy(latest.bodies.begin(), latest.bodies.end(),
+              current_.bodies.begin());
+  }
+
+  // One step behind "now" so there usually is a snapshot on either side
+  const double renderTime = simulationTime() - stepDuration_.count();
+  const double span = current_.time - previous_.time;
+  float alpha = 1.0f;
+  if (span > 0.0) {
+    alpha = static_cast<float>(
+        std::clamp((renderTime - previous_.time) / span, 0.0, 1.0));
+  }
+
+  for (size_t i = 0; i < states.size() && i < current_.bodies.size(); ++i) {
+    const BodyState& from = previous_.bodies[i];
+    const BodyState& to = current_.bodies[i];
+    states[i].position = from.position + (to.position - from.position) * alpha;
+    states[i].velocity = from.velocity + (to.velocity - from.velocity) * alpha;
+
+    // Take the short way across the 2*PI wrap
+    float delta = to.orbitAngle - from.orbitAngle;
+    if (delta < -static_cast<float>(M_PI)) {
+      delta += 2.0f * static_cast<float>(M_PI);
+    }
+    states[i].orbitAngle = from.orbitAngle + delta * alpha;
+  }
+  return changed;
+}
+
+uint64_t OrbitSimulation::getPublishedSteps() const {
+  return publishedSteps_.load(std::memory_order_acquire);
+}
+
+bool OrbitSimulation::advanceOrbit(const OrbitComponent& orbit,
+                                   BodyState& state, float deltaTime) {
+  if (orbit.period <= 0.0f) {
+    return false;
+  }
+
+  float angularVelocity = (2.0f * M_PI) / orbit.period;
+
+  state.orbitAngle += angularVelocity * deltaTime;
+
+  if (state.orbitAngle > 2.0f * M_PI) {
+    state.orbitAngle -= 2.0f * M_PI;
+  }
+
+  const float orbitRadius = orbit.semiMajorAxis;
+
+  state.position.x = orbitRadius * cos(state.orbitAngle);
+  state.position.z = orbitRadius * sin(state.orbitAngle);
+  state.position.y = 0.0f;
+
+  float speed = angularVelocity * orbitRadius;
+  state.velocity.x = -speed * sin(state.orbitAngle);
+  state.velocity.z = speed * cos(state.orbitAngle);
+  state.velocity.y = 0.0f;
+  return true;
+}
+
+double OrbitSimulation::simulationTime() const {
+  std::lock_guard<std::mutex> lock(clockMutex_);
+  return simulationTimeLocked();
+}
+
+double OrbitSimulation::simulationTimeLocked() const {
+  const Clock::time_point now = paused_ ? pausedAt_ : Clock::now();
+  return std::chrono::duration<double>(now - startTime_ - pausedTotal_)
+      .count();
+}
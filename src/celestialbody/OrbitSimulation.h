@@ -0,0 +1,95 @@
+#ifndef SOLAR_SYSTEM_OPENGL_ORBITSIMULATION_H
+#define SOLAR_SYSTEM_OPENGL_ORBITSIMULATION_H
+
+#include <celestialbody/BodyComponents.h>
+#include <core/threading/TripleBuffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct BodyState {
+  glm::vec3 position;
+  glm::vec3 velocity;
+  float orbitAngle;  // radians
+};
+
+// State of every body at one simulation step. time is seconds since the
+// simulation started, on the same clock the renderer samples with.
+struct SimulationSnapshot {
+  double time = 0.0;
+  uint64_t step = 0;
+  std::vector<BodyState> bodies;
+};
+
+// Steps the orbits at a fixed rate on its own thread and publishes
+// timestamped snapshots through a triple buffer. The render thread samples
+// the two newest snapshots it has seen, interpolated one step in the past,
+// so a slow frame never holds the simulation back and a heavy step never
+// stalls a frame. Time is measured on a simulation clock that stands still
+// while paused; the thread then sleeps until it is resumed.
+class OrbitSimulation {
+ public:
+  // One orbit and starting state per body, in the order the snapshots are
+  // indexed by
+  OrbitSimulation(const std::vector<OrbitComponent>& orbits,
+                  const std::vector<BodyState>& initialStates,
+                  float stepsPerSecond, float timeScale);
+  ~OrbitSimulation();
+
+  OrbitSimulation(const OrbitSimulation&) = delete;
+  OrbitSimulation& operator=(const OrbitSimulation&) = delete;
+
+  void start();
+  void stop();
+
+  void setPaused(bool paused);
+  bool isPaused() const;
+
+  // Render thread: body states at "now - one step", interpolated between
+  // the two newest snapshots. states must hold one entry per body. Returns
+  // true if a new snapshot arrived since the last call.
+  bool sample(std::vector<BodyState>& states);
+
+  uint64_t getPublishedSteps() const;
+
+  // Advances one circular orbit; false if the body does not orbit
+  static bool advanceOrbit(const OrbitComponent& orbit, BodyState& state,
+                           float deltaTime);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<OrbitComponent> orbits_;
+  std::vector<BodyState> states_;  // simulation thread only
+  const std::chrono::duration<double> stepDuration_;
+  const float timeScale_;
+
+  TripleBuffer<SimulationSnapshot> snapshots_;
+  // Render side copies of the two newest snapshots
+  SimulationSnapshot previous_;
+  SimulationSnapshot current_;
+
+  // Simulation clock, guarded by clockMutex_
+  mutable std::mutex clockMutex_;
+  std::condition_variable clockChanged_;
+  Clock::time_point startTime_;
+  Clock::time_point pausedAt_;
+  Clock::duration pausedTotal_{0};
+  bool paused_ = false;
+
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> publishedSteps_{0};
+  std::thread thread_;
+
+  void run();
+  // Seconds on the simulation clock
+  double simulationTime() const;
+  double simulationTimeLocked() const;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_ORBITSIMULATION_H
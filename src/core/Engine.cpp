@@ -4,16 +4,29 @@
 
 #include <AppConfig.h>
 #include <celestialbody/CelestialBodyPicker.h>
+#include <core/ShaderManager.h>
 #include <core/audio/AudioManager.h>
+#include <core/debug/GLValidation.h>
 #include <core/input/InputManager.h>
+#include <core/logging/Logger.h>
+#include <core/memory/AllocationTracker.h>
+#include <core/memory/FrameArena.h>
+#include <core/resources/GpuDeletionQueue.h>
 #include <core/window/WindowManager.h>
 #include <graphics/buffer/BufferManager.h>
 #include <rendering/RenderContext.h>
+#include <rendering/Scene.h>
+#include <rendering/culling/FrustumCuller.h>
+#include <rendering/renderers/PickingRenderer.h>
 #include <rendering/renderers/SceneRenderer.h>
 #include <rendering/renderers/UIRenderer.h>
 
+#include <cstdlib>
+
 bool Engine::canRenderPanel = false;
-BodyType Engine::currentSelectedBodyType = Unknown;
+bool Engine::canRenderMemoryPage = false;
+bool Engine::isPaused = false;
+BodyHandle Engine::selectedBody;
 
 Engine::Engine(bool enable_gl_depth_test, BufferManager& bufferManager)
     : context_(std::make_unique<EngineContext>()),
@@ -37,11 +50,17 @@ Engine::Engine(bool enable_gl_depth_test, BufferManager& bufferManager)
 
     initGLAD();
 
+    context_->shaderManager = std::make_unique<ShaderManager>();
     context_->textRenderer = std::make_unique<TextRenderer>(
-        bufferManager_, AppConfig::SCR_WIDTH, AppConfig::SCR_HEIGHT);
+        bufferManager_, *context_->shaderManager, AppConfig::SCR_WIDTH,
+        AppConfig::SCR_HEIGHT);
     context_->uiRenderer =
         std::make_unique<UIRenderer>(*context_->textRenderer);
-    context_->sceneRenderer = std::make_unique<SceneRenderer>();
+    context_->sceneRenderer =
+        std::make_unique<SceneRenderer>(*context_->shaderManager);
+    context_->pickingRenderer =
+        std::make_unique<PickingRenderer>(*context_->shaderManager);
+    context_->frustumCuller = std::make_unique<FrustumCuller>();
     context_->audioManager = std::make_unique<AudioManager>();
 
     initializeBasicDebugging();
@@ -56,8 +75,17 @@ Engine::Engine(bool enable_gl_depth_test, BufferManager& bufferManager)
     // GL_CHECK(glCullFace(GL_BACK));
     // GL_CHECK(glFrontFace(GL_CCW));
 
+    gpuPicking_ = AppConfig::GPU_PICKING;
+    if (const char* value = std::getenv("SOLAR_GPU_PICKING")) {
+      gpuPicking_ = std::atoi(value) != 0;
+    }
     setupInputConfig();
 
+    const char* onDemand = std::getenv("SOLAR_ON_DEMAND");
+    context_->windowManager->setOnDemand(
+        onDemand ? std::atoi(onDemand) != 0 : AppConfig::ON_DEMAND_RENDERING,
+        AppConfig::ON_DEMAND_IDLE_TIMEOUT);
+
     context_->audioManager->playBackgroundMusic("../audio/dnb.mp3");
     context_->audioManager->setVolume(0.5f);
     std::cout << "Engine initialized successfully" << std::endl;
@@ -93,6 +121,17 @@ Engine::~Engine() {
     std::cout << "\nDestroying Scene renderer\n" << std::endl;
     context_->sceneRenderer.reset();
   }
+  if (context_->pickingRenderer) {
+    std::cout << "\nDestroying Picking renderer\n" << std::endl;
+    context_->pickingRenderer.reset();
+  }
+  // After every renderer released its programs, before the GL context goes
+  if (context_->shaderManager) {
+    std::cout << "\nDestroying Shader manager\n" << std::endl;
+    context_->shaderManager.reset();
+  }
+  // Resources released by the application's shutdown are queued by now
+  GpuDeletionQueue::flush();
   if (context_->windowManager) {
     std::cout << "\nDestroying Window manager\n" << std::endl;
     context_->windowManager.reset();
@@ -111,31 +150,44 @@ void Engine::calculateFPS(float currentTime) {
 }
 
 void Engine::run(std::function<void(FrameContext&)> frameCallback,
-                 const std::deque<ISceneRenderable*>& renderables) {
+                 const Scene& scene) {
   try {
     if (stopEngine) {
       return;
     }
 
     std::cout << "Running engine loop..." << std::endl;
+    scene_ = &scene;
     FrameContext frameContext;
+    if (AppConfig::RENDER_THREAD) {
+      runWithRenderThread(frameCallback, scene, frameContext);
+      return;
+    }
+
+    AllocationTracker::setFrameThread();
     context_->windowManager->run(
-        [this, &frameCallback, &renderables, &frameContext] {
+        [this, &frameCallback, &scene, &frameContext](bool draw) {
           if (stopEngine) {
             return;
           }
 
-          frameContext.currentTime = context_->windowManager->getGLFWTime();
-          frameContext.deltaTime =
-              frameContext.currentTime - frameContext.lastFrame;
-          frameContext.lastFrame = frameContext.currentTime;
+          const bool allocationCheckDone = beginFrame(frameContext, draw);
 
-          frameContext.shouldTerminate = context_->inputManager->processInput(
-              context_->windowManager->getWindow(), frameContext.deltaTime);
+          {
+            ALLOCATION_ZONE("INPUT");
+            frameContext.shouldTerminate =
+                context_->inputManager->processInput(
+                    context_->windowManager->getWindow(),
+                    frameContext.deltaTime) ||
+                allocationCheckDone;
+          }
 
-          render(frameContext.currentTime, renderables);
-          calculateFPS(frameContext.currentTime);
-          frameCallback(frameContext);
+          finishFrame(frameContext, frameCallback, scene, draw);
+          // The loop ends after this frame; the application shuts down
+          // once run() has returned, never from inside a frame
+          if (frameContext.shouldTerminate) {
+            context_->windowManager->requestClose();
+          }
         });
   } catch (const std::exception& e) {
     std::cerr << "Exception appeared when running the engine: " << e.what()
@@ -143,16 +195,133 @@ void Engine::run(std::function<void(FrameContext&)> frameCallback,
   }
 }
 
-void Engine::render(float currentTime,
-                    const std::deque<ISceneRenderable*>& renderables) const {
-  RenderContext renderContext{*context_->camera,    currentSelectedBodyType,
+void Engine::runWithRenderThread(
+    const std::function<void(FrameContext&)>& frameCallback,
+    const Scene& scene, FrameContext& frameContext) {
+  // Input callbacks fire on this thread, but the camera, picker and GL
+  // state belong to the render thread: forward every action to it
+  context_->inputManager->setDispatcher(
+      [this](std::function<void()> action) {
+        renderCommands_.push(std::move(action));
+      });
+
+  float lastInputTime = static_cast<float>(glfwGetTime());
+  bool countingAllocations = false;
+  context_->windowManager->runThreaded(
+      [this, &frameCallback, &scene, &frameContext,
+       &countingAllocations](bool draw) {
+        if (stopEngine) {
+          return;
+        }
+        // Frames run here, so this thread's allocations are the ones
+        // that count and endFrame() below never races with the hooks
+        if (!countingAllocations) {
+          AllocationTracker::setFrameThread();
+          countingAllocations = true;
+        }
+
+        if (beginFrame(frameContext, draw)) {
+          context_->windowManager->requestClose();
+        }
+        renderCommands_.execute();
+
+        // Shutdown happens on the main thread once the loop has returned,
+        // never from inside a render-thread frame
+        frameContext.shouldTerminate = false;
+        finishFrame(frameContext, frameCallback, scene, draw);
+      },
+      [this, &lastInputTime] {
+        ALLOCATION_ZONE("INPUT");
+        const auto now = static_cast<float>(glfwGetTime());
+        if (context_->inputManager->processInput(
+                context_->windowManager->getWindow(), now - lastInputTime)) {
+          context_->windowManager->requestClose();
+        }
+        lastInputTime = now;
+      },
+      1.0 / AppConfig::INPUT_POLL_RATE);
+
+  context_->inputManager->setDispatcher(nullptr);
+  // Whatever was still queued must not run against a torn-down scene
+  renderCommands_.execute();
+}
+
+bool Engine::beginFrame(FrameContext& frameContext, bool draw) {
+  frameContext.currentTime = context_->windowManager->getGLFWTime();
+  frameContext.deltaTime = frameContext.currentTime - frameContext.lastFrame;
+  frameContext.lastFrame = frameContext.currentTime;
+  // Coming out of an idle stretch: a held key must not move the camera by
+  // the whole time nothing was drawn
+  if (idle_) {
+    frameContext.deltaTime = 0.0f;
+  }
+  idle_ = !draw;
+
+  frameContext.paused = isPaused;
+  if (!isPaused) {
+    sceneTime_ += frameContext.deltaTime;
+  }
+
+  // Closes the previous frame's allocation counters, which include its
+  // callback, buffer swap and event polling
+  return AllocationTracker::endFrame();
+}
+
+void Engine::finishFrame(FrameContext& frameContext,
+                         const std::function<void(FrameContext&)>& frameCallback,
+                         const Scene& scene, bool draw) {
+  if (draw) {
+    render(sceneTime_, scene);
+    calculateFPS(frameContext.currentTime);
+  }
+
+  frameContext.needsRedraw = false;
+  frameCallback(frameContext);
+  if (!frameContext.shouldTerminate) {
+    // Pick readbacks are collected by the draws that follow
+    frameContext.needsRedraw |= context_->pickingRenderer &&
+                                context_->pickingRenderer->hasPendingWork();
+    if (frameContext.needsRedraw) {
+      context_->windowManager->requestRedraw();
+    }
+  }
+
+  // Resources released this frame are deleted once the GPU is done with it.
+  // After the last frame the engine's teardown flushes the queue instead,
+  // while the window and its context still exist.
+  if (!frameContext.shouldTerminate) {
+    GpuDeletionQueue::endFrame();
+  }
+  // Nothing allocated from the arena may outlive the frame
+  FrameArena::reset();
+}
+
+void Engine::render(float currentTime, const Scene& scene) const {
+  RenderContext renderContext{*context_->camera,    scene.bodies,
+                              selectedBody,
                               AppConfig::SCR_WIDTH, AppConfig::SCR_HEIGHT,
                               currentTime,          currentFPS_,
-                              canRenderPanel};
+                              canRenderPanel,       canRenderMemoryPage,
+                              context_->windowManager->getFramePacer(),
+                              isPaused,
+                              context_->windowManager->isOnDemand()};
   // Render 3D scene
-  context_->sceneRenderer->render(renderables, renderContext);
+  {
+    ALLOCATION_ZONE("SCENE");
+    // One visibility pass feeds the scene, picking and the labels
+    context_->frustumCuller->cull(
+        scene.bodies, context_->camera->getViewMatrix(),
+        SceneRenderer::calculateProjection(renderContext),
+        renderContext.screenHeight);
+    renderContext.culling = context_->frustumCuller.get();
+    context_->sceneRenderer->render(scene, renderContext);
+    context_->pickingRenderer->render(scene, renderContext);
+  }
   // Render UI
-  context_->uiRenderer->render(renderContext);
+  {
+    ALLOCATION_ZONE("UI");
+    context_->uiRenderer->render(renderContext);
+  }
 }
 
 void Engine::initGLFW() {
@@ -167,6 +336,12 @@ void Engine::initGLFW() {
 #ifdef __APPLE__
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+  GLValidation::configure();
+
+  // The allocation check runs unattended, keep its window off screen
+  if (AllocationTracker::isCheckRequested()) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  }
 
   std::cout << "GLFW initialized" << std::endl;
 }
@@ -177,88 +352,105 @@ void Engine::initGLAD() {
   }
 
   std::cout << "GLAD initialized" << std::endl;
+
+  GLValidation::initialize();
 }
 
 void Engine::setupInputConfig() const {
-  context_->inputManager->bindKey(GLFW_KEY_W, [&](float dt, float sp) {
+  InputManager& input = *context_->inputManager;
+  input.bindKey(GLFW_KEY_W, InputAction::MoveForward);
+  input.bindKey(GLFW_KEY_S, InputAction::MoveBackward);
+  input.bindKey(GLFW_KEY_A, InputAction::MoveLeft);
+  input.bindKey(GLFW_KEY_D, InputAction::MoveRight);
+  input.bindKey(GLFW_KEY_Q, InputAction::MoveDown);
+  input.bindKey(GLFW_KEY_E, InputAction::MoveUp);
+  input.bindKey(GLFW_KEY_LEFT_SHIFT, InputAction::Sprint);
+  input.bindKey(GLFW_KEY_ENTER, InputAction::ToggleFullscreen,
+                GLFW_MOD_SHIFT);
+  input.bindKey(GLFW_KEY_M, InputAction::ToggleMemoryPage);
+  input.bindKey(GLFW_KEY_V, InputAction::CycleValidation);
+  input.bindKey(GLFW_KEY_F, InputAction::CycleVsync);
+  input.bindKey(GLFW_KEY_L, InputAction::ToggleLowLatency);
+  input.bindKey(GLFW_KEY_P, InputAction::TogglePause);
+  input.bindKey(GLFW_KEY_ESCAPE, InputAction::Exit);
+
+  input.setHeldActionCallback(InputAction::MoveForward, [&](float dt, float sp) {
     context_->camera->processMovement(FORWARD, dt, sp);
   });
-  context_->inputManager->bindKey(GLFW_KEY_S, [&](float dt, float sp) {
+  input.setHeldActionCallback(InputAction::MoveBackward, [&](float dt, float sp) {
     context_->camera->processMovement(BACKWARD, dt, sp);
   });
-  context_->inputManager->bindKey(GLFW_KEY_A, [&](float dt, float sp) {
+  input.setHeldActionCallback(InputAction::MoveLeft, [&](float dt, float sp) {
     context_->camera->processMovement(LEFT, dt, sp);
   });
-  context_->inputManager->bindKey(GLFW_KEY_D, [&](float dt, float sp) {
+  input.setHeldActionCallback(InputAction::MoveRight, [&](float dt, float sp) {
     context_->camera->processMovement(RIGHT, dt, sp);
   });
-  context_->inputManager->bindKey(GLFW_KEY_Q, [&](float dt, float sp) {
+  input.setHeldActionCallback(InputAction::MoveDown, [&](float dt, float sp) {
     context_->camera->processMovement(DOWN, dt, sp);
   });
-  context_->inputManager->bindKey(GLFW_KEY_E, [&](float dt, float sp) {
+  input.setHeldActionCallback(InputAction::MoveUp, [&](float dt, float sp) {
     context_->camera->processMovement(UP, dt, sp);
   });
 
-  context_->inputManager->setPointerMovementCallback(
+  input.setPointerMovementCallback(
       [this](float xoffset, float yoffset) {
         context_->camera->processPointerMovement(xoffset, yoffset);
       });
 
-  context_->inputManager->setAxisCallback(
+  input.setAxisCallback(
       [this](float value) { context_->camera->processAxis(value); });
 
-  context_->inputManager->setPrimaryActionCallback([this]() {
-    CelestialBodyPicker::pickBody(
-        *context_->camera, [this](const int selectedBodyIndex) {
-          if (selectedBodyIndex >= 0) {
-            Engine::canRenderPanel = true;
-          } else {
-            Engine::canRenderPanel = false;
-          }
-          switch (selectedBodyIndex) {
-            case 0: {
-              Engine::currentSelectedBodyType = Sun;
-              break;
-            }
-            case 1: {
-              Engine::currentSelectedBodyType = Mercury;
-              break;
-            }
-            case 2: {
-              Engine::currentSelectedBodyType = Venus;
-              break;
-            }
-            case 3: {
-              Engine::currentSelectedBodyType = Earth;
-              break;
-            }
-            case 4: {
-              Engine::currentSelectedBodyType = Mars;
-              break;
-            }
-            case 5: {
-              Engine::currentSelectedBodyType = Jupiter;
-              break;
-            }
-            case 6: {
-              Engine::currentSelectedBodyType = Saturn;
-              break;
-            }
-            case 7: {
-              Engine::currentSelectedBodyType = Uranus;
-              break;
-            }
-            case 8: {
-              Engine::currentSelectedBodyType = Neptune;
-              break;
-            }
-            default: {
-              Engine::currentSelectedBodyType = Unknown;
-              break;
+  input.setPrimaryActionCallback([this]() {
+    // Clicks only arrive while run() is drawing a scene
+    if (!scene_) {
+      return;
+    }
+    const auto select = [](const BodyHandle body) {
+      Engine::selectedBody = body;
+      Engine::canRenderPanel = body.isValid();
+    };
+    if (gpuPicking_ && context_->pickingRenderer->isAvailable()) {
+      // The camera ray goes through the crosshair at the screen centre
+      context_->pickingRenderer->requestPick(
+          AppConfig::SCR_WIDTH / 2, AppConfig::SCR_HEIGHT / 2,
+          [this, select](const BodyHandle body) {
+            if (const BodyInfo* info = scene_->bodies.getInfo(body)) {
+              LOG_INFO("Selected body: %s", info->name.c_str());
             }
-          }
-        });
+            select(body);
+          });
+      context_->windowManager->requestRedraw();
+      return;
+    }
+    CelestialBodyPicker::pickBody(*context_->camera, scene_->bodies, select);
+  });
+  // GLFW window functions must run on the main thread, never dispatched
+  input.setActionCallback(
+      InputAction::ToggleFullscreen,
+      [this]() { context_->windowManager->toggleFullscreen(); }, true);
+  input.setActionCallback(InputAction::ToggleMemoryPage, []() {
+    Engine::canRenderMemoryPage = !Engine::canRenderMemoryPage;
   });
-  context_->inputManager->setFullscreenActionCallback(
-      [this]() { context_->windowManager->toggleFullscreen(); });
+  input.setActionCallback(InputAction::CycleValidation,
+                          []() { GLValidation::cycleLevel(); });
+  // Dispatched like the other actions, so the swap interval is changed on
+  // the thread that owns the context
+  input.setActionCallback(InputAction::CycleVsync, [this]() {
+    context_->windowManager->getFramePacer().cycleVsyncMode();
+  });
+  input.setActionCallback(InputAction::ToggleLowLatency, [this]() {
+    FramePacer& framePacer = context_->windowManager->getFramePacer();
+    framePacer.setLowLatency(!framePacer.isLowLatency());
+  });
+  input.setActionCallback(InputAction::TogglePause,
+                          []() { Engine::isPaused = !Engine::isPaused; });
+
+  // Any input may change what is on screen
+  input.setActivityCallback(
+      [this]() { context_->windowManager->requestRedraw(); });
+  input.setInputTimestampCallback(
+      [this](InputManager::Clock::time_point eventTime) {
+        context_->windowManager->getFramePacer().recordInputEvent(eventTime);
+      });
 }
@@ -2,14 +2,15 @@
 #define ENGINE_H
 
 #include <core/EngineContext.h>
+#include <core/threading/CommandQueue.h>
 #include <rendering/renderers/TextRenderer.h>
 
-#include <deque>
 #include <functional>
 
-#include <CelestialBodyTypes.h>
+#include <celestialbody/BodyRegistry.h>
 
-class ISceneRenderable;
+class ShaderManager;
+struct Scene;
 
 class Engine {
  public:
@@ -18,25 +19,42 @@ class Engine {
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
     float currentTime = 0.0f;
+    bool paused = false;
+    // Set by the frame callback when its state changed and the scene must
+    // be drawn again (on-demand rendering)
+    bool needsRedraw = false;
   };
 
   Engine(bool enable_gl_depth_test, BufferManager& bufferManager);
   ~Engine();
 
   void run(std::function<void(FrameContext&)> frameCallback,
-           const std::deque<ISceneRenderable*>& renderables);
+           const Scene& scene);
+
+  // Programs for scene objects owned outside the engine (the skybox)
+  ShaderManager& getShaderManager() const { return *context_->shaderManager; }
 
  private:
   std::unique_ptr<EngineContext> context_;
   BufferManager& bufferManager_;
-
-  static BodyType currentSelectedBodyType;
+  // Input actions forwarded from the main thread (RENDER_THREAD mode)
+  CommandQueue renderCommands_;
+  // Set for the duration of run()
+  const Scene* scene_ = nullptr;
+  // Clicks pick through pickingRenderer rather than a ray
+  bool gpuPicking_ = false;
+
+  static BodyHandle selectedBody;
   static bool canRenderPanel;
-  void render(
-      float currentTime,
-      const std::deque<ISceneRenderable*>& renderables) const;
+  static bool canRenderMemoryPage;
+  static bool isPaused;
+  void render(float currentTime, const Scene& scene) const;
 
   // Time & performance tracking
+  // Scene animation time; stands still while paused
+  float sceneTime_ = 0.0f;
+  // The previous frame was skipped by on-demand rendering
+  bool idle_ = false;
   float lastFPSTime_ = 0.0f;
   float currentFPS_ = 0.0f;
   int frameCount_ = 0;
@@ -44,6 +62,15 @@ class Engine {
   // Helpers
   void calculateFPS(float currentTime);
 
+  // Frame loop
+  void runWithRenderThread(
+      const std::function<void(FrameContext&)>& frameCallback,
+      const Scene& scene, FrameContext& frameContext);
+  bool beginFrame(FrameContext& frameContext, bool draw);
+  void finishFrame(FrameContext& frameContext,
+                   const std::function<void(FrameContext&)>& frameCallback,
+                   const Scene& scene, bool draw);
+
   bool enableCullFaceState = false;
 
   // Core system functions
@@ -10,17 +10,24 @@ class WindowManager;
 class Camera;
 class InputManager;
 class SceneRenderer;
+class PickingRenderer;
+class FrustumCuller;
 class UIRenderer;
 class TextRenderer;
 class AudioManager;
+class ShaderManager;
 
 struct EngineContext {
   // Core system instances
   std::unique_ptr<WindowManager> windowManager;
   std::unique_ptr<Camera> camera;
   std::unique_ptr<InputManager> inputManager;
-  // Rendering
+  // Rendering; the renderers hold references to the shader manager's
+  // programs, so it is declared first
+  std::unique_ptr<ShaderManager> shaderManager;
   std::unique_ptr<SceneRenderer> sceneRenderer;
+  std::unique_ptr<PickingRenderer> pickingRenderer;
+  std::unique_ptr<FrustumCuller> frustumCuller;
   std::unique_ptr<UIRenderer> uiRenderer;
   std::unique_ptr<TextRenderer> textRenderer;
   // Audio
@@ -12,22 +12,30 @@ public:
     unsigned int ID;
 
     Shader(const char* vertexPath, const char* fragmentPath);
+    ~Shader();
+
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
 
     void use() const;
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
-    void setVec2(const std::string& name, const glm::vec2& value) const;
-    void setVec2(const std::string& name, float x, float y) const;
-    void setVec3(const std::string& name, const glm::vec3& value) const;
-    void setVec3(const std::string& name, float x, float y, float z) const;
-    void setVec4(const std::string& name, const glm::vec4& value) const;
-    void setVec4(const std::string& name, float x, float y, float z, float w) const;
-    void setMat2(const std::string& name, const glm::mat2& mat) const;
-    void setMat3(const std::string& name, const glm::mat3& mat) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    void setBool(const char* name, bool value) const;
+    void setInt(const char* name, int value) const;
+    void setUVec2(const char* name, unsigned int x, unsigned int y) const;
+    void setFloat(const char* name, float value) const;
+    void setVec2(const char* name, const glm::vec2& value) const;
+    void setVec2(const char* name, float x, float y) const;
+    void setVec3(const char* name, const glm::vec3& value) const;
+    void setVec3(const char* name, float x, float y, float z) const;
+    void setVec4(const char* name, const glm::vec4& value) const;
+    void setVec4(const char* name, float x, float y, float z, float w) const;
+    void setMat2(const char* name, const glm::mat2& mat) const;
+    void setMat3(const char* name, const glm::mat3& mat) const;
+    void setMat4(const char* name, const glm::mat4& mat) const;
 
 private:
+    // GL 3.3 cannot report program size, the source size stands in for it
+    size_t trackedBytes_ = 0;
+
     void checkCompileErrors(GLuint shader, std::string type);
 };
 
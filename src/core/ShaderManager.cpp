@@ -0,0 +1,66 @@
+#include "ShaderManager.h"
+
+#include <core/Shader.h>
+#include <core/logging/Logger.h>
+
+#include <iostream>
+#include <optional>
+
+// Initialized here, where Shader is complete
+ShaderManager::ShaderManager() : programs_("Program") {}
+
+ShaderManager::~ShaderManager() {
+  // Every owner releases its references, what is left here leaked
+  if (!programs_.empty()) {
+    std::cout << "ShaderManager: Cleaning up " << programs_.size()
+              << " programs still referenced\n";
+    programs_.each([](ProgramHandle, const ProgramRecord& record) {
+      std::cout << "  - " << record.key << "\n";
+    });
+  } else {
+    std::cout << "ShaderManager: All programs were properly released\n";
+  }
+  programs_.clear();
+}
+
+ProgramHandle ShaderManager::load(const std::string& vertexPath,
+                                  const std::string& fragmentPath) {
+  const std::string key = vertexPath + "|" + fragmentPath;
+  const auto existing = programsByKey_.find(key);
+  if (existing != programsByKey_.end()) {
+    programs_.retain(existing->second);
+    return existing->second;
+  }
+
+  std::unique_ptr<Shader> shader;
+  try {
+    shader = std::make_unique<Shader>(vertexPath.c_str(),
+                                      fragmentPath.c_str());
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: Failed to load shader " << key << ": " << e.what()
+              << std::endl;
+    return {};
+  }
+
+  const ProgramHandle program =
+      programs_.create({std::move(shader), key});
+  programsByKey_.emplace(key, program);
+  return program;
+}
+
+void ShaderManager::retain(ProgramHandle program) {
+  programs_.retain(program);
+}
+
+void ShaderManager::release(ProgramHandle program) {
+  if (std::optional<ProgramRecord> record = programs_.release(program)) {
+    programsByKey_.erase(record->key);
+    LOG_DEBUG("Released program: %s", record->key.c_str());
+    // The Shader deletes its program as the record goes out of scope
+  }
+}
+
+const Shader* ShaderManager::get(ProgramHandle program) const {
+  const ProgramRecord* record = programs_.get(program);
+  return record ? record->shader.get() : nullptr;
+}
@@ -0,0 +1,44 @@
+#ifndef SOLAR_SYSTEM_OPENGL_SHADERMANAGER_H
+#define SOLAR_SYSTEM_OPENGL_SHADERMANAGER_H
+
+#include <core/resources/HandlePool.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class Shader;
+
+// Owns the linked shader programs. Owners hold ProgramHandles instead of
+// their own Shader, so a program used by several passes is compiled once
+// and deleted with its last reference. GL thread only.
+class ShaderManager {
+ public:
+  ShaderManager();
+  ~ShaderManager();
+
+  ShaderManager(const ShaderManager&) = delete;
+  ShaderManager& operator=(const ShaderManager&) = delete;
+
+  // Returns one reference; the same source pair shares its program.
+  // Invalid handle if the program could not be built.
+  ProgramHandle load(const std::string& vertexPath,
+                     const std::string& fragmentPath);
+  void retain(ProgramHandle program);
+  void release(ProgramHandle program);
+
+  // nullptr for a released handle
+  const Shader* get(ProgramHandle program) const;
+  size_t getProgramCount() const { return programs_.size(); }
+
+ private:
+  struct ProgramRecord {
+    std::unique_ptr<Shader> shader;
+    std::string key;  // vertex and fragment path, for sharing
+  };
+
+  HandlePool<ProgramRecord, ProgramTag> programs_;
+  std::unordered_map<std::string, ProgramHandle> programsByKey_;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_SHADERMANAGER_H
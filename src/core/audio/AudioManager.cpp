@@ -17,6 +17,10 @@ AudioManager::AudioManager() : isInitialized(false) {
 AudioManager::~AudioManager() {
   if (isInitialized) {
     ma_sound_uninit(&sound);
+    if (!registeredName.empty()) {
+      ma_resource_manager_unregister_data(
+          ma_engine_get_resource_manager(&engine), registeredName.c_str());
+    }
     ma_engine_uninit(&engine);
   }
 }
@@ -26,7 +30,21 @@ void AudioManager::playBackgroundMusic(const std::string& filepath) {
     return;
   }
 
-  if (ma_sound_init_from_file(&engine, filepath.c_str(), MA_SOUND_FLAG_STREAM,
+  ma_uint32 flags = MA_SOUND_FLAG_STREAM;
+
+  // Inside the pack: hand miniaudio the mapped bytes instead of a path.
+  // Registered data is decoded from memory, streaming only applies to files.
+  packedMusic = VirtualFileSystem::isMounted() ? VirtualFileSystem::open(filepath)
+                                               : FileView();
+  if (packedMusic.isMapped() &&
+      ma_resource_manager_register_encoded_data(
+          ma_engine_get_resource_manager(&engine), filepath.c_str(),
+          packedMusic.data(), packedMusic.size()) == MA_SUCCESS) {
+    registeredName = filepath;
+    flags = 0;
+  }
+
+  if (ma_sound_init_from_file(&engine, filepath.c_str(), flags,
                               NULL, NULL, &sound) != MA_SUCCESS) {
     std::cerr << "Failed to load audio file: " << filepath << std::endl;
     return;
@@ -6,6 +6,9 @@
 #define SOLAR_SYSTEM_OPENGL_AUDIOMANAGER_H
 
 #include <miniaudio/miniaudio.h>
+
+#include <core/filesystem/VirtualFileSystem.h>
+
 #include <string>
 
 class AudioManager {
@@ -21,6 +24,11 @@ private:
   ma_engine engine;
   ma_sound sound;
   bool isInitialized;
+
+  // Packed audio is registered with miniaudio by name; the view must stay
+  // alive while the sound plays
+  FileView packedMusic;
+  std::string registeredName;
 };
 
 #endif  // SOLAR_SYSTEM_OPENGL_AUDIOMANAGER_H
@@ -0,0 +1,227 @@
+#include "GLValidation.h"
+
+#include <core/logging/Logger.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+bool GLValidation::synchronous_ = false;
+
+namespace {
+// KHR_debug / GL 4.3 enums, not part of the GL 3.3 glad loader
+constexpr GLenum DEBUG_OUTPUT = 0x92E0;
+constexpr GLenum DEBUG_OUTPUT_SYNCHRONOUS = 0x8242;
+constexpr GLenum DEBUG_SEVERITY_HIGH = 0x9146;
+constexpr GLenum DEBUG_SEVERITY_MEDIUM = 0x9147;
+constexpr GLenum DEBUG_SEVERITY_LOW = 0x9148;
+constexpr GLenum DEBUG_SEVERITY_NOTIFICATION = 0x826B;
+constexpr GLenum DEBUG_TYPE_ERROR = 0x824C;
+constexpr GLenum DEBUG_TYPE_DEPRECATED_BEHAVIOR = 0x824D;
+constexpr GLenum DEBUG_TYPE_UNDEFINED_BEHAVIOR = 0x824E;
+constexpr GLenum DEBUG_TYPE_PORTABILITY = 0x824F;
+constexpr GLenum DEBUG_TYPE_PERFORMANCE = 0x8250;
+
+using DebugMessageCallbackProc = void(APIENTRY*)(GLDEBUGPROC callback,
+                                                 const void* userParam);
+using DebugMessageControlProc = void(APIENTRY*)(GLenum source, GLenum type,
+                                                GLenum severity, GLsizei count,
+                                                const GLuint* ids,
+                                                GLboolean enabled);
+
+DebugMessageCallbackProc debugMessageCallback = nullptr;
+DebugMessageControlProc debugMessageControl = nullptr;
+// ARB_debug_output has no DEBUG_OUTPUT switch, only the callback
+bool hasDebugOutputToggle = false;
+
+GLValidationLevel currentLevel = GLValidationLevel::Off;
+bool initialized = false;
+
+const char* typeName(GLenum type) {
+  switch (type) {
+    case DEBUG_TYPE_ERROR: return "error";
+    case DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+    case DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+    case DEBUG_TYPE_PORTABILITY: return "portability";
+    case DEBUG_TYPE_PERFORMANCE: return "performance";
+    default: return "other";
+  }
+}
+
+// May run on a driver thread in callback mode; the logger is thread-safe
+void APIENTRY onDebugMessage(GLenum, GLenum type, GLuint id, GLenum severity,
+                             GLsizei, const GLchar* message, const void*) {
+  if (severity == DEBUG_SEVERITY_HIGH || type == DEBUG_TYPE_ERROR) {
+    LOG_ERROR("GL %s (%u): %s", typeName(type), id, message);
+  } else if (severity == DEBUG_SEVERITY_MEDIUM) {
+    LOG_WARNING("GL %s (%u): %s", typeName(type), id, message);
+  } else {
+    LOG_DEBUG("GL %s (%u): %s", typeName(type), id, message);
+  }
+}
+
+bool hasExtension(const char* name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const auto* extension =
+        reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && std::strcmp(extension, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+GLValidationLevel defaultLevel() {
+#ifdef NDEBUG
+  return GLValidationLevel::Off;
+#else
+  return GLValidationLevel::DebugCallback;
+#endif
+}
+
+void applyLevel(GLValidationLevel level) {
+  if (!initialized || !debugMessageCallback) {
+    return;
+  }
+
+  if (level == GLValidationLevel::Off) {
+    if (hasDebugOutputToggle) {
+      glDisable(DEBUG_OUTPUT);
+    }
+    glDisable(DEBUG_OUTPUT_SYNCHRONOUS);
+    debugMessageCallback(nullptr, nullptr);
+    return;
+  }
+
+  if (hasDebugOutputToggle) {
+    glEnable(DEBUG_OUTPUT);
+  }
+  // Synchronous delivery makes the callback run inside the faulty call, so
+  // a breakpoint there shows the culprit
+  if (level == GLValidationLevel::Synchronous) {
+    glEnable(DEBUG_OUTPUT_SYNCHRONOUS);
+  } else {
+    glDisable(DEBUG_OUTPUT_SYNCHRONOUS);
+  }
+  debugMessageCallback(onDebugMessage, nullptr);
+  if (debugMessageControl) {
+    debugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                        DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, DEBUG_SEVERITY_LOW, 0,
+                        nullptr,
+                        level == GLValidationLevel::Synchronous ? GL_TRUE
+                                                                : GL_FALSE);
+  }
+}
+}  // namespace
+
+void GLValidation::configure() {
+  GLValidationLevel level = defaultLevel();
+  if (const char* value = std::getenv("SOLAR_GL_VALIDATION")) {
+    if (std::strcmp(value, "off") == 0) {
+      level = GLValidationLevel::Off;
+    } else if (std::strcmp(value, "callback") == 0) {
+      level = GLValidationLevel::DebugCallback;
+    } else if (std::strcmp(value, "sync") == 0) {
+      level = GLValidationLevel::Synchronous;
+    } else {
+      std::cerr << "Unknown SOLAR_GL_VALIDATION '" << value
+                << "', expected off|callback|sync" << std::endl;
+    }
+  }
+  setLevel(level);
+
+  // Drivers only report the full message set on a debug context
+  glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT,
+                 currentLevel != GLValidationLevel::Off ? GLFW_TRUE
+                                                        : GLFW_FALSE);
+}
+
+void GLValidation::initialize() {
+  GLint major = 0;
+  GLint minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+  // glad only loads GL 3.3 core, fetch the debug entry points ourselves
+  if (major > 4 || (major == 4 && minor >= 3) || hasExtension("GL_KHR_debug")) {
+    debugMessageCallback = reinterpret_cast<DebugMessageCallbackProc>(
+        glfwGetProcAddress("glDebugMessageCallback"));
+    debugMessageControl = reinterpret_cast<DebugMessageControlProc>(
+        glfwGetProcAddress("glDebugMessageControl"));
+    hasDebugOutputToggle = true;
+  } else if (hasExtension("GL_ARB_debug_output")) {
+    debugMessageCallback = reinterpret_cast<DebugMessageCallbackProc>(
+        glfwGetProcAddress("glDebugMessageCallbackARB"));
+    debugMessageControl = reinterpret_cast<DebugMessageControlProc>(
+        glfwGetProcAddress("glDebugMessageControlARB"));
+  }
+  initialized = true;
+  setLevel(currentLevel);
+
+  if (!debugMessageCallback) {
+    std::cout << "GL validation: debug output not supported";
+    if (currentLevel != GLValidationLevel::Off) {
+      std::cout << ", falling back to "
+                << (SOLAR_GL_SYNC_VALIDATION ? "glGetError checks" : "off");
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "GL validation: " << getLevelName(currentLevel) << std::endl;
+}
+
+void GLValidation::setLevel(GLValidationLevel level) {
+#if !SOLAR_GL_SYNC_VALIDATION
+  if (level == GLValidationLevel::Synchronous) {
+    std::cerr << "Synchronous GL validation is compiled out of this build, "
+                 "using the debug callback"
+              << std::endl;
+    level = GLValidationLevel::DebugCallback;
+  }
+#endif
+
+  currentLevel = level;
+  // Without debug output the synchronous glGetError checks are the only
+  // validation left, keep them on for the callback level too
+  synchronous_ = level == GLValidationLevel::Synchronous ||
+                 (initialized && !debugMessageCallback &&
+                  level != GLValidationLevel::Off);
+  applyLevel(level);
+}
+
+GLValidationLevel GLValidation::getLevel() { return currentLevel; }
+
+void GLValidation::cycleLevel() {
+  switch (currentLevel) {
+    case GLValidationLevel::Off:
+      setLevel(GLValidationLevel::DebugCallback);
+      break;
+    case GLValidationLevel::DebugCallback:
+      setLevel(SOLAR_GL_SYNC_VALIDATION ? GLValidationLevel::Synchronous
+                                        : GLValidationLevel::Off);
+      break;
+    case GLValidationLevel::Synchronous:
+      setLevel(GLValidationLevel::Off);
+      break;
+  }
+  std::cout << "GL validation: " << getLevelName(currentLevel) << std::endl;
+}
+
+const char* GLValidation::getLevelName(GLValidationLevel level) {
+  switch (level) {
+    case GLValidationLevel::Off: return "OFF";
+    case GLValidationLevel::DebugCallback: return "CALLBACK";
+    case GLValidationLevel::Synchronous: return "SYNC";
+  }
+  return "UNKNOWN";
+}
+
+bool GLValidation::isDebugOutputSupported() {
+  return debugMessageCallback != nullptr;
+}
@@ -0,0 +1,52 @@
+#ifndef SOLAR_SYSTEM_OPENGL_GLVALIDATION_H
+#define SOLAR_SYSTEM_OPENGL_GLVALIDATION_H
+
+// Per-call glGetError checking stalls the pipeline, so it only exists in
+// debug builds; define SOLAR_GL_SYNC_VALIDATION=1 to force it elsewhere
+#ifndef SOLAR_GL_SYNC_VALIDATION
+#ifdef NDEBUG
+#define SOLAR_GL_SYNC_VALIDATION 0
+#else
+#define SOLAR_GL_SYNC_VALIDATION 1
+#endif
+#endif
+
+enum class GLValidationLevel {
+  Off,            // no checks at all
+  DebugCallback,  // KHR_debug messages, reported asynchronously by the driver
+  Synchronous     // debug callback in synchronous mode + glGetError per
+                  // GL_CHECK; debug builds only
+};
+
+// Selects how GL errors are caught. The level comes from
+// SOLAR_GL_VALIDATION=off|callback|sync (default: callback in debug builds,
+// off in release) and can be changed at runtime with setLevel / the V key.
+class GLValidation {
+ public:
+  // Before the window is created: reads the environment and requests a
+  // debug context when validation is on
+  static void configure();
+  // After GLAD is loaded: resolves the debug entry points and applies the
+  // level
+  static void initialize();
+
+  static void setLevel(GLValidationLevel level);
+  static GLValidationLevel getLevel();
+  // Off -> DebugCallback -> Synchronous (when compiled in) -> Off
+  static void cycleLevel();
+  static const char* getLevelName(GLValidationLevel level);
+
+  static bool isSynchronous() {
+#if SOLAR_GL_SYNC_VALIDATION
+    return synchronous_;
+#else
+    return false;
+#endif
+  }
+  static bool isDebugOutputSupported();
+
+ private:
+  static bool synchronous_;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_GLVALIDATION_H
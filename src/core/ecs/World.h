@@ -0,0 +1,423 @@
+#ifndef SOLAR_SYSTEM_OPENGL_WORLD_H
+#define SOLAR_SYSTEM_OPENGL_WORLD_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct Entity {
+  static constexpr uint32_t INVALID_INDEX = ~0u;
+
+  uint32_t index = INVALID_INDEX;
+  // Bumped every time the index is reused, so stale entities are rejected
+  uint32_t generation = 0;
+
+  bool isValid() const { return index != INVALID_INDEX; }
+  bool operator==(const Entity& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Bit i set = the entity has the component with id i
+using ComponentMask = uint32_t;
+
+namespace ecs_detail {
+constexpr uint32_t MAX_COMPONENTS = 32;
+
+inline uint32_t nextComponentId() {
+  static std::atomic<uint32_t> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace ecs_detail
+
+// Process-wide id of a component type, assigned on first use
+template <typename T>
+uint32_t componentId() {
+  static const uint32_t id = ecs_detail::nextComponentId();
+  assert(id < ecs_detail::MAX_COMPONENTS && "Too many component types");
+  return id;
+}
+
+// Archetype-based entity-component store. Entities with the same set of
+// components share an archetype, which keeps one tightly packed array per
+// component, so a query walks plain arrays instead of chasing pointers.
+// Components must be trivially copyable: rows are moved with memcpy when an
+// entity is destroyed or changes archetype.
+// Not thread-safe; nothing may be created, destroyed, added or removed
+// while a query is running.
+class World {
+ public:
+  World() = default;
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  template <typename... Ts>
+  Entity create(const Ts&... components) {
+    const ComponentMask mask = maskOf<Ts...>();
+    uint32_t archetypeIndex = findArchetype(mask);
+    if (archetypeIndex == NO_ARCHETYPE) {
+      archetypeIndex = addArchetype(mask, {columnInfo<Ts>()...});
+    }
+    Archetype& archetype = archetypes_[archetypeIndex];
+
+    const Entity entity = allocateEntity();
+    const uint32_t row = archetype.addRow(entity);
+    (std::memcpy(archetype.at(componentId<Ts>(), row), &components,
+                 sizeof(Ts)),
+     ...);
+    locations_[entity.index].archetype = archetypeIndex;
+    locations_[entity.index].row = row;
+    return entity;
+  }
+
+  void destroy(Entity entity) {
+    if (!isAlive(entity)) {
+      return;
+    }
+    Location& location = locations_[entity.index];
+    removeRow(location.archetype, location.row);
+    location.alive = false;
+    ++location.generation;
+    freeIndices_.push_back(entity.index);
+    --aliveCount_;
+  }
+
+  bool isAlive(Entity entity) const {
+    return entity.index < locations_.size() &&
+           locations_[entity.index].alive &&
+           locations_[entity.index].generation == entity.generation;
+  }
+
+  // nullptr if the entity is dead or lacks the component
+  template <typename T>
+  T* get(Entity entity) {
+    return const_cast<T*>(std::as_const(*this).get<T>(entity));
+  }
+
+  template <typename T>
+  const T* get(Entity entity) const {
+    if (!isAlive(entity)) {
+      return nullptr;
+    }
+    const Location& location = locations_[entity.index];
+    const Archetype& archetype = archetypes_[location.archetype];
+    if (!archetype.has(componentId<T>())) {
+      return nullptr;
+    }
+    return static_cast<const T*>(
+        archetype.at(componentId<T>(), location.row));
+  }
+
+  template <typename T>
+  bool has(Entity entity) const {
+    return get<T>(entity) != nullptr;
+  }
+
+  // Adds or overwrites a component, moving the entity to the archetype
+  // that has it
+  template <typename T>
+  void add(Entity entity, const T& component) {
+    if (!isAlive(entity)) {
+      return;
+    }
+    if (T* existing = get<T>(entity)) {
+      *existing = component;
+      return;
+    }
+    const Location location = locations_[entity.index];
+    std::vector<ColumnInfo> columns =
+        archetypes_[location.archetype].columnInfos();
+    columns.push_back(columnInfo<T>());
+    const uint32_t row =
+        migrate(entity, archetypes_[location.archetype].mask | bit<T>(),
+                std::move(columns));
+    Archetype& target = archetypes_[locations_[entity.index].archetype];
+    std::memcpy(target.at(componentId<T>(), row), &component, sizeof(T));
+  }
+
+  template <typename T>
+  void remove(Entity entity) {
+    if (!has<T>(entity)) {
+      return;
+    }
+    const Location location = locations_[entity.index];
+    std::vector<ColumnInfo> columns;
+    for (const ColumnInfo& column :
+         archetypes_[location.archetype].columnInfos()) {
+      if (column.id != componentId<T>()) {
+        columns.push_back(column);
+      }
+    }
+    migrate(entity, archetypes_[location.archetype].mask & ~bit<T>(),
+            std::move(columns));
+  }
+
+  // Calls f(entity, components&...) for every entity that has all of Ts
+  template <typename... Ts, typename F>
+  void each(F&& f) {
+    eachChunk<Ts...>(
+        [&f](size_t count, const Entity* entities, Ts*... components) {
+          for (size_t i = 0; i < count; ++i) {
+            f(entities[i], components[i]...);
+          }
+        });
+  }
+
+  template <typename... Ts, typename F>
+  void each(F&& f) const {
+    eachChunk<Ts...>(
+        [&f](size_t count, const Entity* entities, Ts*... components) {
+          for (size_t i = 0; i < count; ++i) {
+            f(entities[i], components[i]...);
+          }
+        });
+  }
+
+  // Calls f(count, entities, componentArrays...) once per matching
+  // archetype, for passes that want to work on whole arrays at a time
+  template <typename... Ts, typename F>
+  void eachChunk(F&& f) {
+    const ComponentMask mask = maskOf<std::remove_const_t<Ts>...>();
+    for (Archetype& archetype : archetypes_) {
+      if (archetype.matches(mask) && archetype.size() > 0) {
+        f(archetype.size(), archetype.entities.data(),
+          static_cast<Ts*>(archetype.column(
+              componentId<std::remove_const_t<Ts>>()))...);
+      }
+    }
+  }
+
+  template <typename... Ts, typename F>
+  void eachChunk(F&& f) const {
+    static_assert((std::is_const_v<Ts> && ...),
+                  "Queries on a const World take const components");
+    const ComponentMask mask = maskOf<std::remove_const_t<Ts>...>();
+    for (const Archetype& archetype : archetypes_) {
+      if (archetype.matches(mask) && archetype.size() > 0) {
+        f(archetype.size(), archetype.entities.data(),
+          static_cast<Ts*>(archetype.column(
+              componentId<std::remove_const_t<Ts>>()))...);
+      }
+    }
+  }
+
+  // Entities that have all of Ts
+  template <typename... Ts>
+  size_t count() const {
+    const ComponentMask mask = maskOf<std::remove_const_t<Ts>...>();
+    size_t total = 0;
+    for (const Archetype& archetype : archetypes_) {
+      if (archetype.matches(mask)) {
+        total += archetype.size();
+      }
+    }
+    return total;
+  }
+
+  size_t size() const { return aliveCount_; }
+  size_t getArchetypeCount() const { return archetypes_.size(); }
+
+  // Bytes held by live component rows and entity bookkeeping
+  size_t getComponentBytes() const {
+    size_t bytes = locations_.size() * sizeof(Location);
+    for (const Archetype& archetype : archetypes_) {
+      bytes += archetype.size() * (archetype.rowBytes + sizeof(Entity));
+    }
+    return bytes;
+  }
+
+  void clear() {
+    archetypes_.clear();
+    archetypeLookup_.clear();
+    locations_.clear();
+    freeIndices_.clear();
+    aliveCount_ = 0;
+  }
+
+ private:
+  static constexpr uint32_t NO_ARCHETYPE = ~0u;
+
+  struct ColumnInfo {
+    uint32_t id;
+    size_t size;
+  };
+
+  struct Column {
+    ColumnInfo info;
+    std::vector<unsigned char> data;
+  };
+
+  struct Archetype {
+    ComponentMask mask = 0;
+    size_t rowBytes = 0;
+    std::vector<Column> columns;
+    // Column index per component id, -1 if the archetype lacks it
+    int8_t columnOf[ecs_detail::MAX_COMPONENTS];
+    std::vector<Entity> entities;
+
+    size_t size() const { return entities.size(); }
+    bool matches(ComponentMask query) const {
+      return (mask & query) == query;
+    }
+    bool has(uint32_t id) const { return columnOf[id] >= 0; }
+
+    void* column(uint32_t id) {
+      return columns[columnOf[id]].data.data();
+    }
+    const void* column(uint32_t id) const {
+      return columns[columnOf[id]].data.data();
+    }
+    void* at(uint32_t id, uint32_t row) {
+      Column& c = columns[columnOf[id]];
+      return c.data.data() + row * c.info.size;
+    }
+    const void* at(uint32_t id, uint32_t row) const {
+      const Column& c = columns[columnOf[id]];
+      return c.data.data() + row * c.info.size;
+    }
+
+    uint32_t addRow(Entity entity) {
+      entities.push_back(entity);
+      for (Column& c : columns) {
+        c.data.resize(c.data.size() + c.info.size);
+      }
+      return static_cast<uint32_t>(entities.size() - 1);
+    }
+
+    std::vector<ColumnInfo> columnInfos() const {
+      std::vector<ColumnInfo> infos;
+      infos.reserve(columns.size());
+      for (const Column& c : columns) {
+        infos.push_back(c.info);
+      }
+      return infos;
+    }
+  };
+
+  struct Location {
+    uint32_t archetype = NO_ARCHETYPE;
+    uint32_t row = 0;
+    uint32_t generation = 0;
+    bool alive = false;
+  };
+
+  std::vector<Archetype> archetypes_;
+  std::unordered_map<ComponentMask, uint32_t> archetypeLookup_;
+  std::vector<Location> locations_;  // indexed by Entity::index
+  std::vector<uint32_t> freeIndices_;
+  size_t aliveCount_ = 0;
+
+  template <typename T>
+  static ComponentMask bit() {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Components are moved with memcpy");
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "Component arrays only have the default new alignment");
+    return ComponentMask{1} << componentId<T>();
+  }
+
+  template <typename... Ts>
+  static ComponentMask maskOf() {
+    return (ComponentMask{0} | ... | bit<Ts>());
+  }
+
+  template <typename T>
+  static ColumnInfo columnInfo() {
+    return {componentId<T>(), sizeof(T)};
+  }
+
+  uint32_t findArchetype(ComponentMask mask) const {
+    const auto it = archetypeLookup_.find(mask);
+    return it == archetypeLookup_.end() ? NO_ARCHETYPE : it->second;
+  }
+
+  uint32_t addArchetype(ComponentMask mask,
+                        const std::vector<ColumnInfo>& columns) {
+    Archetype archetype;
+    archetype.mask = mask;
+    std::memset(archetype.columnOf, -1, sizeof(archetype.columnOf));
+    for (const ColumnInfo& info : columns) {
+      archetype.columnOf[info.id] =
+          static_cast<int8_t>(archetype.columns.size());
+      archetype.columns.push_back({info, {}});
+      archetype.rowBytes += info.size;
+    }
+
+    const auto index = static_cast<uint32_t>(archetypes_.size());
+    archetypes_.push_back(std::move(archetype));
+    archetypeLookup_.emplace(mask, index);
+    return index;
+  }
+
+  Entity allocateEntity() {
+    uint32_t index;
+    if (!freeIndices_.empty()) {
+      index = freeIndices_.back();
+      freeIndices_.pop_back();
+    } else {
+      index = static_cast<uint32_t>(locations_.size());
+      locations_.emplace_back();
+    }
+    locations_[index].alive = true;
+    ++aliveCount_;
+    return {index, locations_[index].generation};
+  }
+
+  // Swap-removes a row; the entity moved into its place is re-pointed
+  void removeRow(uint32_t archetypeIndex, uint32_t row) {
+    Archetype& archetype = archetypes_[archetypeIndex];
+    const uint32_t last = static_cast<uint32_t>(archetype.size() - 1);
+    if (row != last) {
+      for (Column& c : archetype.columns) {
+        std::memcpy(c.data.data() + row * c.info.size,
+                    c.data.data() + last * c.info.size, c.info.size);
+      }
+      archetype.entities[row] = archetype.entities[last];
+      locations_[archetype.entities[row].index].row = row;
+    }
+    for (Column& c : archetype.columns) {
+      c.data.resize(c.data.size() - c.info.size);
+    }
+    archetype.entities.pop_back();
+  }
+
+  // Moves an entity to the archetype for mask, copying the components both
+  // archetypes have. Returns the entity's new row.
+  uint32_t migrate(Entity entity, ComponentMask mask,
+                   std::vector<ColumnInfo> columns) {
+    uint32_t targetIndex = findArchetype(mask);
+    if (targetIndex == NO_ARCHETYPE) {
+      targetIndex = addArchetype(mask, columns);
+    }
+
+    Location& location = locations_[entity.index];
+    const uint32_t sourceIndex = location.archetype;
+    const uint32_t sourceRow = location.row;
+    // addArchetype may have grown archetypes_, take references only now
+    Archetype& source = archetypes_[sourceIndex];
+    Archetype& target = archetypes_[targetIndex];
+
+    const uint32_t row = target.addRow(entity);
+    for (const Column& c : source.columns) {
+      if (target.has(c.info.id)) {
+        std::memcpy(target.at(c.info.id, row),
+                    c.data.data() + sourceRow * c.info.size, c.info.size);
+      }
+    }
+    removeRow(sourceIndex, sourceRow);
+
+    location.archetype = targetIndex;
+    location.row = row;
+    return row;
+  }
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_WORLD_H
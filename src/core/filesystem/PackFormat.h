@@ -0,0 +1,79 @@
+#ifndef SOLAR_SYSTEM_OPENGL_PACKFORMAT_H
+#define SOLAR_SYSTEM_OPENGL_PACKFORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// On-disk layout of the asset pack, shared by the runtime and asset_packer:
+//
+//   PackHeader
+//   file data, each blob aligned to PACK_DATA_ALIGNMENT
+//   PackEntry[entryCount], sorted by pathHash
+//   path string table (normalized paths, not null-terminated)
+//
+// All integers are little-endian.
+namespace Pack {
+
+constexpr char MAGIC[4] = {'S', 'P', 'A', 'K'};
+constexpr uint32_t VERSION = 1;
+constexpr uint64_t DATA_ALIGNMENT = 16;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t reserved;
+  uint64_t indexOffset;    // first PackEntry
+  uint64_t stringsOffset;  // path string table
+};
+
+struct Entry {
+  uint64_t pathHash;
+  uint64_t offset;  // from the start of the file
+  uint64_t size;
+  uint32_t pathOffset;  // into the string table
+  uint32_t pathLength;
+};
+
+static_assert(sizeof(Header) == 32, "Pack::Header layout changed");
+static_assert(sizeof(Entry) == 32, "Pack::Entry layout changed");
+
+// Turns "../textures\\sun.jpg" and "./textures/sun.jpg" into
+// "textures/sun.jpg" so runtime paths match the packed keys
+inline std::string normalizePath(std::string_view path) {
+  std::string result(path);
+  for (char& c : result) {
+    if (c == '\\') {
+      c = '/';
+    }
+  }
+
+  size_t start = 0;
+  while (true) {
+    if (result.compare(start, 3, "../") == 0) {
+      start += 3;
+    } else if (result.compare(start, 2, "./") == 0) {
+      start += 2;
+    } else if (start < result.size() && result[start] == '/') {
+      start += 1;
+    } else {
+      break;
+    }
+  }
+  return result.substr(start);
+}
+
+// 64-bit FNV-1a
+inline uint64_t hashPath(std::string_view normalizedPath) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : normalizedPath) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace Pack
+
+#endif  // SOLAR_SYSTEM_OPENGL_PACKFORMAT_H
@@ -0,0 +1,191 @@
+#include "VirtualFileSystem.h"
+
+#include <core/filesystem/MappedFile.h>
+#include <core/filesystem/PackFormat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+MappedFile packFile;
+const Pack::Entry* entries = nullptr;
+uint32_t entryCount = 0;
+const char* strings = nullptr;
+bool looseFileFallback = true;
+}  // namespace
+
+bool VirtualFileSystem::mount(const std::string& packPath) {
+  unmount();
+
+  if (!packFile.open(packPath)) {
+    std::cout << "No asset pack at " << packPath << ", using loose files"
+              << std::endl;
+    return false;
+  }
+
+  const unsigned char* base = packFile.data();
+  const size_t size = packFile.size();
+
+  Pack::Header header;
+  if (size < sizeof(header)) {
+    std::cerr << "Asset pack " << packPath << " is truncated" << std::endl;
+    packFile.close();
+    return false;
+  }
+  std::memcpy(&header, base, sizeof(header));
+
+  const uint64_t indexSize =
+      static_cast<uint64_t>(header.entryCount) * sizeof(Pack::Entry);
+  if (std::memcmp(header.magic, Pack::MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != Pack::VERSION || header.indexOffset > size ||
+      indexSize > size - header.indexOffset ||
+      header.indexOffset % alignof(Pack::Entry) != 0 ||
+      header.stringsOffset > size) {
+    std::cerr << "Asset pack " << packPath << " is invalid or from another "
+              << "version, using loose files" << std::endl;
+    packFile.close();
+    return false;
+  }
+
+  // Check every entry once so lookups can trust the index afterwards
+  const auto* index =
+      reinterpret_cast<const Pack::Entry*>(base + header.indexOffset);
+  const uint64_t stringsSize = size - header.stringsOffset;
+  for (uint32_t i = 0; i < header.entryCount; ++i) {
+    const Pack::Entry& entry = index[i];
+    if (static_cast<uint64_t>(entry.pathOffset) + entry.pathLength >
+            stringsSize ||
+        entry.offset > size || entry.size > size - entry.offset) {
+      std::cerr << "Asset pack " << packPath << " has an out-of-bounds "
+                << "entry, using loose files" << std::endl;
+      packFile.close();
+      return false;
+    }
+  }
+
+  entries = index;
+  entryCount = header.entryCount;
+  strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+
+  std::cout << "Mounted asset pack " << packPath << " (" << entryCount
+            << " files, " << size / 1024 << " KB)" << std::endl;
+  return true;
+}
+
+void VirtualFileSystem::unmount() {
+  packFile.close();
+  entries = nullptr;
+  entryCount = 0;
+  strings = nullptr;
+}
+
+bool VirtualFileSystem::isMounted() { return packFile.isOpen(); }
+
+FileView VirtualFileSystem::open(std::string_view path) {
+  FileView view;
+  if (findInPack(path, view)) {
+    return view;
+  }
+  if (looseFileFallback && readLooseFile(path, view)) {
+    return view;
+  }
+
+  std::cerr << "VFS: file not found: " << path << std::endl;
+  return view;
+}
+
+bool VirtualFileSystem::exists(std::string_view path) {
+  FileView view;
+  if (findInPack(path, view)) {
+    return true;
+  }
+  return looseFileFallback && std::ifstream(std::string(path)).good();
+}
+
+bool VirtualFileSystem::readRange(std::string_view path, uint64_t offset,
+                                  size_t size,
+                                  std::vector<unsigned char>& bytes) {
+  FileView view;
+  if (findInPack(path, view)) {
+    if (offset > view.size() || size > view.size() - offset) {
+      return false;
+    }
+    bytes.assign(view.data() + offset, view.data() + offset + size);
+    return true;
+  }
+  if (!looseFileFallback) {
+    return false;
+  }
+
+  std::ifstream file(std::string(path), std::ios::binary);
+  if (!file || !file.seekg(static_cast<std::streamoff>(offset))) {
+    return false;
+  }
+  bytes.resize(size);
+  if (!file.read(reinterpret_cast<char*>(bytes.data()),
+                 static_cast<std::streamsize>(size))) {
+    bytes.clear();
+    return false;
+  }
+  return true;
+}
+
+void VirtualFileSystem::setLooseFileFallback(bool enabled) {
+  looseFileFallback = enabled;
+}
+
+bool VirtualFileSystem::findInPack(std::string_view path, FileView& view) {
+  if (!entries) {
+    return false;
+  }
+
+  const std::string normalized = Pack::normalizePath(path);
+  const uint64_t hash = Pack::hashPath(normalized);
+
+  // The index is sorted by hash; colliding entries sit next to each other
+  // and are told apart by their stored path
+  const Pack::Entry* end = entries + entryCount;
+  const Pack::Entry* it = std::lower_bound(
+      entries, end, hash,
+      [](const Pack::Entry& entry, uint64_t value) {
+        return entry.pathHash < value;
+      });
+
+  for (; it != end && it->pathHash == hash; ++it) {
+    const std::string_view storedPath(strings + it->pathOffset,
+                                      it->pathLength);
+    if (storedPath != normalized) {
+      continue;
+    }
+
+    view.data_ = packFile.data() + it->offset;
+    view.size_ = static_cast<size_t>(it->size);
+    return true;
+  }
+  return false;
+}
+
+bool VirtualFileSystem::readLooseFile(std::string_view path, FileView& view) {
+  std::ifstream file(std::string(path), std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+
+  const std::streamsize size = file.tellg();
+  if (size <= 0) {
+    return false;
+  }
+  file.seekg(0, std::ios::beg);
+
+  view.ownedBytes_.resize(static_cast<size_t>(size));
+  if (!file.read(reinterpret_cast<char*>(view.ownedBytes_.data()), size)) {
+    view.ownedBytes_.clear();
+    return false;
+  }
+
+  view.data_ = view.ownedBytes_.data();
+  view.size_ = view.ownedBytes_.size();
+  return true;
+}
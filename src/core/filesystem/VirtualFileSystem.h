@@ -0,0 +1,65 @@
+#ifndef SOLAR_SYSTEM_OPENGL_VIRTUALFILESYSTEM_H
+#define SOLAR_SYSTEM_OPENGL_VIRTUALFILESYSTEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only bytes of one asset. Views into the mounted pack are zero-copy
+// and stay valid until VirtualFileSystem::unmount(); loose files are read
+// into a buffer the view owns.
+class FileView {
+ public:
+  FileView() = default;
+
+  FileView(const FileView&) = delete;
+  FileView& operator=(const FileView&) = delete;
+  // Moving a std::vector keeps its buffer, so data_ stays valid
+  FileView(FileView&&) noexcept = default;
+  FileView& operator=(FileView&&) noexcept = default;
+
+  bool isValid() const { return data_ != nullptr; }
+  bool isMapped() const { return isValid() && ownedBytes_.empty(); }
+  const unsigned char* data() const { return data_; }
+  size_t size() const { return size_; }
+  // Not null-terminated; an empty string for invalid views
+  std::string_view text() const {
+    return data_ ? std::string_view(reinterpret_cast<const char*>(data_), size_)
+                 : std::string_view("");
+  }
+
+ private:
+  friend class VirtualFileSystem;
+
+  const unsigned char* data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<unsigned char> ownedBytes_;
+};
+
+// Resolves asset paths against a memory-mapped pack (see PackFormat.h,
+// built by tools/asset_packer), falling back to loose files on disk.
+// Mount once at startup before any loads; lookups are read-only afterwards
+// and safe to call from worker threads.
+class VirtualFileSystem {
+ public:
+  static bool mount(const std::string& packPath);
+  static void unmount();
+  static bool isMounted();
+
+  // Paths may carry the "../" prefix used throughout the app
+  static FileView open(std::string_view path);
+  static bool exists(std::string_view path);
+  // Copies size bytes at offset without reading the rest of a loose file
+  static bool readRange(std::string_view path, uint64_t offset, size_t size,
+                        std::vector<unsigned char>& bytes);
+
+  static void setLooseFileFallback(bool enabled);
+
+ private:
+  static bool findInPack(std::string_view path, FileView& view);
+  static bool readLooseFile(std::string_view path, FileView& view);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_VIRTUALFILESYSTEM_H
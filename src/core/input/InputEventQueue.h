@@ -0,0 +1,70 @@
+#ifndef SOLAR_SYSTEM_OPENGL_INPUTEVENTQUEUE_H
+#define SOLAR_SYSTEM_OPENGL_INPUTEVENTQUEUE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+struct InputEvent {
+  enum class Type : uint8_t { Key, MouseButton, CursorMove, Scroll, Resize };
+
+  Type type = Type::Key;
+  int code = 0;    // key or mouse button
+  int action = 0;  // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT
+  int mods = 0;
+  // Cursor position, scroll offset or framebuffer size
+  double x = 0.0;
+  double y = 0.0;
+  // When the GLFW callback saw the event; GLFW has no OS timestamps
+  std::chrono::steady_clock::time_point time;
+};
+
+// Fixed-capacity FIFO of input events. GLFW callbacks push and
+// processInput pops, both on the main thread, so there is no locking.
+// Cursor motion is coalesced into the newest queued move; other events are
+// dropped (and counted) when the queue is full.
+class InputEventQueue {
+ public:
+  static constexpr size_t CAPACITY = 256;  // power of two
+
+  bool push(const InputEvent& event) {
+    if (event.type == InputEvent::Type::CursorMove && size_ > 0) {
+      InputEvent& newest = events_[(head_ + size_ - 1) & (CAPACITY - 1)];
+      if (newest.type == InputEvent::Type::CursorMove) {
+        // Keep the older timestamp: latency counts from the first move
+        newest.x = event.x;
+        newest.y = event.y;
+        return true;
+      }
+    }
+    if (size_ == CAPACITY) {
+      ++dropped_;
+      return false;
+    }
+    events_[(head_ + size_) & (CAPACITY - 1)] = event;
+    ++size_;
+    return true;
+  }
+
+  bool pop(InputEvent& event) {
+    if (size_ == 0) {
+      return false;
+    }
+    event = events_[head_];
+    head_ = (head_ + 1) & (CAPACITY - 1);
+    --size_;
+    return true;
+  }
+
+  size_t size() const { return size_; }
+  uint64_t getDroppedCount() const { return dropped_; }
+
+ private:
+  std::array<InputEvent, CAPACITY> events_{};
+  size_t head_ = 0;
+  size_t size_ = 0;
+  uint64_t dropped_ = 0;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_INPUTEVENTQUEUE_H
@@ -4,6 +4,11 @@
 
 #include "InputManager.h"
 
+#include <core/logging/Logger.h>
+
+#include <algorithm>
+#include <iostream>
+
 InputManager::InputManager(int windowWidth,
                            int windowHeight)
     : windowWidth_(windowWidth), windowHeight_(windowHeight) {}
@@ -16,32 +21,120 @@ void InputManager::setInputCallbacks(GLFWwindow* window) const {
   glfwSetScrollCallback(window, scroll_callback);
   glfwSetMouseButtonCallback(window, button_callback);
   glfwSetKeyCallback(window, key_callback);
+  glfwSetWindowRefreshCallback(window, refresh_callback);
 
   glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+  // Unaccelerated, unscaled motion straight from the device while the
+  // cursor is captured
+  if (glfwRawMouseMotionSupported()) {
+    glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    std::cout << "Raw mouse motion enabled" << std::endl;
+  }
 }
 
 bool InputManager::processInput(GLFWwindow* window, float deltaTime) {
-  if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+  float pointerX = 0.0f;
+  float pointerY = 0.0f;
+  bool pointerMoved = false;
+  float scroll = 0.0f;
+  Clock::time_point oldestEvent = Clock::time_point::max();
+
+  InputEvent event;
+  while (events_.pop(event)) {
+    oldestEvent = std::min(oldestEvent, event.time);
+    switch (event.type) {
+      case InputEvent::Type::Key:
+        handleKeyEvent(event);
+        break;
+      case InputEvent::Type::MouseButton:
+        if (event.code == GLFW_MOUSE_BUTTON_LEFT &&
+            event.action == GLFW_PRESS && primaryActionCallback_) {
+          dispatch(primaryActionCallback_);
+        }
+        break;
+      case InputEvent::Type::CursorMove:
+        handlePointerMovement(event.x, event.y, pointerX, pointerY);
+        pointerMoved = true;
+        break;
+      case InputEvent::Type::Scroll:
+        scroll += static_cast<float>(event.y);
+        break;
+      case InputEvent::Type::Resize: {
+        // glViewport needs the context, which may live on the render thread
+        const int width = static_cast<int>(event.x);
+        const int height = static_cast<int>(event.y);
+        dispatch([width, height] { glViewport(0, 0, width, height); });
+        break;
+      }
+    }
+  }
+
+  if (events_.getDroppedCount() != reportedDrops_) {
+    reportedDrops_ = events_.getDroppedCount();
+    LOG_WARNING("Input queue full, %llu events dropped so far",
+                static_cast<unsigned long long>(reportedDrops_));
+  }
+
+  if (pointerMoved && pointerMovementCallback_) {
+    dispatch([this, pointerX, pointerY] {
+      pointerMovementCallback_(pointerX, pointerY);
+    });
+  }
+  if (scroll != 0.0f && scrollCallback_) {
+    dispatch([this, scroll] { scrollCallback_(scroll); });
+  }
+
+  if (exitRequested_) {
     glfwSetWindowShouldClose(window, true);
     return true;
   }
 
-  float speedMultiplier = 1.0f;
-  if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-    speedMultiplier = 5.0f;
+  const float speedMultiplier =
+      isActionHeld(InputAction::Sprint) ? 5.0f : 1.0f;
+  for (const InputAction action : heldActions_) {
+    if (!isActionHeld(action)) {
+      continue;
+    }
+    notifyActivity();
+    dispatch([this, action, deltaTime, speedMultiplier] {
+      entry(action).whileHeld(deltaTime, speedMultiplier);
+    });
   }
 
-  for (auto& [key, action] : keyBindings) {
-    if (glfwGetKey(window, key) == GLFW_PRESS) {
-      action(deltaTime, speedMultiplier);
-    }
+  // Travels with the actions, so it reaches the thread that presents them
+  if (oldestEvent != Clock::time_point::max() && inputTimestampCallback_) {
+    dispatch([this, oldestEvent] { inputTimestampCallback_(oldestEvent); });
   }
   return false;
 }
 
-void InputManager::bindKey(int key, const std::function<void(float deltaTime, float speedMultiplier)>&
-                 onKeyBind) {
-  keyBindings[key] = onKeyBind;
+void InputManager::bindKey(int key, InputAction action, int requiredMods) {
+  if (key < 0 || key > GLFW_KEY_LAST) {
+    return;
+  }
+  keyBindings_[key] = {action, requiredMods};
+  entry(action).key = key;
+}
+
+void InputManager::setActionCallback(InputAction action,
+                                     const ActionCallback& callback,
+                                     bool runInPlace) {
+  entry(action).onPress = callback;
+  entry(action).runInPlace = runInPlace;
+}
+
+void InputManager::setHeldActionCallback(InputAction action,
+                                         const HeldActionCallback& callback) {
+  entry(action).whileHeld = callback;
+  if (std::find(heldActions_.begin(), heldActions_.end(), action) ==
+      heldActions_.end()) {
+    heldActions_.push_back(action);
+  }
+}
+
+bool InputManager::isActionHeld(InputAction action) const {
+  const int key = entry(action).key;
+  return key != GLFW_KEY_UNKNOWN && keysDown_.test(key);
 }
 
 void InputManager::setPointerMovementCallback(
@@ -58,45 +151,146 @@ void InputManager::setPrimaryActionCallback(
   primaryActionCallback_ = callback;
 }
 
-void InputManager::setFullscreenActionCallback(
-    const FullscreenActionCallback& callback) {
-  fullscreenActionCallback_ = callback;
+void InputManager::setInputTimestampCallback(
+    const InputTimestampCallback& callback) {
+  inputTimestampCallback_ = callback;
+}
+
+void InputManager::setActivityCallback(const ActivityCallback& callback) {
+  activityCallback_ = callback;
+}
+
+void InputManager::setDispatcher(const Dispatcher& dispatcher) {
+  dispatcher_ = dispatcher;
+}
+
+void InputManager::pushEvent(InputEvent event) {
+  event.time = Clock::now();
+  events_.push(event);
+  notifyActivity();
+}
+
+void InputManager::dispatch(std::function<void()> action) const {
+  if (dispatcher_) {
+    dispatcher_(std::move(action));
+  } else {
+    action();
+  }
+}
+
+void InputManager::notifyActivity() const {
+  if (activityCallback_) {
+    activityCallback_();
+  }
 }
 
 void InputManager::framebuffer_size_callback(GLFWwindow* window, int width,
                                              int height) {
-  glViewport(0, 0, width, height);
+  auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
+  if (manager) {
+    InputEvent event;
+    event.type = InputEvent::Type::Resize;
+    event.x = width;
+    event.y = height;
+    manager->pushEvent(event);
+  } else {
+    glViewport(0, 0, width, height);
+  }
 }
 
 void InputManager::pointer_position_callback(GLFWwindow* window, double xposIn, double yposIn) {
   auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
   if (manager) {
-    manager->handlePointerMovement(xposIn, yposIn);
+    InputEvent event;
+    event.type = InputEvent::Type::CursorMove;
+    event.x = xposIn;
+    event.y = yposIn;
+    manager->pushEvent(event);
   }
 }
 
 void InputManager::scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
   auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
   if (manager) {
-    manager->handleAxis(yoffset);
+    InputEvent event;
+    event.type = InputEvent::Type::Scroll;
+    event.x = xoffset;
+    event.y = yoffset;
+    manager->pushEvent(event);
   }
 }
 
 void InputManager::button_callback(GLFWwindow* window, int button, int action, int mods) {
   auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
   if (manager) {
-    manager->handlePrimaryActionKey(button, action);
+    InputEvent event;
+    event.type = InputEvent::Type::MouseButton;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    manager->pushEvent(event);
   }
 }
 
-void InputManager::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+void InputManager::key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int mods) {
   auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
   if (manager) {
-    manager->handleFullscreenKey(window, key, scancode, action, mods);
+    InputEvent event;
+    event.type = InputEvent::Type::Key;
+    event.code = key;
+    event.action = action;
+    event.mods = mods;
+    manager->pushEvent(event);
+  }
+}
+
+void InputManager::refresh_callback(GLFWwindow* window) {
+  // The window was exposed or damaged and needs its contents drawn again
+  auto* manager = static_cast<InputManager*>(glfwGetWindowUserPointer(window));
+  if (manager) {
+    manager->notifyActivity();
+  }
+}
+
+void InputManager::handleKeyEvent(const InputEvent& event) {
+  if (event.code < 0 || event.code > GLFW_KEY_LAST) {
+    return;
+  }
+
+  // GLFW sends releases for every held key when focus is lost, so the
+  // bitset cannot get stuck
+  if (event.action == GLFW_RELEASE) {
+    keysDown_.reset(event.code);
+    return;
+  }
+  if (event.action != GLFW_PRESS) {
+    return;  // auto-repeat
+  }
+  keysDown_.set(event.code);
+
+  const KeyBinding& binding = keyBindings_[event.code];
+  if (binding.action == InputAction::None ||
+      (event.mods & binding.requiredMods) != binding.requiredMods) {
+    return;
+  }
+  if (binding.action == InputAction::Exit) {
+    exitRequested_ = true;
+    return;
+  }
+
+  const ActionEntry& action = entry(binding.action);
+  if (!action.onPress) {
+    return;
+  }
+  if (action.runInPlace) {
+    action.onPress();
+  } else {
+    dispatch(action.onPress);
   }
 }
 
-void InputManager::handlePointerMovement(double xposIn, double yposIn) {
+void InputManager::handlePointerMovement(double xposIn, double yposIn,
+                                         float& xoffset, float& yoffset) {
   float xpos = static_cast<float>(xposIn);
   float ypos = static_cast<float>(yposIn);
 
@@ -106,34 +300,18 @@ void InputManager::handlePointerMovement(double xposIn, double yposIn) {
     firstPointer_ = false;
   }
 
-  float xoffset = xpos - lastPointerX_;
-  float yoffset = lastPointerY_ - ypos;
+  xoffset += xpos - lastPointerX_;
+  yoffset += lastPointerY_ - ypos;
 
   lastPointerX_ = xpos;
   lastPointerY_ = ypos;
-
-  if (pointerMovementCallback_) {
-    pointerMovementCallback_(xoffset, yoffset);
-  }
 }
 
-void InputManager::handleAxis(double yoffset) const {
-  if (scrollCallback_) {
-    scrollCallback_(static_cast<float>(yoffset));
-  }
+InputManager::ActionEntry& InputManager::entry(InputAction action) {
+  return actions_[static_cast<size_t>(action)];
 }
 
-void InputManager::handlePrimaryActionKey(int button, int action) const {
-  if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-    if (primaryActionCallback_) {
-      primaryActionCallback_();
-    }
-  }
+const InputManager::ActionEntry& InputManager::entry(
+    InputAction action) const {
+  return actions_[static_cast<size_t>(action)];
 }
-
-void InputManager::handleFullscreenKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
-  // ENTER + SHIFT = fullscreen mode
-  if (key == GLFW_KEY_ENTER && action == GLFW_PRESS && (mods & GLFW_MOD_SHIFT)) {
-    fullscreenActionCallback_();
-  }
-}
\ No newline at end of file
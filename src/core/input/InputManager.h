@@ -5,45 +5,114 @@
 #ifndef SOLAR_SYSTEM_OPENGL_INPUTMANAGER_H
 #define SOLAR_SYSTEM_OPENGL_INPUTMANAGER_H
 
+#include <core/input/InputEventQueue.h>
+
 #include "GLFW/glfw3.h"
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <vector>
+
+enum class InputAction : uint8_t {
+  None,
+  MoveForward,
+  MoveBackward,
+  MoveLeft,
+  MoveRight,
+  MoveUp,
+  MoveDown,
+  Sprint,
+  ToggleFullscreen,
+  ToggleMemoryPage,
+  CycleValidation,
+  CycleVsync,
+  ToggleLowLatency,
+  TogglePause,
+  Exit,
+  Count
+};
 
+// GLFW callbacks only timestamp events into a fixed-size queue; once per
+// frame processInput drains it, updates the key bitset and runs the bound
+// actions from flat tables indexed by key and by action. Cursor motion and
+// scrolling are summed over the frame and applied once.
 class InputManager {
 public:
+  using Clock = std::chrono::steady_clock;
   using PointerMovementCallback = std::function<void(float xoffset, float yoffset)>;
   using AxisCallback = std::function<void(float value)>;
   using PrimaryActionCallback = std::function<void()>;
-  using FullscreenActionCallback = std::function<void()>;
+  // On press of the bound key
+  using ActionCallback = std::function<void()>;
+  // Every frame while the bound key is down
+  using HeldActionCallback = std::function<void(float deltaTime, float speedMultiplier)>;
+  // Receives the oldest event consumed by a frame, to measure latency
+  using InputTimestampCallback = std::function<void(Clock::time_point eventTime)>;
+  // Called on any input event or held key binding, e.g. to redraw
+  using ActivityCallback = std::function<void()>;
+  // Receives every action instead of running it in place, e.g. to forward
+  // it to the render thread
+  using Dispatcher = std::function<void(std::function<void()> action)>;
 
   InputManager(int windowWidth, int windowHeight);
   void setInputCallbacks(GLFWwindow* window) const;
+  // Main thread, once per frame. Returns true when exit was requested.
   bool processInput(GLFWwindow* window, float deltaTime);
-  void bindKey(int key,
-               const std::function<void(float deltaTime, float speedMultiplier)>& onKeyBind);
+
+  // requiredMods must all be held for the action to trigger on press
+  void bindKey(int key, InputAction action, int requiredMods = 0);
+  // runInPlace skips the dispatcher, for actions that must stay on the main
+  // thread (GLFW window functions)
+  void setActionCallback(InputAction action, const ActionCallback& callback,
+                         bool runInPlace = false);
+  void setHeldActionCallback(InputAction action,
+                             const HeldActionCallback& callback);
+  bool isActionHeld(InputAction action) const;
 
   void setPointerMovementCallback(const PointerMovementCallback& callback);
   void setAxisCallback(const AxisCallback& callback);
   void setPrimaryActionCallback(const PrimaryActionCallback& callback);
-  void setFullscreenActionCallback(const FullscreenActionCallback& callback);
+  void setInputTimestampCallback(const InputTimestampCallback& callback);
+  void setActivityCallback(const ActivityCallback& callback);
+  void setDispatcher(const Dispatcher& dispatcher);
 
 private:
+  struct KeyBinding {
+    InputAction action = InputAction::None;
+    int requiredMods = 0;
+  };
+
+  struct ActionEntry {
+    ActionCallback onPress;
+    HeldActionCallback whileHeld;
+    bool runInPlace = false;
+    int key = GLFW_KEY_UNKNOWN;
+  };
+
   int windowWidth_;
   int windowHeight_;
 
-  float lastPointerX_ = static_cast<float>(windowWidth_) / 2.0f;;
-  float lastPointerY_ = static_cast<float>(windowHeight_) / 2.0f;;
+  float lastPointerX_ = static_cast<float>(windowWidth_) / 2.0f;
+  float lastPointerY_ = static_cast<float>(windowHeight_) / 2.0f;
   bool firstPointer_ = true;
+  bool exitRequested_ = false;
 
-  bool isFullscreen_ = false;
-
-  std::function<void(float deltaTime, float speedMultiplier)> onKeyBind_;
-
-  std::unordered_map<int, std::function<void(float deltaTime, float speedMultiplier)>> keyBindings;
+  InputEventQueue events_;
+  uint64_t reportedDrops_ = 0;
+  std::bitset<GLFW_KEY_LAST + 1> keysDown_;
+  std::array<KeyBinding, GLFW_KEY_LAST + 1> keyBindings_{};
+  std::array<ActionEntry, static_cast<size_t>(InputAction::Count)> actions_{};
+  // Actions with a held callback, so a frame only checks those keys
+  std::vector<InputAction> heldActions_;
 
   PointerMovementCallback pointerMovementCallback_;
   AxisCallback scrollCallback_;
   PrimaryActionCallback primaryActionCallback_;
-  FullscreenActionCallback fullscreenActionCallback_;
+  InputTimestampCallback inputTimestampCallback_;
+  ActivityCallback activityCallback_;
+  Dispatcher dispatcher_;
 
   // Input callbacks
   static void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -51,10 +120,15 @@ private:
   static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
   static void button_callback(GLFWwindow* window, int button, int action, int mods);
   static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+  static void refresh_callback(GLFWwindow* window);
 
-  void handlePointerMovement(double xposIn, double yposIn);
-  void handleAxis(double yoffset) const;
-  void handlePrimaryActionKey(int button, int action) const;
-  void handleFullscreenKey(GLFWwindow* window, int key, int scancode, int action, int mods);
+  void pushEvent(InputEvent event);
+  void dispatch(std::function<void()> action) const;
+  void notifyActivity() const;
+  void handleKeyEvent(const InputEvent& event);
+  void handlePointerMovement(double xposIn, double yposIn, float& xoffset,
+                             float& yoffset);
+  ActionEntry& entry(InputAction action);
+  const ActionEntry& entry(InputAction action) const;
 };
 #endif  // SOLAR_SYSTEM_OPENGL_INPUTMANAGER_H
@@ -0,0 +1,273 @@
+#include "Logger.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point startTime = Clock::now();
+
+struct Slot {
+  std::atomic<size_t> sequence{0};
+  LogLevel level = LogLevel::Info;
+  uint32_t suppressed = 0;
+  uint32_t thread = 0;
+  int64_t micros = 0;
+  char text[Logger::MESSAGE_SIZE];
+};
+
+constexpr size_t QUEUE_MASK = Logger::QUEUE_CAPACITY - 1;
+static_assert((Logger::QUEUE_CAPACITY & QUEUE_MASK) == 0,
+              "QUEUE_CAPACITY must be a power of two");
+
+// Bounded MPSC ring (Vyukov): a slot is free for producer position p when
+// its sequence equals p and readable by the writer once it equals p + 1
+Slot slots[Logger::QUEUE_CAPACITY];
+std::atomic<size_t> enqueuePosition{0};
+size_t dequeuePosition = 0;  // writer thread only
+std::atomic<size_t> writtenCount{0};
+std::atomic<size_t> droppedCount{0};
+
+std::atomic<int> minimumLevel{static_cast<int>(LogLevel::Trace)};
+std::atomic<bool> running{false};
+std::atomic<bool> writerSleeping{false};
+std::mutex writerMutex;
+std::condition_variable writerWake;
+std::thread writerThread;
+std::ofstream logFile;
+std::once_flag slotsInitialized;
+
+std::atomic<uint32_t> nextThreadIndex{0};
+thread_local const uint32_t threadIndex = nextThreadIndex.fetch_add(1);
+
+int64_t elapsedMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               startTime)
+      .count();
+}
+
+const char* levelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::Trace: return "TRACE";
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO ";
+    case LogLevel::Warning: return "WARN ";
+    case LogLevel::Error: return "ERROR";
+    default: return "     ";
+  }
+}
+
+void initializeSlots() {
+  for (size_t i = 0; i < Logger::QUEUE_CAPACITY; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+void writeLine(LogLevel level, uint32_t suppressed, uint32_t thread,
+               int64_t micros, const char* text) {
+  char prefix[48];
+  std::snprintf(prefix, sizeof(prefix), "[%9.3f] [T%u] %s ",
+                static_cast<double>(micros) / 1e6, thread, levelName(level));
+
+  std::ostream& console = level >= LogLevel::Warning ? std::cerr : std::cout;
+  console << prefix << text;
+  if (suppressed > 0) {
+    console << " (" << suppressed << " similar suppressed)";
+  }
+  console << '\n';
+
+  if (logFile.is_open()) {
+    logFile << prefix << text;
+    if (suppressed > 0) {
+      logFile << " (" << suppressed << " similar suppressed)";
+    }
+    logFile << '\n';
+  }
+}
+
+// Writer thread side; returns the number of messages written
+size_t drainQueue() {
+  size_t written = 0;
+  while (true) {
+    Slot& slot = slots[dequeuePosition & QUEUE_MASK];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+      break;
+    }
+    writeLine(slot.level, slot.suppressed, slot.thread, slot.micros,
+              slot.text);
+    slot.sequence.store(dequeuePosition + Logger::QUEUE_CAPACITY,
+                        std::memory_order_release);
+    ++dequeuePosition;
+    ++written;
+  }
+
+  if (written > 0) {
+    std::cout.flush();
+    if (logFile.is_open()) {
+      logFile.flush();
+    }
+    writtenCount.fetch_add(written, std::memory_order_release);
+  }
+  return written;
+}
+
+void writerLoop() {
+  size_t reportedDrops = 0;
+  while (true) {
+    const bool keepRunning = running.load(std::memory_order_acquire);
+    const size_t written = drainQueue();
+
+    const size_t dropped = droppedCount.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops) {
+      std::cerr << "Logger: queue full, dropped " << dropped - reportedDrops
+                << " message(s)" << std::endl;
+      reportedDrops = dropped;
+    }
+
+    if (!keepRunning) {
+      break;
+    }
+    if (written == 0) {
+      // Producers only notify while this is set; the timeout covers a
+      // message published just before it was
+      std::unique_lock<std::mutex> lock(writerMutex);
+      writerSleeping.store(true, std::memory_order_release);
+      writerWake.wait_for(lock, std::chrono::milliseconds(10));
+      writerSleeping.store(false, std::memory_order_release);
+    }
+  }
+}
+}  // namespace
+
+bool LogRateLimiter::allow(uint32_t& suppressed) {
+  const int64_t now = elapsedMicros();
+  int64_t start = windowStart_.load(std::memory_order_relaxed);
+  if (now - start >= 1000000 &&
+      windowStart_.compare_exchange_strong(start, now,
+                                           std::memory_order_relaxed)) {
+    windowCount_.store(0, std::memory_order_relaxed);
+  }
+
+  if (windowCount_.fetch_add(1, std::memory_order_relaxed) <
+      MESSAGES_PER_SECOND) {
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+  suppressed_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void Logger::start(const char* filePath) {
+  std::call_once(slotsInitialized, initializeSlots);
+  if (running.exchange(true)) {
+    return;
+  }
+
+  if (filePath && *filePath) {
+    logFile.open(filePath, std::ios::out | std::ios::trunc);
+    if (!logFile.is_open()) {
+      std::cerr << "Logger: could not open " << filePath << std::endl;
+    }
+  }
+  writerThread = std::thread(writerLoop);
+}
+
+void Logger::shutdown() {
+  if (!running.exchange(false)) {
+    return;
+  }
+  writerWake.notify_one();
+  if (writerThread.joinable()) {
+    writerThread.join();
+  }
+  if (logFile.is_open()) {
+    logFile.close();
+  }
+}
+
+void Logger::flush() {
+  if (!running.load(std::memory_order_acquire)) {
+    return;
+  }
+  const size_t target = enqueuePosition.load(std::memory_order_acquire);
+  while (writtenCount.load(std::memory_order_acquire) < target) {
+    writerWake.notify_one();
+    std::this_thread::yield();
+  }
+}
+
+void Logger::setLevel(LogLevel level) {
+  minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() {
+  return static_cast<LogLevel>(minimumLevel.load(std::memory_order_relaxed));
+}
+
+bool Logger::isEnabled(LogLevel level) {
+  return static_cast<int>(level) >=
+         minimumLevel.load(std::memory_order_relaxed);
+}
+
+void Logger::write(LogLevel level, uint32_t suppressed, const char* format,
+                   ...) {
+  va_list args;
+  va_start(args, format);
+
+  // Before start() and after shutdown() there is no writer: print directly
+  if (!running.load(std::memory_order_acquire)) {
+    char text[MESSAGE_SIZE];
+    std::vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writeLine(level, suppressed, threadIndex, elapsedMicros(), text);
+    (level >= LogLevel::Warning ? std::cerr : std::cout).flush();
+    return;
+  }
+
+  size_t position = enqueuePosition.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot = &slots[position & QUEUE_MASK];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const auto difference =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (difference == 0) {
+      if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      // Full: never block the caller on the writer
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      va_end(args);
+      return;
+    } else {
+      position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->level = level;
+  slot->suppressed = suppressed;
+  slot->thread = threadIndex;
+  slot->micros = elapsedMicros();
+  std::vsnprintf(slot->text, sizeof(slot->text), format, args);
+  va_end(args);
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  if (level >= LogLevel::Warning ||
+      writerSleeping.load(std::memory_order_acquire)) {
+    writerWake.notify_one();
+  }
+}
+
+size_t Logger::getDroppedCount() {
+  return droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+#ifndef SOLAR_SYSTEM_OPENGL_LOGGER_H
+#define SOLAR_SYSTEM_OPENGL_LOGGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class LogLevel { Trace, Debug, Info, Warning, Error, Off };
+
+// Messages below this level compile to nothing. Override with
+// -DSOLAR_LOG_MIN_LEVEL=0 (Trace) .. 4 (Error).
+#ifndef SOLAR_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SOLAR_LOG_MIN_LEVEL 2
+#else
+#define SOLAR_LOG_MIN_LEVEL 1
+#endif
+#endif
+
+// Call-site limiter used by the LOG_* macros: a burst of the same message
+// (a per-frame warning, a click handler) is cut to MESSAGES_PER_SECOND and
+// the next message that gets through reports how many were dropped
+class LogRateLimiter {
+ public:
+  static constexpr uint32_t MESSAGES_PER_SECOND = 10;
+
+  // true if the message may be written; suppressed receives the number of
+  // messages dropped since the last one that was
+  bool allow(uint32_t& suppressed);
+
+ private:
+  std::atomic<int64_t> windowStart_{0};
+  std::atomic<uint32_t> windowCount_{0};
+  std::atomic<uint32_t> suppressed_{0};
+};
+
+// Asynchronous logger. Producers format into a fixed-size slot of a bounded
+// lock-free MPSC ring and return immediately; a background thread writes
+// the slots to stdout/stderr and the optional log file. When the ring is
+// full the message is dropped and counted instead of blocking the caller.
+class Logger {
+ public:
+  static constexpr size_t QUEUE_CAPACITY = 1024;  // power of two
+  static constexpr size_t MESSAGE_SIZE = 240;     // longer text is cut
+
+  // Starts the writer thread; filePath may be empty for console only
+  static void start(const char* filePath = "");
+  // Writes everything still queued and stops the writer thread
+  static void shutdown();
+  // Blocks until the writer has caught up, e.g. before a crash/abort
+  static void flush();
+
+  static void setLevel(LogLevel level);
+  static LogLevel getLevel();
+  static bool isEnabled(LogLevel level);
+
+#if defined(__GNUC__) || defined(__clang__)
+  __attribute__((format(printf, 3, 4)))
+#endif
+  static void write(LogLevel level, uint32_t suppressed, const char* format,
+                    ...);
+
+  static size_t getDroppedCount();
+};
+
+#define SOLAR_LOG(level, ...)                                           \
+  do {                                                                  \
+    if constexpr (static_cast<int>(level) >= SOLAR_LOG_MIN_LEVEL) {     \
+      if (Logger::isEnabled(level)) {                                   \
+        static LogRateLimiter solarLogLimiter;                          \
+        uint32_t solarLogSuppressed = 0;                                \
+        if (solarLogLimiter.allow(solarLogSuppressed)) {                \
+          Logger::write(level, solarLogSuppressed, __VA_ARGS__);        \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  } while (0)
+
+#define LOG_TRACE(...) SOLAR_LOG(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) SOLAR_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) SOLAR_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) SOLAR_LOG(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) SOLAR_LOG(LogLevel::Error, __VA_ARGS__)
+
+#endif  // SOLAR_SYSTEM_OPENGL_LOGGER_H
@@ -0,0 +1,128 @@
+// Replaces the global operator new/delete so AllocationTracker can count
+// every heap allocation. Only compiled in with the SOLAR_TRACK_ALLOCATIONS
+// CMake option; the hooks must not allocate themselves.
+
+#ifdef SOLAR_TRACK_ALLOCATIONS
+
+#include <core/memory/AllocationTracker.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ALLOCATION_CALL_SITE() _ReturnAddress()
+#else
+#define ALLOCATION_CALL_SITE() __builtin_return_address(0)
+#endif
+
+namespace {
+void* allocate(size_t size, const void* callSite) {
+  void* memory = std::malloc(size == 0 ? 1 : size);
+  if (memory) {
+    AllocationTracker::recordAllocation(size, callSite);
+  }
+  return memory;
+}
+
+void* allocateAligned(size_t size, size_t alignment, const void* callSite) {
+  if (size == 0) {
+    size = 1;
+  }
+#ifdef _WIN32
+  void* memory = _aligned_malloc(size, alignment);
+#else
+  void* memory = nullptr;
+  if (posix_memalign(&memory, std::max(alignment, sizeof(void*)), size) != 0) {
+    memory = nullptr;
+  }
+#endif
+  if (memory) {
+    AllocationTracker::recordAllocation(size, callSite);
+  }
+  return memory;
+}
+
+void release(void* memory) {
+  if (memory) {
+    AllocationTracker::recordFree();
+    std::free(memory);
+  }
+}
+
+void releaseAligned(void* memory) {
+  if (memory) {
+    AllocationTracker::recordFree();
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+  }
+}
+}  // namespace
+
+void* operator new(size_t size) {
+  if (void* memory = allocate(size, ALLOCATION_CALL_SITE())) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  if (void* memory = allocate(size, ALLOCATION_CALL_SITE())) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size, ALLOCATION_CALL_SITE());
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size, ALLOCATION_CALL_SITE());
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  if (void* memory = allocateAligned(size, static_cast<size_t>(alignment),
+                                     ALLOCATION_CALL_SITE())) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  if (void* memory = allocateAligned(size, static_cast<size_t>(alignment),
+                                     ALLOCATION_CALL_SITE())) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { release(memory); }
+void operator delete[](void* memory) noexcept { release(memory); }
+void operator delete(void* memory, size_t) noexcept { release(memory); }
+void operator delete[](void* memory, size_t) noexcept { release(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  release(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  release(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+  releaseAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+  releaseAligned(memory);
+}
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+  releaseAligned(memory);
+}
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+  releaseAligned(memory);
+}
+
+#endif  // SOLAR_TRACK_ALLOCATIONS
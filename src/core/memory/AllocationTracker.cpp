@@ -0,0 +1,340 @@
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+namespace {
+// Zone 0 collects everything allocated outside a named zone
+std::atomic<const char*> zoneNames[AllocationTracker::MAX_ZONES] = {};
+std::atomic<size_t> zoneCount{1};
+std::mutex zoneMutex;
+thread_local size_t currentZone = 0;
+
+// The counters below are only touched by the frame thread, including the
+// reset in endFrame(), so they need no synchronization
+thread_local bool isFrameThread = false;
+// Set while capturing a call site, in case the stack walk allocates
+thread_local bool inRecord = false;
+
+AllocationStats frameStats;
+AllocationStats zoneFrameStats[AllocationTracker::MAX_ZONES];
+// Open addressing on the call site; a full table just stops recording new
+// sites for the rest of the frame
+AllocationSite siteSlots[AllocationTracker::MAX_SITES];
+
+#ifndef _WIN32
+// Deep enough to get from operator new through libstdc++ back into the app
+constexpr int MAX_CALL_SITE_DEPTH = 12;
+const void* executableBase = nullptr;
+
+// The return address of operator new mostly lies inside libstdc++
+// (std::string, std::function, ...), which says nothing about who
+// allocated. Walk up from it to the first frame in the executable.
+const void* findCallSite(const void* returnAddress) {
+  void* frames[MAX_CALL_SITE_DEPTH];
+  const int depth = backtrace(frames, MAX_CALL_SITE_DEPTH);
+  int frame = 0;
+  while (frame < depth && frames[frame] != returnAddress) {
+    ++frame;
+  }
+  for (; frame < depth; ++frame) {
+    Dl_info info;
+    if (dladdr(frames[frame], &info) && info.dli_fbase == executableBase) {
+      return frames[frame];
+    }
+  }
+  return returnAddress;
+}
+#else
+// The MSVC standard library is header-only, so the caller of operator new
+// is already application code
+const void* findCallSite(const void* returnAddress) { return returnAddress; }
+#endif
+
+AllocationStats lastFrame;
+AllocationStats lastZoneStats[AllocationTracker::MAX_ZONES];
+AllocationSite lastSites[AllocationTracker::MAX_SITES];
+size_t lastSiteCount = 0;
+
+enum class CheckState { Off, Warmup, Measuring, Done };
+CheckState checkState = CheckState::Off;
+long warmupFrames = 300;
+long checkFrames = 0;
+long checkFrameIndex = 0;
+long failingFrames = 0;
+size_t checkAllocations = 0;
+// Kept from the first failing frame, printed when the check ends so the
+// report itself does not allocate inside a measured frame
+AllocationSite firstFailureSites[AllocationTracker::MAX_SITES];
+size_t firstFailureSiteCount = 0;
+long firstFailureFrame = -1;
+int checkExitCode = 0;
+
+size_t siteIndex(uintptr_t address) {
+  return static_cast<size_t>((address >> 4) * 0x9E3779B97F4A7C15ull) %
+         AllocationTracker::MAX_SITES;
+}
+
+long readEnvironment(const char* name, long fallback) {
+  const char* value = std::getenv(name);
+  if (!value || !*value) {
+    return fallback;
+  }
+  return std::strtol(value, nullptr, 10);
+}
+
+void printSites(const AllocationSite* sites, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    std::cerr << "  " << sites[i].allocations << " allocs, "
+              << sites[i].bytes << " bytes from " << sites[i].address;
+#ifndef _WIN32
+    // Names need the executable linked with -rdynamic; otherwise resolve
+    // the module offset with addr2line
+    Dl_info info;
+    if (dladdr(sites[i].address, &info) && info.dli_fname) {
+      std::cerr << " (" << info.dli_fname << " +0x" << std::hex
+                << reinterpret_cast<uintptr_t>(sites[i].address) -
+                       reinterpret_cast<uintptr_t>(info.dli_fbase)
+                << std::dec;
+      if (info.dli_sname) {
+        std::cerr << " " << info.dli_sname;
+      }
+      std::cerr << ")";
+    }
+#endif
+    std::cerr << std::endl;
+  }
+}
+}  // namespace
+
+void AllocationTracker::recordAllocation(size_t size, const void* callSite) {
+  if (!isFrameThread) {
+    return;
+  }
+  ++frameStats.allocations;
+  frameStats.bytes += size;
+  ++zoneFrameStats[currentZone].allocations;
+  zoneFrameStats[currentZone].bytes += size;
+  if (inRecord) {
+    return;
+  }
+
+  inRecord = true;
+  const void* site = findCallSite(callSite);
+  inRecord = false;
+
+  size_t index = siteIndex(reinterpret_cast<uintptr_t>(site));
+  for (size_t probe = 0; probe < MAX_SITES; ++probe) {
+    AllocationSite& slot = siteSlots[index];
+    if (!slot.address) {
+      slot.address = site;
+    }
+    if (slot.address == site) {
+      ++slot.allocations;
+      slot.bytes += size;
+      return;
+    }
+    index = (index + 1) % MAX_SITES;
+  }
+}
+
+void AllocationTracker::recordFree() {
+  if (!isFrameThread) {
+    return;
+  }
+  ++frameStats.frees;
+  ++zoneFrameStats[currentZone].frees;
+}
+
+void AllocationTracker::setFrameThread() {
+#ifndef _WIN32
+  // The first backtrace() loads the unwinder and allocates; get that out
+  // of the way before anything is counted
+  void* frames[1];
+  backtrace(frames, 1);
+  Dl_info info;
+  if (dladdr(reinterpret_cast<const void*>(&findCallSite), &info)) {
+    executableBase = info.dli_fbase;
+  }
+#endif
+  isFrameThread = true;
+}
+
+bool AllocationTracker::configureFromEnvironment() {
+  checkFrames = readEnvironment("SOLAR_ALLOC_CHECK_FRAMES", 0);
+  if (checkFrames <= 0) {
+    return true;
+  }
+
+  if (!isEnabled()) {
+    std::cerr << "SOLAR_ALLOC_CHECK_FRAMES needs a build with "
+                 "-DSOLAR_TRACK_ALLOCATIONS=ON"
+              << std::endl;
+    checkExitCode = 1;
+    return false;
+  }
+
+  warmupFrames = std::max(0L, readEnvironment("SOLAR_ALLOC_CHECK_WARMUP", 300));
+  checkState = CheckState::Warmup;
+  std::cout << "Allocation check: " << checkFrames << " frames after "
+            << warmupFrames << " warmup frames" << std::endl;
+  return true;
+}
+
+bool AllocationTracker::isCheckRequested() {
+  return checkState != CheckState::Off;
+}
+
+bool AllocationTracker::endFrame() {
+  lastFrame = std::exchange(frameStats, AllocationStats{});
+  const size_t zones = zoneCount.load(std::memory_order_acquire);
+  for (size_t zone = 0; zone < zones; ++zone) {
+    lastZoneStats[zone] =
+        std::exchange(zoneFrameStats[zone], AllocationStats{});
+  }
+
+  lastSiteCount = 0;
+  for (auto& slot : siteSlots) {
+    if (slot.address) {
+      lastSites[lastSiteCount++] = std::exchange(slot, AllocationSite{});
+    }
+  }
+  std::sort(lastSites, lastSites + lastSiteCount,
+            [](const AllocationSite& a, const AllocationSite& b) {
+              return a.allocations > b.allocations;
+            });
+
+  switch (checkState) {
+    case CheckState::Off:
+    case CheckState::Done:
+      return false;
+    case CheckState::Warmup:
+      if (--warmupFrames <= 0) {
+        checkState = CheckState::Measuring;
+      }
+      return false;
+    case CheckState::Measuring:
+      break;
+  }
+
+  if (lastFrame.allocations > 0) {
+    if (failingFrames == 0) {
+      std::copy(lastSites, lastSites + lastSiteCount, firstFailureSites);
+      firstFailureSiteCount = lastSiteCount;
+      firstFailureFrame = checkFrameIndex;
+    }
+    ++failingFrames;
+    checkAllocations += lastFrame.allocations;
+  }
+
+  if (++checkFrameIndex < checkFrames) {
+    return false;
+  }
+
+  checkState = CheckState::Done;
+  if (failingFrames == 0) {
+    std::cout << "Allocation check passed: " << checkFrames
+              << " steady-state frames without allocations" << std::endl;
+    checkExitCode = 0;
+  } else {
+    std::cerr << "Allocation check FAILED: " << failingFrames << " of "
+              << checkFrames << " frames allocated (" << checkAllocations
+              << " allocations). Call sites of frame " << firstFailureFrame
+              << ":" << std::endl;
+    printSites(firstFailureSites, std::min<size_t>(firstFailureSiteCount, 10));
+    checkExitCode = 1;
+  }
+  return true;
+}
+
+int AllocationTracker::getCheckExitCode() { return checkExitCode; }
+
+const AllocationStats& AllocationTracker::getLastFrame() { return lastFrame; }
+
+size_t AllocationTracker::getZoneCount() {
+  return zoneCount.load(std::memory_order_acquire);
+}
+
+const char* AllocationTracker::getZoneName(size_t zone) {
+  if (zone == 0) {
+    return "OTHER";
+  }
+  const char* name = zone < MAX_ZONES
+                         ? zoneNames[zone].load(std::memory_order_acquire)
+                         : nullptr;
+  return name ? name : "UNKNOWN";
+}
+
+const AllocationStats& AllocationTracker::getZoneStats(size_t zone) {
+  return lastZoneStats[std::min(zone, MAX_ZONES - 1)];
+}
+
+size_t AllocationTracker::getTopSites(AllocationSite* sites, size_t maxSites) {
+  const size_t count = std::min(maxSites, lastSiteCount);
+  std::copy(lastSites, lastSites + count, sites);
+  return count;
+}
+
+void AllocationTracker::printTopSites(size_t maxSites) {
+  std::cerr << "Allocations last frame: " << lastFrame.allocations << " ("
+            << lastFrame.bytes << " bytes)" << std::endl;
+  printSites(lastSites, std::min(maxSites, lastSiteCount));
+}
+
+size_t AllocationTracker::registerZone(const char* name) {
+  const size_t count = zoneCount.load(std::memory_order_acquire);
+  for (size_t zone = 1; zone < count; ++zone) {
+    const char* existing = zoneNames[zone].load(std::memory_order_acquire);
+    if (existing == name || (existing && std::strcmp(existing, name) == 0)) {
+      return zone;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(zoneMutex);
+  const size_t lockedCount = zoneCount.load(std::memory_order_relaxed);
+  for (size_t zone = count; zone < lockedCount; ++zone) {
+    if (std::strcmp(zoneNames[zone].load(std::memory_order_relaxed), name) ==
+        0) {
+      return zone;
+    }
+  }
+  if (lockedCount == MAX_ZONES) {
+    // Out of zones: count it as OTHER rather than failing
+    return 0;
+  }
+  zoneNames[lockedCount].store(name, std::memory_order_release);
+  zoneCount.store(lockedCount + 1, std::memory_order_release);
+  return lockedCount;
+}
+
+size_t AllocationTracker::enterZone(size_t zone) {
+  const size_t previous = currentZone;
+  currentZone = zone;
+  return previous;
+}
+
+void AllocationTracker::leaveZone(size_t previousZone) {
+  currentZone = previousZone;
+}
+
+AllocationZone::AllocationZone(const char* name)
+    : previousZone_(AllocationTracker::isEnabled()
+                        ? AllocationTracker::enterZone(
+                              AllocationTracker::registerZone(name))
+                        : 0) {}
+
+AllocationZone::~AllocationZone() {
+  if (AllocationTracker::isEnabled()) {
+    AllocationTracker::leaveZone(previousZone_);
+  }
+}
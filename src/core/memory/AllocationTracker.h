@@ -0,0 +1,97 @@
+#ifndef SOLAR_SYSTEM_OPENGL_ALLOCATIONTRACKER_H
+#define SOLAR_SYSTEM_OPENGL_ALLOCATIONTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct AllocationStats {
+  size_t allocations = 0;
+  size_t frees = 0;
+  size_t bytes = 0;
+};
+
+struct AllocationSite {
+  const void* address = nullptr;  // first caller of operator new in the app
+  size_t allocations = 0;
+  size_t bytes = 0;
+};
+
+// Counts heap allocations per frame, per zone and per call site. The counts
+// come from the global operator new/delete replacement in
+// AllocationHooks.cpp, which is only compiled with the
+// SOLAR_TRACK_ALLOCATIONS CMake option; without it every query returns 0.
+// Only the thread that called setFrameThread() is counted, so loader and
+// logger workers never show up in a frame; endFrame() and the queries
+// belong to that thread as well.
+//
+// Setting SOLAR_ALLOC_CHECK_FRAMES=N runs the steady-state check: after
+// SOLAR_ALLOC_CHECK_WARMUP frames (default 300) the next N frames must not
+// allocate at all. The window is hidden, the app quits when the check is
+// done and main returns getCheckExitCode().
+class AllocationTracker {
+ public:
+  static constexpr size_t MAX_ZONES = 16;
+  static constexpr size_t MAX_SITES = 512;
+
+  static constexpr bool isEnabled() {
+#ifdef SOLAR_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // Called from the operator new/delete hooks; must never allocate.
+  // callSite is the return address of operator new.
+  static void recordAllocation(size_t size, const void* callSite);
+  static void recordFree();
+
+  // Starts counting the calling thread. Call once, from the thread that
+  // runs the frames (the render thread with AppConfig::RENDER_THREAD),
+  // before its first endFrame().
+  static void setFrameThread();
+
+  // Reads the SOLAR_ALLOC_CHECK_* variables; false if the check was
+  // requested but cannot run in this build
+  static bool configureFromEnvironment();
+  static bool isCheckRequested();
+  // Closes the current frame: snapshots the counters for the HUD and
+  // advances the steady-state check. Returns true once the check finished.
+  static bool endFrame();
+  static int getCheckExitCode();
+
+  static const AllocationStats& getLastFrame();
+  static size_t getZoneCount();
+  static const char* getZoneName(size_t zone);
+  static const AllocationStats& getZoneStats(size_t zone);
+  // Busiest call sites of the last frame, most allocations first
+  static size_t getTopSites(AllocationSite* sites, size_t maxSites);
+  static void printTopSites(size_t maxSites);
+
+ private:
+  friend class AllocationZone;
+  static size_t registerZone(const char* name);
+  static size_t enterZone(size_t zone);
+  static void leaveZone(size_t previousZone);
+};
+
+// Attributes allocations on this thread to a named zone until it goes out
+// of scope. The name must be a string literal.
+class AllocationZone {
+ public:
+  explicit AllocationZone(const char* name);
+  ~AllocationZone();
+
+  AllocationZone(const AllocationZone&) = delete;
+  AllocationZone& operator=(const AllocationZone&) = delete;
+
+ private:
+  size_t previousZone_;
+};
+
+#define ALLOCATION_ZONE_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_ZONE_CONCAT(a, b) ALLOCATION_ZONE_CONCAT_INNER(a, b)
+#define ALLOCATION_ZONE(name) \
+  AllocationZone ALLOCATION_ZONE_CONCAT(allocationZone_, __LINE__)(name)
+
+#endif  // SOLAR_SYSTEM_OPENGL_ALLOCATIONTRACKER_H
@@ -0,0 +1,156 @@
+#include "FrameArena.h"
+
+#include <core/memory/MemoryTracker.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+namespace {
+unsigned char* block = nullptr;
+size_t capacity = 0;
+size_t sliceSize = 0;
+std::atomic<size_t> offset{0};
+// Bumped on every reset so threads drop slices from earlier frames
+std::atomic<uint64_t> generation{1};
+size_t peakBytes = 0;
+
+std::mutex overflowMutex;
+std::vector<void*> overflowBlocks;
+size_t overflowBytes = 0;
+size_t worstOverflowBytes = 0;
+
+struct ThreadSlice {
+  uintptr_t cursor = 0;
+  uintptr_t end = 0;
+  uint64_t generation = 0;
+};
+thread_local ThreadSlice threadSlice;
+
+uintptr_t alignUp(uintptr_t value, size_t alignment) {
+  return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+// Carves bytes out of the shared block; nullptr once it is exhausted
+unsigned char* takeFromBlock(size_t size, size_t alignment) {
+  const size_t padded = size + alignment - 1;
+  const size_t start = offset.fetch_add(padded, std::memory_order_relaxed);
+  if (!block || start + padded > capacity) {
+    return nullptr;
+  }
+  return reinterpret_cast<unsigned char*>(
+      alignUp(reinterpret_cast<uintptr_t>(block + start), alignment));
+}
+
+void* allocateOverflow(size_t size) {
+  void* memory = std::malloc(size);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  std::lock_guard<std::mutex> lock(overflowMutex);
+  overflowBlocks.push_back(memory);
+  overflowBytes += size;
+  return memory;
+}
+}  // namespace
+
+void FrameArena::initialize(size_t arenaCapacity, size_t arenaSliceSize) {
+  shutdown();
+
+  block = static_cast<unsigned char*>(std::malloc(arenaCapacity));
+  capacity = block ? arenaCapacity : 0;
+  sliceSize = arenaSliceSize;
+  offset.store(0, std::memory_order_relaxed);
+  generation.fetch_add(1, std::memory_order_release);
+  // Reserved once, so the overflow list never grows in a normal frame
+  overflowBlocks.reserve(64);
+
+  MemoryTracker::allocate(MemoryCategory::FrameArena, MemoryDomain::CPU,
+                          capacity);
+  std::cout << "Frame arena: " << capacity / 1024 << " KB, "
+            << sliceSize / 1024 << " KB slices" << std::endl;
+}
+
+void FrameArena::shutdown() {
+  reset();
+  if (block) {
+    std::free(block);
+    MemoryTracker::release(MemoryCategory::FrameArena, MemoryDomain::CPU,
+                           capacity);
+  }
+  block = nullptr;
+  capacity = 0;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+  if (size == 0) {
+    size = 1;
+  }
+
+  ThreadSlice& slice = threadSlice;
+  const uint64_t currentGeneration =
+      generation.load(std::memory_order_acquire);
+  if (slice.generation != currentGeneration) {
+    slice = ThreadSlice{0, 0, currentGeneration};
+  }
+
+  uintptr_t aligned = alignUp(slice.cursor, alignment);
+  if (slice.cursor == 0 || aligned + size > slice.end) {
+    // Big requests go straight to the block instead of wasting a slice
+    if (size + alignment > sliceSize / 4) {
+      if (unsigned char* memory = takeFromBlock(size, alignment)) {
+        return memory;
+      }
+      return allocateOverflow(size);
+    }
+
+    unsigned char* fresh = takeFromBlock(sliceSize, alignof(std::max_align_t));
+    if (!fresh) {
+      return allocateOverflow(size);
+    }
+    slice.cursor = reinterpret_cast<uintptr_t>(fresh);
+    slice.end = slice.cursor + sliceSize;
+    aligned = alignUp(slice.cursor, alignment);
+  }
+
+  slice.cursor = aligned + size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+void FrameArena::reset() {
+  const size_t used = std::min(offset.load(std::memory_order_relaxed), capacity);
+  peakBytes = std::max(peakBytes, used);
+
+  {
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    // Warn only when a frame overflows worse than before, not every frame
+    if (overflowBytes > worstOverflowBytes) {
+      worstOverflowBytes = overflowBytes;
+      std::cerr << "Frame arena overflowed by " << overflowBytes / 1024
+                << " KB (" << overflowBlocks.size()
+                << " heap allocations), raise FRAME_ARENA_BYTES" << std::endl;
+    }
+    if (!overflowBlocks.empty()) {
+      for (void* memory : overflowBlocks) {
+        std::free(memory);
+      }
+      overflowBlocks.clear();
+      overflowBytes = 0;
+    }
+  }
+
+  offset.store(0, std::memory_order_relaxed);
+  generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t FrameArena::getCapacity() { return capacity; }
+
+size_t FrameArena::getUsedBytes() {
+  return std::min(offset.load(std::memory_order_relaxed), capacity);
+}
+
+size_t FrameArena::getPeakBytes() { return peakBytes; }
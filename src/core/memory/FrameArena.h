@@ -0,0 +1,57 @@
+#ifndef SOLAR_SYSTEM_OPENGL_FRAMEARENA_H
+#define SOLAR_SYSTEM_OPENGL_FRAMEARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Linear allocator for data that lives no longer than one frame.
+//
+// One block is reserved up front; each thread bumps through its own slice
+// of it so allocations need no locking, and reset() at the end of the
+// frame rewinds everything at once. Memory handed out must not be touched
+// after reset(). When the block runs out allocations fall back to the heap
+// (freed on reset) and a warning is printed, so raise the capacity then.
+class FrameArena {
+ public:
+  static void initialize(size_t capacity, size_t sliceSize);
+  static void shutdown();
+
+  static void* allocate(size_t size, size_t alignment);
+  // Frame end, on the main thread, once no other thread uses frame memory
+  static void reset();
+
+  static size_t getCapacity();
+  static size_t getUsedBytes();
+  static size_t getPeakBytes();
+};
+
+// std-compatible allocator over the frame arena; deallocate is a no-op
+template <typename T>
+class FrameAllocator {
+ public:
+  using value_type = T;
+
+  FrameAllocator() = default;
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(
+        FrameArena::allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, size_t) {}
+
+  template <typename U>
+  bool operator==(const FrameAllocator<U>&) const { return true; }
+  template <typename U>
+  bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+using FrameString =
+    std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif  // SOLAR_SYSTEM_OPENGL_FRAMEARENA_H
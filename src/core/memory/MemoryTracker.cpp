@@ -0,0 +1,145 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+struct Counter {
+  std::atomic<size_t> current{0};
+  std::atomic<size_t> peak{0};
+  std::atomic<size_t> budget{0};
+};
+
+constexpr size_t CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::Count);
+constexpr size_t DOMAIN_COUNT = static_cast<size_t>(MemoryDomain::Count);
+
+Counter counters[CATEGORY_COUNT][DOMAIN_COUNT];
+
+Counter& counterFor(MemoryCategory category, MemoryDomain domain) {
+  return counters[static_cast<size_t>(category)][static_cast<size_t>(domain)];
+}
+
+void updatePeak(Counter& counter, size_t value) {
+  size_t peak = counter.peak.load(std::memory_order_relaxed);
+  while (value > peak &&
+         !counter.peak.compare_exchange_weak(peak, value,
+                                             std::memory_order_relaxed)) {
+  }
+}
+}  // namespace
+
+void MemoryTracker::allocate(MemoryCategory category, MemoryDomain domain,
+                             size_t bytes) {
+  Counter& counter = counterFor(category, domain);
+  const size_t current =
+      counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  updatePeak(counter, current);
+}
+
+void MemoryTracker::release(MemoryCategory category, MemoryDomain domain,
+                            size_t bytes) {
+  Counter& counter = counterFor(category, domain);
+  size_t current = counter.current.load(std::memory_order_relaxed);
+  // Clamp at zero: an unmatched release is a bookkeeping bug, not a reason
+  // to report 16 exabytes in use
+  while (!counter.current.compare_exchange_weak(
+      current, current > bytes ? current - bytes : 0,
+      std::memory_order_relaxed)) {
+  }
+  if (bytes > current) {
+    std::cerr << "MemoryTracker: releasing " << bytes << " bytes from "
+              << getCategoryName(category) << " " << getDomainName(domain)
+              << " with only " << current << " tracked" << std::endl;
+  }
+}
+
+void MemoryTracker::resize(MemoryCategory category, MemoryDomain domain,
+                           size_t oldBytes, size_t newBytes) {
+  if (newBytes > oldBytes) {
+    allocate(category, domain, newBytes - oldBytes);
+  } else if (oldBytes > newBytes) {
+    release(category, domain, oldBytes - newBytes);
+  }
+}
+
+void MemoryTracker::setBudget(MemoryCategory category, MemoryDomain domain,
+                              size_t bytes) {
+  counterFor(category, domain).budget.store(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getHeadroom(MemoryCategory category,
+                                  MemoryDomain domain) {
+  const Counter& counter = counterFor(category, domain);
+  const size_t budget = counter.budget.load(std::memory_order_relaxed);
+  if (budget == 0) {
+    return SIZE_MAX;
+  }
+  const size_t current = counter.current.load(std::memory_order_relaxed);
+  return current < budget ? budget - current : 0;
+}
+
+bool MemoryTracker::canAllocate(MemoryCategory category, MemoryDomain domain,
+                                size_t bytes) {
+  return bytes <= getHeadroom(category, domain);
+}
+
+MemoryStats MemoryTracker::getStats(MemoryCategory category,
+                                    MemoryDomain domain) {
+  const Counter& counter = counterFor(category, domain);
+  MemoryStats stats;
+  stats.current = counter.current.load(std::memory_order_relaxed);
+  stats.peak = counter.peak.load(std::memory_order_relaxed);
+  stats.budget = counter.budget.load(std::memory_order_relaxed);
+  return stats;
+}
+
+size_t MemoryTracker::getTotal(MemoryDomain domain) {
+  size_t total = 0;
+  for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+    total += getStats(static_cast<MemoryCategory>(i), domain).current;
+  }
+  return total;
+}
+
+const char* MemoryTracker::getCategoryName(MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::Meshes: return "MESHES";
+    case MemoryCategory::Textures: return "TEXTURES";
+    case MemoryCategory::StreamingBuffers: return "STREAMING";
+    case MemoryCategory::Simulation: return "SIMULATION";
+    case MemoryCategory::UI: return "UI";
+    case MemoryCategory::Shaders: return "SHADERS";
+    case MemoryCategory::FrameArena: return "FRAME ARENA";
+    default: return "UNKNOWN";
+  }
+}
+
+const char* MemoryTracker::getDomainName(MemoryDomain domain) {
+  return domain == MemoryDomain::GPU ? "GPU" : "CPU";
+}
+
+void MemoryTracker::printReport() {
+  std::cout << "\n=== Memory Report (KB: current / peak / budget) ===\n";
+  for (size_t d = 0; d < DOMAIN_COUNT; d++) {
+    const auto domain = static_cast<MemoryDomain>(d);
+    for (size_t c = 0; c < CATEGORY_COUNT; c++) {
+      const auto category = static_cast<MemoryCategory>(c);
+      const MemoryStats stats = getStats(category, domain);
+      std::cout << "  " << getDomainName(domain) << " " << std::left
+                << std::setw(12) << getCategoryName(category) << std::right
+                << stats.current / 1024 << " / " << stats.peak / 1024
+                << " / ";
+      if (stats.budget > 0) {
+        std::cout << stats.budget / 1024;
+      } else {
+        std::cout << "-";
+      }
+      std::cout << "\n";
+    }
+    std::cout << "  " << getDomainName(domain)
+              << " total: " << getTotal(domain) / 1024 << " KB\n";
+  }
+  std::cout << std::endl;
+}
@@ -0,0 +1,55 @@
+#ifndef SOLAR_SYSTEM_OPENGL_MEMORYTRACKER_H
+#define SOLAR_SYSTEM_OPENGL_MEMORYTRACKER_H
+
+#include <cstddef>
+
+enum class MemoryCategory {
+  Meshes,            // vertex/index buffers and their CPU copies
+  Textures,          // planet, ring and skybox textures, decoded images
+  StreamingBuffers,  // PBOs and staging copies used for uploads
+  Simulation,        // body state arrays
+  UI,                // glyph textures and text buffers
+  Shaders,           // GL programs (estimated from source size)
+  FrameArena,        // per-frame scratch block
+  Count
+};
+
+enum class MemoryDomain { GPU, CPU, Count };
+
+struct MemoryStats {
+  size_t current = 0;
+  size_t peak = 0;
+  size_t budget = 0;  // 0 = unlimited
+};
+
+// Process-wide accounting of GPU and CPU memory per category. Subsystems
+// report their own allocations; counters are atomic so loader threads can
+// report too. Query getHeadroom()/canAllocate() before large allocations.
+class MemoryTracker {
+ public:
+  static void allocate(MemoryCategory category, MemoryDomain domain,
+                       size_t bytes);
+  static void release(MemoryCategory category, MemoryDomain domain,
+                      size_t bytes);
+  // Replaces a previously reported size, e.g. when a texture is re-specified
+  static void resize(MemoryCategory category, MemoryDomain domain,
+                     size_t oldBytes, size_t newBytes);
+
+  static void setBudget(MemoryCategory category, MemoryDomain domain,
+                        size_t bytes);
+  // Bytes left before the budget is hit; SIZE_MAX without a budget
+  static size_t getHeadroom(MemoryCategory category, MemoryDomain domain);
+  static bool canAllocate(MemoryCategory category, MemoryDomain domain,
+                          size_t bytes);
+
+  static MemoryStats getStats(MemoryCategory category, MemoryDomain domain);
+  static size_t getTotal(MemoryDomain domain);
+
+  static const char* getCategoryName(MemoryCategory category);
+  static const char* getDomainName(MemoryDomain domain);
+
+  // Prints every category; non-zero "current" at shutdown means a leak
+  static void printReport();
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_MEMORYTRACKER_H
@@ -0,0 +1,162 @@
+#include "GpuDeletionQueue.h"
+
+#include <core/logging/Logger.h>
+#include <utils/debug_utils.h>
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace {
+struct Batch {
+  std::vector<GLuint> vertexArrays;
+  std::vector<GLuint> buffers;
+  std::vector<GLuint> textures;
+  std::vector<GLuint> programs;
+  std::vector<GLuint> framebuffers;
+  std::vector<std::pair<MemoryCategory, size_t>> bytes;
+  GLsync fence = nullptr;
+
+  size_t objectCount() const {
+    return vertexArrays.size() + buffers.size() + textures.size() +
+           programs.size() + framebuffers.size();
+  }
+  bool empty() const { return objectCount() == 0 && bytes.empty(); }
+};
+
+// Collects this frame's objects
+Batch current;
+// Fenced batches, oldest first
+std::deque<Batch> inFlight;
+// Emptied batches keep their capacity, so steady churn does not allocate
+std::vector<Batch> spareBatches;
+size_t pendingCount = 0;
+
+void destroyBatch(Batch& batch) {
+  // Deleting unbinds from the current context; nothing is bound first
+  if (!batch.vertexArrays.empty()) {
+    GL_CHECK(glDeleteVertexArrays(
+        static_cast<GLsizei>(batch.vertexArrays.size()),
+        batch.vertexArrays.data()));
+  }
+  if (!batch.buffers.empty()) {
+    GL_CHECK(glDeleteBuffers(static_cast<GLsizei>(batch.buffers.size()),
+                             batch.buffers.data()));
+  }
+  if (!batch.textures.empty()) {
+    GL_CHECK(glDeleteTextures(static_cast<GLsizei>(batch.textures.size()),
+                              batch.textures.data()));
+  }
+  if (!batch.framebuffers.empty()) {
+    GL_CHECK(glDeleteFramebuffers(
+        static_cast<GLsizei>(batch.framebuffers.size()),
+        batch.framebuffers.data()));
+  }
+  // There is no array form for programs
+  for (const GLuint program : batch.programs) {
+    glDeleteProgram(program);
+  }
+  for (const auto& [category, bytes] : batch.bytes) {
+    MemoryTracker::release(category, MemoryDomain::GPU, bytes);
+  }
+  if (batch.fence) {
+    glDeleteSync(batch.fence);
+    batch.fence = nullptr;
+  }
+
+  pendingCount -= batch.objectCount();
+  LOG_DEBUG("Deleted %zu deferred GL objects", batch.objectCount());
+
+  batch.vertexArrays.clear();
+  batch.buffers.clear();
+  batch.textures.clear();
+  batch.programs.clear();
+  batch.framebuffers.clear();
+  batch.bytes.clear();
+}
+
+// Moves the current batch out and starts a new one from a spare
+void closeCurrentBatch(GLsync fence) {
+  current.fence = fence;
+  inFlight.push_back(std::move(current));
+  if (!spareBatches.empty()) {
+    current = std::move(spareBatches.back());
+    spareBatches.pop_back();
+  } else {
+    current = Batch();
+  }
+}
+
+void queue(std::vector<GLuint>& objects, unsigned int id) {
+  if (id != 0) {
+    objects.push_back(id);
+    ++pendingCount;
+  }
+}
+}  // namespace
+
+void GpuDeletionQueue::deleteVertexArray(unsigned int vao) {
+  queue(current.vertexArrays, vao);
+}
+
+void GpuDeletionQueue::deleteBuffer(unsigned int buffer) {
+  queue(current.buffers, buffer);
+}
+
+void GpuDeletionQueue::deleteTexture(unsigned int texture) {
+  queue(current.textures, texture);
+}
+
+void GpuDeletionQueue::deleteProgram(unsigned int program) {
+  queue(current.programs, program);
+}
+
+void GpuDeletionQueue::deleteFramebuffer(unsigned int framebuffer) {
+  queue(current.framebuffers, framebuffer);
+}
+
+void GpuDeletionQueue::releaseBytes(MemoryCategory category, size_t bytes) {
+  if (bytes > 0) {
+    current.bytes.emplace_back(category, bytes);
+  }
+}
+
+void GpuDeletionQueue::endFrame() {
+  if (!current.empty()) {
+    closeCurrentBatch(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  }
+
+  // Fences signal in submission order, stop at the first one still busy
+  while (!inFlight.empty()) {
+    Batch& batch = inFlight.front();
+    const GLenum status = glClientWaitSync(batch.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+      break;
+    }
+    destroyBatch(batch);
+    spareBatches.push_back(std::move(batch));
+    inFlight.pop_front();
+  }
+}
+
+void GpuDeletionQueue::flush() {
+  if (!current.empty()) {
+    closeCurrentBatch(nullptr);
+  }
+  if (inFlight.empty()) {
+    return;
+  }
+
+  glFinish();
+  for (Batch& batch : inFlight) {
+    destroyBatch(batch);
+  }
+  inFlight.clear();
+  spareBatches.clear();
+}
+
+size_t GpuDeletionQueue::getPendingCount() {
+  return pendingCount;
+}
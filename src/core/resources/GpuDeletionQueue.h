@@ -0,0 +1,37 @@
+#ifndef SOLAR_SYSTEM_OPENGL_GPUDELETIONQUEUE_H
+#define SOLAR_SYSTEM_OPENGL_GPUDELETIONQUEUE_H
+
+#include <core/memory/MemoryTracker.h>
+
+#include <cstddef>
+
+// Deferred, batched deletion of GL objects.
+//
+// Managers queue the objects of a released resource instead of deleting
+// them on the spot, so a frame that drops many resources issues no binds
+// and no deletes in the middle of its draws. endFrame() closes the frame's
+// batch with a fence; once the GPU has passed that fence every object in
+// the batch is deleted with one glDelete* call per kind. GL thread only.
+class GpuDeletionQueue {
+ public:
+  static void deleteVertexArray(unsigned int vao);
+  static void deleteBuffer(unsigned int buffer);
+  static void deleteTexture(unsigned int texture);
+  static void deleteProgram(unsigned int program);
+  static void deleteFramebuffer(unsigned int framebuffer);
+  // GPU memory the queued objects still occupy; released from the
+  // MemoryTracker when they are actually deleted
+  static void releaseBytes(MemoryCategory category, size_t bytes);
+
+  // Frame end, after the frame's last draw: fences its batch and deletes
+  // every batch the GPU has finished with
+  static void endFrame();
+  // Before the GL context goes away: waits for the GPU and deletes
+  // everything still queued
+  static void flush();
+
+  // Objects queued and not yet deleted
+  static size_t getPendingCount();
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_GPUDELETIONQUEUE_H
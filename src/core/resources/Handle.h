@@ -0,0 +1,31 @@
+#ifndef SOLAR_SYSTEM_OPENGL_HANDLE_H
+#define SOLAR_SYSTEM_OPENGL_HANDLE_H
+
+#include <cstdint>
+
+// Generational reference to a pooled resource (see HandlePool). The tag
+// only keeps texture, program and mesh handles from mixing; a default
+// handle is invalid, and a handle outlives its resource as a stale value
+// rather than a dangling GL id.
+template <typename Tag>
+struct Handle {
+  uint32_t index = 0;
+  uint32_t generation = 0;  // 0 is never handed out
+
+  bool isValid() const { return generation != 0; }
+  bool operator==(const Handle& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+struct TextureTag;
+struct ProgramTag;
+struct MeshTag;
+
+using TextureHandle = Handle<TextureTag>;
+using ProgramHandle = Handle<ProgramTag>;
+// A VAO with its vertex and index buffers
+using MeshHandle = Handle<MeshTag>;
+
+#endif  // SOLAR_SYSTEM_OPENGL_HANDLE_H
@@ -0,0 +1,179 @@
+#ifndef SOLAR_SYSTEM_OPENGL_HANDLEPOOL_H
+#define SOLAR_SYSTEM_OPENGL_HANDLEPOOL_H
+
+#include <core/logging/Logger.h>
+#include <core/resources/Handle.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Reference counted resources addressed by generational handles.
+//
+// Values are packed in one dense array (iteration and leak reports walk
+// only live entries); a handle's index names a slot that holds the dense
+// position, the generation and the reference count. Freeing a value
+// swap-removes it and bumps the slot's generation, so every handle still
+// pointing there stops resolving instead of reaching whatever reuses the
+// slot. Debug builds log each access through such a stale handle.
+//
+// The pool only tracks lifetime: the owner destroys the GL object when
+// release() hands the last reference's value back.
+template <typename T, typename Tag>
+class HandlePool {
+ public:
+  using HandleType = Handle<Tag>;
+
+  // name labels the debug reports
+  explicit HandlePool(const char* name) : name_(name) {}
+
+  HandlePool(const HandlePool&) = delete;
+  HandlePool& operator=(const HandlePool&) = delete;
+
+  // Starts with one reference, owned by the caller
+  HandleType create(T value) {
+    uint32_t index;
+    if (!freeSlots_.empty()) {
+      index = freeSlots_.back();
+      freeSlots_.pop_back();
+    } else {
+      index = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+
+    Slot& slot = slots_[index];
+    slot.dense = static_cast<uint32_t>(values_.size());
+    slot.refCount = 1;
+    values_.push_back(std::move(value));
+    denseToSlot_.push_back(index);
+    return {index, slot.generation};
+  }
+
+  // Silent check, for handles that may legitimately have gone away
+  bool isValid(HandleType handle) const {
+    return handle.isValid() && handle.index < slots_.size() &&
+           slots_[handle.index].generation == handle.generation;
+  }
+
+  // nullptr for a released or default handle
+  T* get(HandleType handle) {
+    return check(handle, "get") ? &values_[slots_[handle.index].dense]
+                                : nullptr;
+  }
+  const T* get(HandleType handle) const {
+    return check(handle, "get") ? &values_[slots_[handle.index].dense]
+                                : nullptr;
+  }
+
+  void retain(HandleType handle) {
+    if (check(handle, "retain")) {
+      ++slots_[handle.index].refCount;
+    }
+  }
+
+  // Drops one reference. Returns the value once the last one is gone, the
+  // handle (and every copy of it) is stale from then on.
+  std::optional<T> release(HandleType handle) {
+    if (!check(handle, "release") || --slots_[handle.index].refCount > 0) {
+      return std::nullopt;
+    }
+
+    Slot& slot = slots_[handle.index];
+    std::optional<T> value(std::move(values_[slot.dense]));
+
+    // Swap-remove keeps the values packed
+    const uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+    if (slot.dense != last) {
+      values_[slot.dense] = std::move(values_[last]);
+      denseToSlot_[slot.dense] = denseToSlot_[last];
+      slots_[denseToSlot_[last]].dense = slot.dense;
+    }
+    values_.pop_back();
+    denseToSlot_.pop_back();
+
+    retireSlot(handle.index);
+    return value;
+  }
+
+  uint32_t getRefCount(HandleType handle) const {
+    return isValid(handle) ? slots_[handle.index].refCount : 0;
+  }
+
+  // Live values in dense order; f(handle, value)
+  template <typename F>
+  void each(F&& f) const {
+    for (size_t i = 0; i < values_.size(); i++) {
+      const uint32_t index = denseToSlot_[i];
+      f(HandleType{index, slots_[index].generation}, values_[i]);
+    }
+  }
+  template <typename F>
+  void each(F&& f) {
+    for (size_t i = 0; i < values_.size(); i++) {
+      const uint32_t index = denseToSlot_[i];
+      f(HandleType{index, slots_[index].generation}, values_[i]);
+    }
+  }
+
+  // Drops every value regardless of its references; outstanding handles
+  // become stale
+  void clear() {
+    for (const uint32_t index : denseToSlot_) {
+      retireSlot(index);
+    }
+    values_.clear();
+    denseToSlot_.clear();
+  }
+
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+  // Accesses through stale handles so far (always 0 in release builds)
+  size_t getStaleAccessCount() const { return staleAccesses_; }
+
+ private:
+  struct Slot {
+    uint32_t generation = 1;
+    uint32_t dense = 0;
+    uint32_t refCount = 0;
+  };
+
+  const char* name_;
+  std::vector<T> values_;
+  std::vector<uint32_t> denseToSlot_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> freeSlots_;
+  mutable size_t staleAccesses_ = 0;
+
+  bool check(HandleType handle, const char* operation) const {
+    if (isValid(handle)) {
+      return true;
+    }
+#ifndef NDEBUG
+    // A default handle is just "no resource"; a handle with a generation
+    // was real once, so reaching here means its resource was freed
+    if (handle.isValid()) {
+      ++staleAccesses_;
+      LOG_ERROR("%s pool: %s through a released handle (index %u, "
+                "generation %u)",
+                name_, operation, handle.index, handle.generation);
+    }
+#else
+    (void)operation;
+#endif
+    return false;
+  }
+
+  void retireSlot(uint32_t index) {
+    Slot& slot = slots_[index];
+    slot.refCount = 0;
+    // Generation 0 marks the invalid handle, skip it on wrap-around
+    if (++slot.generation == 0) {
+      slot.generation = 1;
+    }
+    freeSlots_.push_back(index);
+  }
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_HANDLEPOOL_H
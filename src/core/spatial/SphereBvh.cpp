@@ -0,0 +1,487 @@
+#include "SphereBvh.h"
+
+#include <core/threading/Latch.h>
+#include <core/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOLAR_SPHERE_BVH_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Pairs (L(m), L(m + 1)) of leaf counts, where halving m leaves floor(m/2)
+// and ceil(m/2): L(2j) = 2L(j) and L(2j + 1) = L(j) + L(j + 1)
+std::pair<uint32_t, uint32_t> leafCountPair(uint32_t m) {
+  if (m <= 7) {
+    const auto small = [](uint32_t count) -> uint32_t {
+      return count == 0 ? 0 : count <= 4 ? 1 : 2;
+    };
+    return {small(m), small(m + 1)};
+  }
+  const auto [lj, lj1] = leafCountPair(m / 2);
+  return m % 2 == 0 ? std::make_pair(2 * lj, lj + lj1)
+                    : std::make_pair(lj + lj1, 2 * lj1);
+}
+
+// Slab test against the node box; the entry distance, or infinity on a
+// miss
+float enterBox(const glm::vec3& min, const glm::vec3& max,
+               const glm::vec3& origin, const glm::vec3& inverseDirection,
+               float maxDistance) {
+  const glm::vec3 t0 = (min - origin) * inverseDirection;
+  const glm::vec3 t1 = (max - origin) * inverseDirection;
+  const glm::vec3 near = glm::min(t0, t1);
+  const glm::vec3 far = glm::max(t0, t1);
+  const float enter =
+      std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+  const float exit =
+      std::min(std::min(far.x, far.y), std::min(far.z, maxDistance));
+  return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+}  // namespace
+
+uint32_t SphereBvh::leafCount(uint32_t count) {
+  return leafCountPair(count).first;
+}
+
+void SphereBvh::build(const glm::vec4* spheres, size_t count,
+                      ThreadPool* pool) {
+  clear();
+  if (count == 0) {
+    return;
+  }
+
+  const uint32_t n = static_cast<uint32_t>(count);
+  sphereCount_ = count;
+  order_.resize(n);
+  for (uint32_t i = 0; i < n; i++) {
+    order_[i] = i;
+  }
+  nodes_.resize(nodeCount(n));
+  blocks_.resize(leafCount(n));
+
+  // Enough subtrees to keep every worker busy while they vary in cost
+  uint32_t splitDepth = 0;
+  if (pool != nullptr) {
+    while ((1u << splitDepth) < pool->getThreadCount() * 4 &&
+           splitDepth < 16) {
+      splitDepth++;
+    }
+  }
+  splitTop(0, 0, 0, n, 0, splitDepth, spheres);
+
+  const float area = runSubtrees(spheres, pool, true) + refitTop();
+  const float rootArea = surfaceArea(nodes_[0]);
+  builtCost_ = rootArea > 0.0f ? area / rootArea : 0.0f;
+  cost_ = builtCost_;
+}
+
+void SphereBvh::refit(const glm::vec4* spheres, size_t count,
+                      ThreadPool* pool) {
+  if (count != sphereCount_) {
+    build(spheres, count, pool);
+    return;
+  }
+  if (nodes_.empty()) {
+    return;
+  }
+
+  const float area = runSubtrees(spheres, pool, false) + refitTop();
+  const float rootArea = surfaceArea(nodes_[0]);
+  cost_ = rootArea > 0.0f ? area / rootArea : 0.0f;
+}
+
+void SphereBvh::clear() {
+  nodes_.clear();
+  blocks_.clear();
+  order_.clear();
+  topNodes_.clear();
+  subtrees_.clear();
+  sphereCount_ = 0;
+  builtCost_ = 0.0f;
+  cost_ = 0.0f;
+}
+
+bool SphereBvh::isDegraded() const {
+  return cost_ > builtCost_ * REBUILD_RATIO;
+}
+
+size_t SphereBvh::getMemoryBytes() const {
+  return nodes_.capacity() * sizeof(Node) +
+         blocks_.capacity() * sizeof(Block) +
+         order_.capacity() * sizeof(uint32_t) +
+         topNodes_.capacity() * sizeof(uint32_t) +
+         subtrees_.capacity() * sizeof(Subtree);
+}
+
+void SphereBvh::splitTop(uint32_t node, uint32_t block, uint32_t begin,
+                         uint32_t end, uint32_t depth, uint32_t splitDepth,
+                         const glm::vec4* spheres) {
+  const uint32_t count = end - begin;
+  if (depth >= splitDepth || count <= LEAF_SIZE) {
+    subtrees_.push_back({node, node + nodeCount(count), block, begin, end});
+    return;
+  }
+
+  topNodes_.push_back(node);
+  const uint32_t mid = partition(begin, end, spheres);
+  const uint32_t right = node + 1 + nodeCount(mid - begin);
+  nodes_[node].link = right;
+  nodes_[node].count = 0;
+  splitTop(node + 1, block, begin, mid, depth + 1, splitDepth, spheres);
+  splitTop(right, block + leafCount(mid - begin), mid, end, depth + 1,
+           splitDepth, spheres);
+}
+
+void SphereBvh::buildNode(uint32_t node, uint32_t block, uint32_t begin,
+                          uint32_t end, const glm::vec4* spheres) {
+  Node& current = nodes_[node];
+  const uint32_t count = end - begin;
+  if (count <= LEAF_SIZE) {
+    current.link = block;
+    current.count = count;
+    for (uint32_t i = 0; i < count; i++) {
+      blocks_[block].sphere[i] = order_[begin + i];
+    }
+    fillLeaf(current, spheres);
+    return;
+  }
+
+  const uint32_t mid = partition(begin, end, spheres);
+  const uint32_t right = node + 1 + nodeCount(mid - begin);
+  current.link = right;
+  current.count = 0;
+  buildNode(node + 1, block, begin, mid, spheres);
+  buildNode(right, block + leafCount(mid - begin), mid, end, spheres);
+  fitChildren(current, nodes_[node + 1], nodes_[right]);
+}
+
+uint32_t SphereBvh::partition(uint32_t begin, uint32_t end,
+                              const glm::vec4* spheres) {
+  glm::vec3 min(std::numeric_limits<float>::max());
+  glm::vec3 max(-std::numeric_limits<float>::max());
+  for (uint32_t i = begin; i < end; i++) {
+    const glm::vec3 center(spheres[order_[i]]);
+    min = glm::min(min, center);
+    max = glm::max(max, center);
+  }
+
+  const glm::vec3 extent = max - min;
+  const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0
+                   : extent.y >= extent.z                       ? 1
+                                                                : 2;
+  // Halving by count rather than space keeps the layout predictable:
+  // every subtree's node and block ranges follow from its size alone
+  const uint32_t mid = begin + (end - begin) / 2;
+  std::nth_element(order_.begin() + begin, order_.begin() + mid,
+                   order_.begin() + end,
+                   [spheres, axis](uint32_t a, uint32_t b) {
+                     return spheres[a][axis] < spheres[b][axis];
+                   });
+  return mid;
+}
+
+float SphereBvh::refitSubtree(const Subtree& subtree,
+                              const glm::vec4* spheres, bool build) {
+  if (build) {
+    buildNode(subtree.node, subtree.block, subtree.begin, subtree.end,
+              spheres);
+  }
+
+  // Children come after their parent, so a reverse walk sees them first
+  float area = 0.0f;
+  for (uint32_t i = subtree.nodeEnd; i-- > subtree.node;) {
+    Node& node = nodes_[i];
+    if (!build) {
+      if (isLeaf(node)) {
+        fillLeaf(node, spheres);
+      } else {
+        fitChildren(node, nodes_[i + 1], nodes_[node.link]);
+      }
+    }
+    area += surfaceArea(node);
+  }
+  return area;
+}
+
+float SphereBvh::runSubtrees(const glm::vec4* spheres, ThreadPool* pool,
+                             bool build) {
+  std::vector<float> areas(subtrees_.size(), 0.0f);
+  if (pool == nullptr || subtrees_.size() == 1) {
+    for (size_t i = 0; i < subtrees_.size(); i++) {
+      areas[i] = refitSubtree(subtrees_[i], spheres, build);
+    }
+  } else {
+    // The calling thread takes the first subtree instead of idling
+    Latch latch(subtrees_.size() - 1);
+    for (size_t i = 1; i < subtrees_.size(); i++) {
+      pool->submit([this, &areas, &latch, spheres, build, i] {
+        areas[i] = refitSubtree(subtrees_[i], spheres, build);
+        latch.countDown();
+      });
+    }
+    areas[0] = refitSubtree(subtrees_[0], spheres, build);
+    latch.wait();
+  }
+
+  float area = 0.0f;
+  for (const float subtreeArea : areas) {
+    area += subtreeArea;
+  }
+  return area;
+}
+
+float SphereBvh::refitTop() {
+  float area = 0.0f;
+  for (auto it = topNodes_.rbegin(); it != topNodes_.rend(); ++it) {
+    Node& node = nodes_[*it];
+    fitChildren(node, nodes_[*it + 1], nodes_[node.link]);
+    area += surfaceArea(node);
+  }
+  return area;
+}
+
+float SphereBvh::surfaceArea(const Node& node) {
+  const glm::vec3 extent = node.max - node.min;
+  return 2.0f *
+         (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+void SphereBvh::fitChildren(Node& node, const Node& left, const Node& right) {
+  node.min = glm::min(left.min, right.min);
+  node.max = glm::max(left.max, right.max);
+}
+
+void SphereBvh::fillLeaf(Node& node, const glm::vec4* spheres) {
+  Block& block = blocks_[node.link];
+  node.min = glm::vec3(std::numeric_limits<float>::max());
+  node.max = glm::vec3(-std::numeric_limits<float>::max());
+  for (uint32_t i = 0; i < LEAF_SIZE; i++) {
+    if (i >= node.count) {
+      // Padding lanes are masked out, keep them finite all the same
+      block.x[i] = block.y[i] = block.z[i] = block.r[i] = 0.0f;
+      block.sphere[i] = 0;
+      continue;
+    }
+    const glm::vec4& sphere = spheres[block.sphere[i]];
+    block.x[i] = sphere.x;
+    block.y[i] = sphere.y;
+    block.z[i] = sphere.z;
+    block.r[i] = sphere.w;
+    node.min = glm::min(node.min, glm::vec3(sphere) - sphere.w);
+    node.max = glm::max(node.max, glm::vec3(sphere) + sphere.w);
+  }
+}
+
+bool SphereBvh::raycast(const glm::vec3& origin, const glm::vec3& direction,
+                        float maxDistance, RayHit& hit) const {
+  const float a = glm::dot(direction, direction);
+  if (nodes_.empty() || a <= 0.0f) {
+    return false;
+  }
+
+  // Axis-parallel rays get a huge finite inverse rather than infinity, so
+  // an origin on a slab plane cannot produce 0 * inf
+  glm::vec3 inverseDirection;
+  for (int i = 0; i < 3; i++) {
+    inverseDirection[i] =
+        std::fabs(direction[i]) > 1e-20f
+            ? 1.0f / direction[i]
+            : std::copysign(1e30f, direction[i]);
+  }
+
+  float best = maxDistance;
+  bool found = false;
+
+#ifdef SOLAR_SPHERE_BVH_SSE
+  const __m128 ox = _mm_set1_ps(origin.x);
+  const __m128 oy = _mm_set1_ps(origin.y);
+  const __m128 oz = _mm_set1_ps(origin.z);
+  const __m128 dx = _mm_set1_ps(direction.x);
+  const __m128 dy = _mm_set1_ps(direction.y);
+  const __m128 dz = _mm_set1_ps(direction.z);
+  const __m128 va = _mm_set1_ps(a);
+  const __m128 inverseA = _mm_set1_ps(1.0f / a);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128i lanes = _mm_set_epi32(3, 2, 1, 0);
+#endif
+
+  uint32_t stack[64];
+  uint32_t top = 0;
+  if (enterBox(nodes_[0].min, nodes_[0].max, origin, inverseDirection,
+               best) == std::numeric_limits<float>::infinity()) {
+    return false;
+  }
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const uint32_t index = stack[--top];
+    const Node& node = nodes_[index];
+
+    if (!isLeaf(node)) {
+      // Nearer child last so it is visited first and shrinks best early
+      uint32_t nearChild = index + 1;
+      uint32_t farChild = node.link;
+      float nearEnter = enterBox(nodes_[nearChild].min, nodes_[nearChild].max,
+                                 origin, inverseDirection, best);
+      float farEnter = enterBox(nodes_[farChild].min, nodes_[farChild].max,
+                                origin, inverseDirection, best);
+      if (farEnter < nearEnter) {
+        std::swap(nearChild, farChild);
+        std::swap(nearEnter, farEnter);
+      }
+      const float miss = std::numeric_limits<float>::infinity();
+      if (farEnter != miss) {
+        stack[top++] = farChild;
+      }
+      if (nearEnter != miss) {
+        stack[top++] = nearChild;
+      }
+      continue;
+    }
+
+    // Popped nodes were entered before best last shrank; recheck
+    if (enterBox(node.min, node.max, origin, inverseDirection, best) ==
+        std::numeric_limits<float>::infinity()) {
+      continue;
+    }
+
+    const Block& block = blocks_[node.link];
+#ifdef SOLAR_SPHERE_BVH_SSE
+    // Solves |o + td - c| = r for four spheres at once:
+    // t = (-b -+ sqrt(b^2 - ac)) / a, b = (o - c).d, c = |o - c|^2 - r^2
+    const __m128 cx = _mm_sub_ps(ox, _mm_load_ps(block.x));
+    const __m128 cy = _mm_sub_ps(oy, _mm_load_ps(block.y));
+    const __m128 cz = _mm_sub_ps(oz, _mm_load_ps(block.z));
+    const __m128 r = _mm_load_ps(block.r);
+
+    const __m128 b = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(cx, dx), _mm_mul_ps(cy, dy)),
+        _mm_mul_ps(cz, dz));
+    const __m128 c = _mm_sub_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)),
+                   _mm_mul_ps(cz, cz)),
+        _mm_mul_ps(r, r));
+    const __m128 discriminant =
+        _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(va, c));
+    const __m128 root = _mm_sqrt_ps(_mm_max_ps(discriminant, zero));
+
+    const __m128 negativeB = _mm_sub_ps(zero, b);
+    const __m128 enter = _mm_mul_ps(_mm_sub_ps(negativeB, root), inverseA);
+    const __m128 exit = _mm_mul_ps(_mm_add_ps(negativeB, root), inverseA);
+    // Entry point, or the exit one when the origin is inside the sphere
+    const __m128 inFront = _mm_cmpge_ps(enter, zero);
+    const __m128 t = _mm_or_ps(_mm_and_ps(inFront, enter),
+                               _mm_andnot_ps(inFront, exit));
+
+    const __m128 used = _mm_castsi128_ps(
+        _mm_cmplt_epi32(lanes, _mm_set1_epi32(static_cast<int>(node.count))));
+    const __m128 hits = _mm_and_ps(
+        _mm_and_ps(used, _mm_cmpge_ps(discriminant, zero)),
+        _mm_and_ps(_mm_cmpge_ps(t, zero),
+                   _mm_cmplt_ps(t, _mm_set1_ps(best))));
+
+    const int mask = _mm_movemask_ps(hits);
+    if (mask != 0) {
+      alignas(16) float distances[LEAF_SIZE];
+      _mm_store_ps(distances, t);
+      for (uint32_t lane = 0; lane < LEAF_SIZE; lane++) {
+        if ((mask & (1 << lane)) != 0 && distances[lane] < best) {
+          best = distances[lane];
+          hit = {block.sphere[lane], best};
+          found = true;
+        }
+      }
+    }
+#else
+    for (uint32_t lane = 0; lane < node.count; lane++) {
+      const glm::vec3 offset =
+          origin - glm::vec3(block.x[lane], block.y[lane], block.z[lane]);
+      const float b = glm::dot(offset, direction);
+      const float c =
+          glm::dot(offset, offset) - block.r[lane] * block.r[lane];
+      const float discriminant = b * b - a * c;
+      if (discriminant < 0.0f) {
+        continue;
+      }
+      const float root = std::sqrt(discriminant);
+      float t = (-b - root) / a;
+      if (t < 0.0f) {
+        t = (-b + root) / a;
+      }
+      if (t >= 0.0f && t < best) {
+        best = t;
+        hit = {block.sphere[lane], best};
+        found = true;
+      }
+    }
+#endif
+  }
+  return found;
+}
+
+void SphereBvh::queryNearest(const glm::vec3& point, size_t k,
+                             std::vector<Neighbor>& out) const {
+  out.clear();
+  if (nodes_.empty() || k == 0) {
+    return;
+  }
+
+  const auto boxDistance = [&point](const Node& node) {
+    const glm::vec3 delta =
+        glm::max(node.min - point, glm::max(point - node.max, 0.0f));
+    return glm::length(delta);
+  };
+  const auto closer = [](const Neighbor& a, const Neighbor& b) {
+    return a.distance < b.distance;
+  };
+
+  // Nodes nearest first; out is kept as a max-heap of the best k so far
+  using Entry = std::pair<float, uint32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  queue.push({boxDistance(nodes_[0]), 0});
+
+  while (!queue.empty()) {
+    const auto [distance, index] = queue.top();
+    queue.pop();
+    // A sphere is no nearer than the box around it, so nothing left can
+    // beat a full result
+    if (out.size() == k && distance >= out.front().distance) {
+      break;
+    }
+
+    const Node& node = nodes_[index];
+    if (!isLeaf(node)) {
+      queue.push({boxDistance(nodes_[index + 1]), index + 1});
+      queue.push({boxDistance(nodes_[node.link]), node.link});
+      continue;
+    }
+
+    const Block& block = blocks_[node.link];
+    for (uint32_t lane = 0; lane < node.count; lane++) {
+      const glm::vec3 center(block.x[lane], block.y[lane], block.z[lane]);
+      const Neighbor neighbor{
+          block.sphere[lane],
+          std::max(glm::length(point - center) - block.r[lane], 0.0f)};
+      if (out.size() < k) {
+        out.push_back(neighbor);
+        std::push_heap(out.begin(), out.end(), closer);
+      } else if (neighbor.distance < out.front().distance) {
+        std::pop_heap(out.begin(), out.end(), closer);
+        out.back() = neighbor;
+        std::push_heap(out.begin(), out.end(), closer);
+      }
+    }
+  }
+  std::sort_heap(out.begin(), out.end(), closer);
+}
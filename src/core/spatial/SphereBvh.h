@@ -0,0 +1,246 @@
+#ifndef SOLAR_SYSTEM_OPENGL_SPHEREBVH_H
+#define SOLAR_SYSTEM_OPENGL_SPHEREBVH_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Bounding volume hierarchy over spheres (xyz centre, w radius).
+//
+// Nodes are stored depth first: an interior node's left child follows it,
+// its right child index is stored. Each leaf owns one block of up to four
+// spheres in SoA layout, so the ray kernel tests a whole leaf with one
+// SSE pass. Queries report the sphere's index in the array given to
+// build().
+//
+// build() median-splits on the longest axis; subtree sizes are then known
+// up front, so the subtrees below the top levels build (and later refit)
+// on a ThreadPool in parallel. refit() keeps the topology and only moves
+// the bounds, which is enough while the spheres move coherently;
+// isDegraded() reports when the tree has loosened enough to rebuild.
+class SphereBvh {
+ public:
+  struct RayHit {
+    uint32_t sphere = 0;
+    float distance = 0.0f;  // in units of the ray direction's length
+  };
+
+  struct Neighbor {
+    uint32_t sphere;
+    float distance;  // to the sphere's surface, 0 inside it
+  };
+
+  // Inside is dot(xyz, p) + w >= 0
+  using Frustum = std::array<glm::vec4, 6>;
+
+  // pool may be null; small inputs build on the calling thread anyway
+  void build(const glm::vec4* spheres, size_t count,
+             ThreadPool* pool = nullptr);
+  // Same spheres in the same order, moved
+  void refit(const glm::vec4* spheres, size_t count,
+             ThreadPool* pool = nullptr);
+  void clear();
+
+  // Bounds have grown past REBUILD_RATIO times their size after build()
+  bool isDegraded() const;
+
+  // Nearest sphere whose surface the ray enters (or leaves, from inside)
+  // within maxDistance
+  bool raycast(const glm::vec3& origin, const glm::vec3& direction,
+               float maxDistance, RayHit& hit) const;
+  // f(sphere) for every sphere not fully outside a plane
+  template <typename F>
+  void queryFrustum(const Frustum& frustum, F&& f) const;
+  // f(sphere) for every sphere within radius of center
+  template <typename F>
+  void queryRadius(const glm::vec3& center, float radius, F&& f) const;
+  // Up to k spheres closest to point, nearest first
+  void queryNearest(const glm::vec3& point, size_t k,
+                    std::vector<Neighbor>& out) const;
+
+  size_t size() const { return sphereCount_; }
+  size_t getNodeCount() const { return nodes_.size(); }
+  size_t getMemoryBytes() const;
+
+ private:
+  static constexpr uint32_t LEAF_SIZE = 4;
+  static constexpr float REBUILD_RATIO = 1.5f;
+
+  struct Node {
+    glm::vec3 min;
+    uint32_t link;  // interior: right child, leaf: block index
+    glm::vec3 max;
+    uint32_t count;  // spheres in the leaf block, 0 for interior nodes
+  };
+
+  struct alignas(16) Block {
+    float x[LEAF_SIZE];
+    float y[LEAF_SIZE];
+    float z[LEAF_SIZE];
+    float r[LEAF_SIZE];
+    uint32_t sphere[LEAF_SIZE];
+  };
+
+  // A subtree built and refitted as one job
+  struct Subtree {
+    uint32_t node;
+    uint32_t nodeEnd;
+    uint32_t block;
+    uint32_t begin;  // range in order_
+    uint32_t end;
+  };
+
+  std::vector<Node> nodes_;
+  std::vector<Block> blocks_;
+  std::vector<uint32_t> order_;
+  // Nodes above the subtrees, parents before children
+  std::vector<uint32_t> topNodes_;
+  std::vector<Subtree> subtrees_;
+  size_t sphereCount_ = 0;
+  // Summed node surface area relative to the root's, at build() and now
+  float builtCost_ = 0.0f;
+  float cost_ = 0.0f;
+
+  static uint32_t leafCount(uint32_t count);
+  static uint32_t nodeCount(uint32_t count) {
+    return 2 * leafCount(count) - 1;
+  }
+
+  // Lays out the nodes above splitDepth and records the subtrees below
+  void splitTop(uint32_t node, uint32_t block, uint32_t begin, uint32_t end,
+                uint32_t depth, uint32_t splitDepth,
+                const glm::vec4* spheres);
+  void buildNode(uint32_t node, uint32_t block, uint32_t begin, uint32_t end,
+                 const glm::vec4* spheres);
+  uint32_t partition(uint32_t begin, uint32_t end,
+                     const glm::vec4* spheres);
+  // Returns the subtree's summed surface area
+  float refitSubtree(const Subtree& subtree, const glm::vec4* spheres,
+                     bool build);
+  float runSubtrees(const glm::vec4* spheres, ThreadPool* pool, bool build);
+  float refitTop();
+
+  static float surfaceArea(const Node& node);
+  static void fitChildren(Node& node, const Node& left, const Node& right);
+  void fillLeaf(Node& node, const glm::vec4* spheres);
+  bool isLeaf(const Node& node) const { return node.count > 0; }
+};
+
+template <typename F>
+void SphereBvh::queryFrustum(const Frustum& frustum, F&& f) const {
+  if (nodes_.empty()) {
+    return;
+  }
+
+  // Bit i set: the node still straddles plane i. Children of a node fully
+  // inside a plane skip it.
+  constexpr uint32_t ALL_PLANES = (1u << 6) - 1;
+  struct Entry {
+    uint32_t node;
+    uint32_t planes;
+  };
+  Entry stack[64];
+  uint32_t top = 0;
+  stack[top++] = {0, ALL_PLANES};
+
+  while (top > 0) {
+    const Entry entry = stack[--top];
+    const Node& node = nodes_[entry.node];
+
+    uint32_t planes = entry.planes;
+    bool outside = false;
+    for (uint32_t i = 0; i < 6 && planes != 0; i++) {
+      if ((planes & (1u << i)) == 0) {
+        continue;
+      }
+      const glm::vec4& plane = frustum[i];
+      // Box corners furthest along and against the plane normal
+      const glm::vec3 positive(plane.x >= 0.0f ? node.max.x : node.min.x,
+                               plane.y >= 0.0f ? node.max.y : node.min.y,
+                               plane.z >= 0.0f ? node.max.z : node.min.z);
+      const glm::vec3 negative(plane.x >= 0.0f ? node.min.x : node.max.x,
+                               plane.y >= 0.0f ? node.min.y : node.max.y,
+                               plane.z >= 0.0f ? node.min.z : node.max.z);
+      if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+        outside = true;
+        break;
+      }
+      if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f) {
+        planes &= ~(1u << i);
+      }
+    }
+    if (outside) {
+      continue;
+    }
+
+    if (!isLeaf(node)) {
+      stack[top++] = {node.link, planes};
+      stack[top++] = {entry.node + 1, planes};
+      continue;
+    }
+
+    const Block& block = blocks_[node.link];
+    for (uint32_t lane = 0; lane < node.count; lane++) {
+      bool visible = true;
+      for (uint32_t i = 0; i < 6 && visible; i++) {
+        if ((planes & (1u << i)) == 0) {
+          continue;
+        }
+        const glm::vec4& plane = frustum[i];
+        visible = plane.x * block.x[lane] + plane.y * block.y[lane] +
+                      plane.z * block.z[lane] + plane.w >=
+                  -block.r[lane];
+      }
+      if (visible) {
+        f(block.sphere[lane]);
+      }
+    }
+  }
+}
+
+template <typename F>
+void SphereBvh::queryRadius(const glm::vec3& center, float radius,
+                            F&& f) const {
+  if (nodes_.empty()) {
+    return;
+  }
+
+  const float radiusSquared = radius * radius;
+  uint32_t stack[64];
+  uint32_t top = 0;
+  stack[top++] = 0;
+
+  while (top > 0) {
+    const uint32_t index = stack[--top];
+    const Node& node = nodes_[index];
+    const glm::vec3 delta =
+        glm::max(node.min - center, glm::max(center - node.max, 0.0f));
+    if (glm::dot(delta, delta) > radiusSquared) {
+      continue;
+    }
+
+    if (!isLeaf(node)) {
+      stack[top++] = node.link;
+      stack[top++] = index + 1;
+      continue;
+    }
+
+    const Block& block = blocks_[node.link];
+    for (uint32_t lane = 0; lane < node.count; lane++) {
+      const float dx = block.x[lane] - center.x;
+      const float dy = block.y[lane] - center.y;
+      const float dz = block.z[lane] - center.z;
+      const float reach = radius + block.r[lane];
+      if (dx * dx + dy * dy + dz * dz <= reach * reach) {
+        f(block.sphere[lane]);
+      }
+    }
+  }
+}
+
+#endif  // SOLAR_SYSTEM_OPENGL_SPHEREBVH_H
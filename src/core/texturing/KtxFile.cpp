@@ -0,0 +1,177 @@
+#include "KtxFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+const unsigned char KTX_IDENTIFIER[12] = {0xAB, 'K',  'T',  'X', ' ',  '1',
+                                          '1',  0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t KTX_ENDIANNESS = 0x04030201;
+constexpr size_t KTX_HEADER_SIZE = 64;
+
+struct KtxHeader {
+  uint32_t endianness;
+  uint32_t glType;
+  uint32_t glTypeSize;
+  uint32_t glFormat;
+  uint32_t glInternalFormat;
+  uint32_t glBaseInternalFormat;
+  uint32_t pixelWidth;
+  uint32_t pixelHeight;
+  uint32_t pixelDepth;
+  uint32_t numberOfArrayElements;
+  uint32_t numberOfFaces;
+  uint32_t numberOfMipmapLevels;
+  uint32_t bytesOfKeyValueData;
+};
+static_assert(sizeof(KtxHeader) == KTX_HEADER_SIZE - sizeof(KTX_IDENTIFIER),
+              "KTX header must be tightly packed");
+
+size_t padTo4(size_t value) { return (value + 3) & ~static_cast<size_t>(3); }
+
+// Bytes per 4x4 block for the block-compressed formats we load, 0 otherwise
+size_t blockBytes(uint32_t glInternalFormat) {
+  switch (glInternalFormat) {
+    case KtxGL::COMPRESSED_RGB_S3TC_DXT1:
+      return 8;
+    case KtxGL::COMPRESSED_RGBA_S3TC_DXT5:
+      return 16;
+    default:
+      return 0;
+  }
+}
+}  // namespace
+
+bool KtxFile::parse(const unsigned char* data, size_t size, KtxTexture& out,
+                    std::string& error) {
+  if (size < KTX_HEADER_SIZE ||
+      std::memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0) {
+    error = "not a KTX 1.1 file";
+    return false;
+  }
+
+  KtxHeader header;
+  std::memcpy(&header, data + sizeof(KTX_IDENTIFIER), sizeof(header));
+  if (header.endianness != KTX_ENDIANNESS) {
+    error = "big-endian KTX files are not supported";
+    return false;
+  }
+  if (header.pixelDepth > 1 || header.numberOfArrayElements > 0) {
+    error = "only 2D textures and cubemaps are supported";
+    return false;
+  }
+  if (header.numberOfFaces != 1 && header.numberOfFaces != 6) {
+    error = "invalid face count";
+    return false;
+  }
+  if (header.pixelWidth == 0 || header.pixelHeight == 0) {
+    error = "zero texture dimensions";
+    return false;
+  }
+  if (header.numberOfMipmapLevels > 32) {
+    error = "invalid mip level count";
+    return false;
+  }
+  if (header.bytesOfKeyValueData > size - KTX_HEADER_SIZE) {
+    error = "truncated key/value data";
+    return false;
+  }
+
+  out = KtxTexture{};
+  out.glType = header.glType;
+  out.glFormat = header.glFormat;
+  out.glInternalFormat = header.glInternalFormat;
+  out.glBaseInternalFormat = header.glBaseInternalFormat;
+  out.width = header.pixelWidth;
+  out.height = header.pixelHeight;
+  out.faces = header.numberOfFaces;
+  // 0 means "generate the chain at load time", treat as a single level
+  out.levels = header.numberOfMipmapLevels == 0 ? 1 : header.numberOfMipmapLevels;
+  out.surfaces.reserve(static_cast<size_t>(out.levels) * out.faces);
+
+  size_t cursor = KTX_HEADER_SIZE + header.bytesOfKeyValueData;
+  for (uint32_t level = 0; level < out.levels; ++level) {
+    if (cursor + sizeof(uint32_t) > size) {
+      error = "truncated mip level header";
+      return false;
+    }
+    uint32_t imageSize;
+    std::memcpy(&imageSize, data + cursor, sizeof(imageSize));
+    cursor += sizeof(imageSize);
+
+    const uint32_t width = std::max(1u, out.width >> level);
+    const uint32_t height = std::max(1u, out.height >> level);
+    const size_t bytesPerBlock = blockBytes(out.glInternalFormat);
+    if (out.isCompressed() && bytesPerBlock != 0 &&
+        imageSize != static_cast<size_t>((width + 3) / 4) *
+                         ((height + 3) / 4) * bytesPerBlock) {
+      error = "mip level size does not match its block count";
+      return false;
+    }
+    for (uint32_t face = 0; face < out.faces; ++face) {
+      if (cursor > size || imageSize > size - cursor) {
+        error = "truncated mip level data";
+        return false;
+      }
+      out.surfaces.push_back({width, height, cursor, imageSize});
+      cursor = padTo4(cursor + imageSize);
+    }
+  }
+
+  return true;
+}
+
+bool KtxFile::write(
+    const std::string& path, const KtxTexture& texture,
+    const std::vector<std::vector<std::vector<unsigned char>>>& levelData,
+    std::string& error) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    error = "cannot open " + path + " for writing";
+    return false;
+  }
+
+  KtxHeader header{};
+  header.endianness = KTX_ENDIANNESS;
+  header.glType = texture.glType;
+  header.glTypeSize = 1;
+  header.glFormat = texture.glFormat;
+  header.glInternalFormat = texture.glInternalFormat;
+  header.glBaseInternalFormat = texture.glBaseInternalFormat;
+  header.pixelWidth = texture.width;
+  header.pixelHeight = texture.height;
+  header.pixelDepth = 0;
+  header.numberOfArrayElements = 0;
+  header.numberOfFaces = texture.faces;
+  header.numberOfMipmapLevels = static_cast<uint32_t>(levelData.size());
+  header.bytesOfKeyValueData = 0;
+
+  file.write(reinterpret_cast<const char*>(KTX_IDENTIFIER),
+             sizeof(KTX_IDENTIFIER));
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  const char padding[4] = {0, 0, 0, 0};
+  for (const auto& faces : levelData) {
+    if (faces.size() != texture.faces) {
+      error = "face count mismatch in level data";
+      return false;
+    }
+
+    // For non-array cubemaps imageSize is the size of a single face
+    const uint32_t imageSize = static_cast<uint32_t>(faces.front().size());
+    file.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+    for (const auto& face : faces) {
+      file.write(reinterpret_cast<const char*>(face.data()),
+                 static_cast<std::streamsize>(face.size()));
+      file.write(padding, static_cast<std::streamsize>(padTo4(face.size()) -
+                                                       face.size()));
+    }
+  }
+
+  if (!file) {
+    error = "write failed for " + path;
+    return false;
+  }
+  return true;
+}
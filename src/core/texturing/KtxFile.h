@@ -0,0 +1,65 @@
+#ifndef SOLAR_SYSTEM_OPENGL_KTXFILE_H
+#define SOLAR_SYSTEM_OPENGL_KTXFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GL enums used by baked textures. Spelled out here because glad only
+// exposes the 3.3 core profile and the baker does not link against GL.
+struct KtxGL {
+  static constexpr uint32_t UNSIGNED_BYTE = 0x1401;
+  static constexpr uint32_t RED = 0x1903;
+  static constexpr uint32_t RGB = 0x1907;
+  static constexpr uint32_t RGBA = 0x1908;
+  static constexpr uint32_t R8 = 0x8229;
+  static constexpr uint32_t RGB8 = 0x8051;
+  static constexpr uint32_t RGBA8 = 0x8058;
+  // EXT_texture_compression_s3tc
+  static constexpr uint32_t COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+  static constexpr uint32_t COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+};
+
+// One face of one mip level, located inside the file bytes
+struct KtxSurface {
+  uint32_t width;
+  uint32_t height;
+  size_t offset;
+  size_t size;
+};
+
+struct KtxTexture {
+  uint32_t glType = 0;
+  uint32_t glFormat = 0;
+  uint32_t glInternalFormat = 0;
+  uint32_t glBaseInternalFormat = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t faces = 1;
+  uint32_t levels = 1;
+  // levels * faces entries, level-major (level 0: face 0..5, level 1: ...)
+  std::vector<KtxSurface> surfaces;
+
+  bool isCompressed() const { return glType == 0; }
+  bool isCubemap() const { return faces == 6; }
+  const KtxSurface& surface(uint32_t level, uint32_t face = 0) const {
+    return surfaces[level * faces + face];
+  }
+};
+
+// Reader/writer for the KTX 1.1 container (2D textures and cubemaps only)
+class KtxFile {
+ public:
+  // Surfaces reference offsets into data; the caller keeps data alive
+  static bool parse(const unsigned char* data, size_t size, KtxTexture& out,
+                    std::string& error);
+
+  // levelData[level][face] holds the already encoded/padded bytes
+  static bool write(const std::string& path, const KtxTexture& header,
+                    const std::vector<std::vector<std::vector<unsigned char>>>&
+                        levelData,
+                    std::string& error);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_KTXFILE_H
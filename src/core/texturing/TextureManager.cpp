@@ -5,59 +5,248 @@
 #include "TextureManager.h"
 
 #include "stb_image/stb_image.h"
+#include <core/texturing/TextureStreamer.h>
+#include <core/logging/Logger.h>
+#include <core/memory/MemoryTracker.h>
+#include <core/resources/GpuDeletionQueue.h>
+#include <core/threading/ThreadPool.h>
 #include <utils/debug_utils.h>
 
-unsigned int TextureManager::createTexture(std::string path, GLenum target,
-                                                GLint wrapping,
-                                                GLint filtering) {
-  const unsigned int textureID = generateTexture(1, target);
+#include <AppConfig.h>
 
-  // examples: GL_REPEAT - wrapping, GL_LINEAR - filtering
-  GL_CHECK(setTextureWrappingParamsInt(wrapping));
-  GL_CHECK(setTextureFilteringParamsInt(filtering));
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <optional>
 
-  int width = 0, height = 0, numberOfChannels = 0;
-  unsigned char* data =
-      loadTextureImage(path.c_str(), width, height, numberOfChannels);
+namespace {
+// Transparent mid-grey: opaque shaders ignore alpha, blended ones (rings)
+// discard it, so the placeholder never shows as a solid quad
+unsigned char PLACEHOLDER_PIXEL[4] = {128, 128, 128, 0};
+}  // namespace
 
-  if (data && width > 0 && height > 0) {
-    std::cout << "Texture loaded: " << width << "x" << height << " ("
-         << numberOfChannels << " channels)" << std::endl;
+TextureManager::TextureManager()
+    : loaderPool_(std::make_unique<ThreadPool>(
+          AppConfig::TEXTURE_LOADER_THREADS)) {
+  if (AppConfig::TEXTURE_STREAMING) {
+    streamer_ = std::make_unique<TextureStreamer>(
+        *loaderPool_, AppConfig::TEXTURE_STREAMING_VRAM_BUDGET,
+        AppConfig::TEXTURE_STREAMING_MIN_RESIDENT_SIZE);
+  }
+}
 
-    GLenum format = GL_RGB;
-    if (numberOfChannels == 1)
-      format = GL_RED;
-    else if (numberOfChannels == 3)
-      format = GL_RGB;
-    else if (numberOfChannels == 4)
-      format = GL_RGBA;
+TextureManager::~TextureManager() {
+  // Stop the workers first so nothing is pushed while we free the queue
+  loaderPool_.reset();
 
-    GL_CHECK(specifyTextureImage2D(data, format, width, height, true));
-    stbi_image_free(data);
-  } else {
-    std::cout << "Failed to load texture: " << path << " - using fallback color"
-         << std::endl;
+  for (auto& image : decodedImages_) {
+    freeImage(image);
+  }
+  decodedImages_.clear();
 
-    GL_CHECK(specifyTextureImage2D(data, GL_RGB, 1, 1, false));
-    if (data) {
-      stbi_image_free(data);
+  for (auto& [textureID, faces] : pendingCubemapFaces_) {
+    for (auto& face : faces) {
+      freeImage(face);
     }
   }
+  pendingCubemapFaces_.clear();
+
+  // Reports its resident levels as released
+  streamer_.reset();
+
+  // Every owner releases its references, what is left here leaked
+  if (!textures_.empty()) {
+    std::cout << "TextureManager: Cleaning up " << textures_.size()
+              << " textures still referenced\n";
+    textures_.each([](TextureHandle, const TextureRecord& record) {
+      std::cout << "  - " << record.key << " (ID " << record.textureID
+                << ")\n";
+      glDeleteTextures(1, &record.textureID);
+      MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::GPU,
+                             record.trackedBytes);
+    });
+  } else {
+    std::cout << "TextureManager: All textures were properly released\n";
+  }
+  textures_.clear();
+  texturesByKey_.clear();
+
+  if (uploadPBO_ != 0) {
+    glDeleteBuffers(1, &uploadPBO_);
+    uploadPBO_ = 0;
+    MemoryTracker::release(MemoryCategory::StreamingBuffers, MemoryDomain::GPU,
+                           uploadPBOSize_);
+    uploadPBOSize_ = 0;
+  }
+}
+
+TextureHandle TextureManager::createTexture(std::string path, GLenum target,
+                                            GLint wrapping,
+                                            GLint filtering) {
+  const auto existing = texturesByKey_.find(path);
+  if (existing != texturesByKey_.end()) {
+    textures_.retain(existing->second);
+    return existing->second;
+  }
+
+  const TextureHandle texture = addTexture(target, path);
+  const unsigned int textureID = getGLTexture(texture);
+
+  // examples: GL_REPEAT - wrapping, GL_LINEAR - filtering
+  GL_CHECK(setTextureWrappingParamsInt(wrapping));
+  GL_CHECK(setTextureFilteringParamsInt(filtering));
+
+  GL_CHECK(specifyPlaceholder(GL_TEXTURE_2D));
+  setTrackedSize(texture, sizeof(PLACEHOLDER_PIXEL));
+
+  queryCompressionSupport();
+  queueDecode(texture, textureID, -1, path, false, true, true);
 
   // checkTextureBinding(GL_TEXTURE0);
-  return textureID;
+  return texture;
 }
 
-unsigned int TextureManager::createCubemap(std::vector<std::string> faces) {
+TextureHandle TextureManager::createCubemap(std::vector<std::string> faces,
+                                            const std::string& bakedPath) {
+  std::string key = bakedPath;
+  for (const auto& face : faces) {
+    key += "|" + face;
+  }
+  const auto existing = texturesByKey_.find(key);
+  if (existing != texturesByKey_.end()) {
+    textures_.retain(existing->second);
+    return existing->second;
+  }
+
   std::cout << "Creating cubemap with files:" << std::endl;
   for (const auto& face : faces) {
     std::cout << "  " << face << std::endl;
   }
 
-  unsigned int cubemapTexture = loadCubemap(faces);
-  std::cout << "Cubemap created with ID: " << cubemapTexture << std::endl;
+  const TextureHandle texture = addTexture(GL_TEXTURE_CUBE_MAP, key);
+  loadCubemap(texture, faces, bakedPath);
+  std::cout << "Cubemap created with ID: " << getGLTexture(texture)
+            << std::endl;
+
+  return texture;
+}
+
+void TextureManager::retainTexture(TextureHandle texture) {
+  textures_.retain(texture);
+}
+
+void TextureManager::releaseTexture(TextureHandle texture) {
+  if (std::optional<TextureRecord> record = textures_.release(texture)) {
+    destroyTexture(*record);
+  }
+}
+
+unsigned int TextureManager::getGLTexture(TextureHandle texture) const {
+  const TextureRecord* record = textures_.get(texture);
+  return record ? record->textureID : 0;
+}
+
+TextureHandle TextureManager::addTexture(GLenum target,
+                                         const std::string& key) {
+  const unsigned int textureID = generateTexture(1, target);
+  const TextureHandle texture =
+      textures_.create({textureID, target, key, 0});
+  texturesByKey_.emplace(key, texture);
+  return texture;
+}
+
+void TextureManager::destroyTexture(const TextureRecord& record) {
+  texturesByKey_.erase(record.key);
+  if (streamer_) {
+    // Reports its resident levels as released
+    streamer_->unregisterTexture(record.textureID);
+  }
+
+  // Faces already collected; later ones are dropped as they arrive since
+  // the handle is stale
+  const auto faces = pendingCubemapFaces_.find(record.textureID);
+  if (faces != pendingCubemapFaces_.end()) {
+    for (auto& face : faces->second) {
+      freeImage(face);
+    }
+    pendingCubemapFaces_.erase(faces);
+  }
 
-  return cubemapTexture;
+  GpuDeletionQueue::deleteTexture(record.textureID);
+  GpuDeletionQueue::releaseBytes(MemoryCategory::Textures,
+                                 record.trackedBytes);
+  LOG_DEBUG("Released texture: %s (ID=%u)", record.key.c_str(),
+            record.textureID);
+}
+
+void TextureManager::processPendingUploads(size_t byteBudget) {
+  size_t uploadedBytes = 0;
+  bool uploadedAny = false;
+
+  while (!uploadedAny || uploadedBytes < byteBudget) {
+    DecodedImage image;
+    {
+      std::lock_guard<std::mutex> lock(decodedMutex_);
+      if (decodedImages_.empty()) {
+        break;
+      }
+      image = std::move(decodedImages_.front());
+      decodedImages_.pop_front();
+    }
+
+    // Released while it was decoding
+    if (!textures_.isValid(image.texture)) {
+      freeImage(image);
+      image.file = FileView();
+      continue;
+    }
+
+    if (image.baked) {
+      uploadedBytes += uploadBakedTexture(image);
+      uploadedAny = true;
+      continue;
+    }
+
+    if (image.cubemapFace < 0) {
+      uploadedBytes += uploadTexture2D(image);
+      uploadedAny = true;
+      freeImage(image);
+      continue;
+    }
+
+    const unsigned int cubemapID = image.textureID;
+    auto& faces = pendingCubemapFaces_[cubemapID];
+    faces.push_back(std::move(image));
+    if (faces.size() == 6) {
+      uploadedBytes += uploadCubemap(faces);
+      uploadedAny = true;
+      pendingCubemapFaces_.erase(cubemapID);
+    }
+  }
+}
+
+bool TextureManager::hasPendingWork() const {
+  if (pendingDecodes_.load(std::memory_order_acquire) > 0) {
+    return true;
+  }
+  if (streamer_ && streamer_->hasPendingWork()) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(decodedMutex_);
+  return !decodedImages_.empty() || !pendingCubemapFaces_.empty();
+}
+
+void TextureManager::requestTextureResolution(TextureHandle texture,
+                                              float screenPixels) {
+  if (streamer_) {
+    streamer_->requestResolution(getGLTexture(texture), screenPixels);
+  }
+}
+
+void TextureManager::updateStreaming(size_t byteBudget) {
+  if (streamer_) {
+    streamer_->update(byteBudget);
+  }
 }
 
 unsigned int TextureManager::generateTexture(unsigned int count,
@@ -80,9 +269,14 @@ void TextureManager::setTextureFilteringParamsInt(GLint parameter) {
 unsigned char* TextureManager::loadTextureImage(const char* filename,
                                                 int& width, int& height,
                                                 int& numberOfChannels) {
-  stbi_set_flip_vertically_on_load(false);
-  unsigned char* data =
-      stbi_load(filename, &width, &height, &numberOfChannels, 0);
+  // Decoded straight from the pack mapping (or the loose file's bytes)
+  const FileView file = VirtualFileSystem::open(filename);
+  if (!file.isValid()) {
+    return nullptr;
+  }
+  unsigned char* data = stbi_load_from_memory(
+      file.data(), static_cast<int>(file.size()), &width, &height,
+      &numberOfChannels, 0);
   return data;
 }
 void TextureManager::specifyTextureImage2D(unsigned char* data,
@@ -96,53 +290,403 @@ void TextureManager::specifyTextureImage2D(unsigned char* data,
     glGenerateMipmap(GL_TEXTURE_2D);
   }
 }
-unsigned int TextureManager::loadCubemap(std::vector<std::string> faces) {
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+void TextureManager::loadCubemap(TextureHandle texture,
+                                 std::vector<std::string> faces,
+                                 const std::string& bakedPath) {
+  // Bound by addTexture
+  const unsigned int textureID = getGLTexture(texture);
+
+  // Set texture parameters
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+  specifyPlaceholder(GL_TEXTURE_CUBE_MAP);
+  setTrackedSize(texture, sizeof(PLACEHOLDER_PIXEL) * 6);
+
+  // The upload waits for all six faces, so a shorter list would stay
+  // pending forever; keep the placeholder instead
+  if (faces.size() != 6) {
+    std::cerr << "ERROR: Cubemap needs 6 faces, got " << faces.size()
+              << std::endl;
+    return;
+  }
+
+  if (!bakedPath.empty()) {
+    queryCompressionSupport();
+    queueBakedCubemap(texture, textureID, bakedPath, faces);
+  } else {
+    // All faces decode in parallel; the upload waits for the full set
+    for (unsigned int i = 0; i < 6; i++) {
+      queueDecode(texture, textureID, static_cast<int>(i), faces[i], true,
+                  false, false);
+    }
+  }
+
+  std::cout << "Cubemap texture created successfully with ID: " << textureID << std::endl;
+}
 
+void TextureManager::queueDecode(TextureHandle texture,
+                                 unsigned int textureID, int cubemapFace,
+                                 const std::string& path, bool flipVertically,
+                                 bool generateMipmap, bool preferBaked) {
+  pendingDecodes_.fetch_add(1, std::memory_order_relaxed);
 
-  stbi_set_flip_vertically_on_load(true);
+  loaderPool_->submit([this, texture, textureID, cubemapFace, path,
+                       flipVertically, generateMipmap, preferBaked] {
+    DecodedImage image;
+    image.texture = texture;
+    image.textureID = textureID;
+    image.cubemapFace = cubemapFace;
+    image.path = path;
+    image.generateMipmap = generateMipmap;
 
-  int width, height, nrChannels;
-  for (unsigned int i = 0; i < faces.size(); i++) {
-    unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
+    if (preferBaked && loadBakedTexture(bakedPathFor(path), image)) {
+      {
+        std::lock_guard<std::mutex> lock(decodedMutex_);
+        decodedImages_.push_back(std::move(image));
+      }
+      pendingDecodes_.fetch_sub(1, std::memory_order_release);
+      return;
+    }
+
+    // The global stbi flip flag is shared by every worker, use the
+    // thread-local override instead
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+    image.pixels = loadTextureImage(path.c_str(), image.width, image.height,
+                                    image.numberOfChannels);
+    if (image.pixels) {
+      MemoryTracker::allocate(MemoryCategory::Textures, MemoryDomain::CPU,
+                              static_cast<size_t>(image.width) * image.height *
+                                  image.numberOfChannels);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(decodedMutex_);
+      decodedImages_.push_back(std::move(image));
+    }
+    pendingDecodes_.fetch_sub(1, std::memory_order_release);
+  });
+}
+
+void TextureManager::queueBakedCubemap(TextureHandle texture,
+                                       unsigned int textureID,
+                                       const std::string& bakedPath,
+                                       std::vector<std::string> faces) {
+  pendingDecodes_.fetch_add(1, std::memory_order_relaxed);
+
+  loaderPool_->submit([this, texture, textureID, bakedPath,
+                       faces = std::move(faces)] {
+    DecodedImage image;
+    image.texture = texture;
+    image.textureID = textureID;
 
-    if (data) {
-      GLenum format;
-      if (nrChannels == 1)
-        format = GL_RED;
-      else if (nrChannels == 3)
-        format = GL_RGB;
-      else if (nrChannels == 4)
-        format = GL_RGBA;
-      else {
-        std::cout << "Unsupported number of channels (" << nrChannels << ") for cubemap face: " << faces[i] << std::endl;
-        format = GL_RGB; // fallback
+    if (loadBakedTexture(bakedPath, image) && image.ktx.isCubemap()) {
+      std::lock_guard<std::mutex> lock(decodedMutex_);
+      decodedImages_.push_back(std::move(image));
+    } else {
+      if (image.baked) {
+        LOG_WARNING("Baked texture %s is not a cubemap, decoding faces instead",
+                    bakedPath.c_str());
+      }
+      for (unsigned int i = 0; i < faces.size() && i < 6; i++) {
+        queueDecode(texture, textureID, static_cast<int>(i), faces[i], true,
+                    false, false);
       }
+    }
+    // Released after the fallback jobs are queued so the count never
+    // drops to zero in between
+    pendingDecodes_.fetch_sub(1, std::memory_order_release);
+  });
+}
+
+bool TextureManager::loadBakedTexture(const std::string& path,
+                                      DecodedImage& image) const {
+  if (!VirtualFileSystem::exists(path)) {
+    // Not baked, the caller falls back to the source image
+    return false;
+  }
+  image.file = VirtualFileSystem::open(path);
 
-      std::cout << "Loading cubemap face " << i << " (" << faces[i] << "): "
-                << width << "x" << height << " with " << nrChannels << " channels" << std::endl;
+  std::string error;
+  if (!image.file.isValid() ||
+      !KtxFile::parse(image.file.data(), image.file.size(), image.ktx,
+                      error)) {
+    LOG_WARNING("Ignoring baked texture %s: %s", path.c_str(), error.c_str());
+    image.file = FileView();
+    return false;
+  }
+
+  if (image.ktx.isCompressed() && !s3tcSupported_) {
+    LOG_INFO("S3TC not supported, ignoring baked texture %s", path.c_str());
+    image.file = FileView();
+    return false;
+  }
 
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height,
-                   0, format, GL_UNSIGNED_BYTE, data);
-      stbi_image_free(data);
+  image.baked = true;
+  image.path = path;
+  image.width = static_cast<int>(image.ktx.width);
+  image.height = static_cast<int>(image.ktx.height);
+  return true;
+}
+
+std::string TextureManager::bakedPathFor(const std::string& path) {
+  return std::filesystem::path(path).replace_extension(".ktx").string();
+}
+
+void TextureManager::queryCompressionSupport() {
+  if (compressionQueried_) {
+    return;
+  }
+  compressionQueried_ = true;
+
+  // S3TC is an extension in GL 3.3 core, glad only loads the core profile
+  GLint extensionCount = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+  for (GLint i = 0; i < extensionCount; i++) {
+    const char* extension = reinterpret_cast<const char*>(
+        glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+    if (extension &&
+        std::strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0) {
+      s3tcSupported_ = true;
+      break;
+    }
+  }
+
+  std::cout << "S3TC texture compression "
+            << (s3tcSupported_ ? "supported" : "not supported") << std::endl;
+}
+
+void TextureManager::specifyPlaceholder(GLenum target) {
+  if (target == GL_TEXTURE_CUBE_MAP) {
+    for (unsigned int i = 0; i < 6; i++) {
+      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, 1, 1, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXEL);
+    }
+    return;
+  }
+  specifyTextureImage2D(PLACEHOLDER_PIXEL, GL_RGBA, 1, 1, false);
+}
+
+size_t TextureManager::uploadTexture2D(const DecodedImage& image) {
+  if (!image.pixels || image.width <= 0 || image.height <= 0) {
+    LOG_ERROR("Failed to load texture: %s - keeping placeholder",
+              image.path.c_str());
+    return 0;
+  }
+
+  LOG_INFO("Texture loaded: %s %dx%d (%d channels)", image.path.c_str(),
+           image.width, image.height, image.numberOfChannels);
+
+  const GLenum format = formatFromChannels(image.numberOfChannels);
+  const size_t size = static_cast<size_t>(image.width) * image.height *
+                      image.numberOfChannels;
+
+  void* mapped = mapUploadBuffer(size);
+  if (!mapped) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return 0;
+  }
+  std::memcpy(mapped, image.pixels, size);
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+  // stb output rows are tightly packed
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glBindTexture(GL_TEXTURE_2D, image.textureID);
+  // With a PBO bound the data pointer is an offset into it
+  GL_CHECK(specifyTextureImage2D(nullptr, format, image.width, image.height,
+                                 image.generateMipmap));
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // A full mip chain adds a third on top of the base level
+  setTrackedSize(image.texture, image.generateMipmap ? size + size / 3 : size);
+  return size;
+}
+
+size_t TextureManager::uploadCubemap(std::vector<DecodedImage>& faces) {
+  const unsigned int textureID = faces.front().textureID;
+  const TextureHandle texture = faces.front().texture;
+
+  size_t totalSize = 0;
+  std::vector<size_t> offsets(faces.size(), 0);
+  for (size_t i = 0; i < faces.size(); i++) {
+    offsets[i] = totalSize;
+    if (faces[i].pixels) {
+      totalSize += static_cast<size_t>(faces[i].width) * faces[i].height *
+                   faces[i].numberOfChannels;
     } else {
-      std::cerr << "ERROR: Cubemap texture failed to load at path: " << faces[i] << std::endl;
-      stbi_image_free(data);
+      LOG_ERROR("Cubemap texture failed to load at path: %s",
+                faces[i].path.c_str());
     }
   }
 
-  // Set texture parameters
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+  void* mapped = totalSize > 0 ? mapUploadBuffer(totalSize) : nullptr;
+  if (mapped) {
+    for (size_t i = 0; i < faces.size(); i++) {
+      if (faces[i].pixels) {
+        std::memcpy(static_cast<unsigned char*>(mapped) + offsets[i],
+                    faces[i].pixels,
+                    static_cast<size_t>(faces[i].width) * faces[i].height *
+                        faces[i].numberOfChannels);
+      }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 
-  // Reset stbi flip setting for other textures
-  stbi_set_flip_vertically_on_load(false);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    for (size_t i = 0; i < faces.size(); i++) {
+      const auto& face = faces[i];
+      if (!face.pixels) {
+        continue;
+      }
 
-  std::cout << "Cubemap texture created successfully with ID: " << textureID << std::endl;
-  return textureID;
-}
\ No newline at end of file
+      const GLenum format = formatFromChannels(face.numberOfChannels);
+      LOG_DEBUG("Loading cubemap face %d (%s): %dx%d with %d channels",
+                face.cubemapFace, face.path.c_str(), face.width, face.height,
+                face.numberOfChannels);
+
+      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face.cubemapFace, 0,
+                   format, face.width, face.height, 0, format,
+                   GL_UNSIGNED_BYTE,
+                   reinterpret_cast<const void*>(offsets[i]));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    setTrackedSize(texture, totalSize);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  for (auto& face : faces) {
+    freeImage(face);
+  }
+  return totalSize;
+}
+
+size_t TextureManager::uploadBakedTexture(DecodedImage& image) {
+  const KtxTexture& ktx = image.ktx;
+
+  // Large 2D textures start with only their coarse tail resident
+  if (streamer_ && !ktx.isCubemap() && ktx.levels > 1 &&
+      std::max(ktx.width, ktx.height) >
+          AppConfig::TEXTURE_STREAMING_MIN_RESIDENT_SIZE) {
+    // The streamer reports its resident levels itself
+    setTrackedSize(image.texture, 0);
+    const size_t size = streamer_->registerTexture(
+        image.textureID, std::move(image.file), ktx, image.path);
+    LOG_INFO("Streaming texture: %s %ux%u (%u levels, %zu KB resident)",
+             image.path.c_str(), ktx.width, ktx.height, ktx.levels,
+             size / 1024);
+    return size;
+  }
+
+  // Level/face images are stored back to back, copy them in one go
+  const size_t dataStart = ktx.surfaces.front().offset;
+  const size_t dataSize =
+      ktx.surfaces.back().offset + ktx.surfaces.back().size - dataStart;
+
+  void* mapped = mapUploadBuffer(dataSize);
+  if (!mapped) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    image.file = FileView();
+    return 0;
+  }
+  std::memcpy(mapped, image.file.data() + dataStart, dataSize);
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+  const GLenum target = ktx.isCubemap() ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+  glBindTexture(target, image.textureID);
+
+  // KTX pads uncompressed rows to 4 bytes, which is the GL default
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  for (uint32_t level = 0; level < ktx.levels; level++) {
+    for (uint32_t face = 0; face < ktx.faces; face++) {
+      const KtxSurface& surface = ktx.surface(level, face);
+      const GLenum faceTarget =
+          ktx.isCubemap() ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face
+                          : GL_TEXTURE_2D;
+      const void* offset =
+          reinterpret_cast<const void*>(surface.offset - dataStart);
+
+      if (ktx.isCompressed()) {
+        GL_CHECK(glCompressedTexImage2D(
+            faceTarget, static_cast<GLint>(level), ktx.glInternalFormat,
+            surface.width, surface.height, 0,
+            static_cast<GLsizei>(surface.size), offset));
+      } else {
+        GL_CHECK(glTexImage2D(faceTarget, static_cast<GLint>(level),
+                              ktx.glInternalFormat, surface.width,
+                              surface.height, 0, ktx.glFormat, ktx.glType,
+                              offset));
+      }
+    }
+  }
+
+  // The chain is complete as baked, no glGenerateMipmap
+  glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,
+                  static_cast<GLint>(ktx.levels) - 1);
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glBindTexture(target, 0);
+
+  LOG_INFO("Baked texture loaded: %s %ux%u (%u levels%s)", image.path.c_str(),
+           ktx.width, ktx.height, ktx.levels,
+           ktx.isCubemap() ? ", cubemap" : "");
+
+  setTrackedSize(image.texture, dataSize);
+  image.file = FileView();
+  return dataSize;
+}
+
+void* TextureManager::mapUploadBuffer(size_t size) {
+  if (uploadPBO_ == 0) {
+    glGenBuffers(1, &uploadPBO_);
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPBO_);
+  // Orphan the previous storage so we never wait on an upload in flight
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  MemoryTracker::resize(MemoryCategory::StreamingBuffers, MemoryDomain::GPU,
+                        uploadPBOSize_, size);
+  uploadPBOSize_ = size;
+  void* mapped = glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, size,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!mapped) {
+    LOG_ERROR("Failed to map texture upload buffer (%zu bytes)", size);
+  }
+  return mapped;
+}
+
+GLenum TextureManager::formatFromChannels(int numberOfChannels) {
+  if (numberOfChannels == 1)
+    return GL_RED;
+  if (numberOfChannels == 4)
+    return GL_RGBA;
+  return GL_RGB;
+}
+
+void TextureManager::setTrackedSize(TextureHandle texture, size_t bytes) {
+  TextureRecord* record = textures_.get(texture);
+  if (!record) {
+    return;
+  }
+  MemoryTracker::resize(MemoryCategory::Textures, MemoryDomain::GPU,
+                        record->trackedBytes, bytes);
+  record->trackedBytes = bytes;
+}
+
+void TextureManager::freeImage(DecodedImage& image) {
+  if (image.pixels) {
+    MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::CPU,
+                           static_cast<size_t>(image.width) * image.height *
+                               image.numberOfChannels);
+    stbi_image_free(image.pixels);
+    image.pixels = nullptr;
+  }
+}
@@ -7,26 +7,143 @@
 
 #include "glad/glad.h"
 
+#include <core/filesystem/VirtualFileSystem.h>
+#include <core/resources/HandlePool.h>
+#include <core/texturing/KtxFile.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 
+class TextureStreamer;
+class ThreadPool;
 
 class TextureManager {
 public:
-  // Textures
-  unsigned int createTexture(std::string path, GLenum target,
-                                  GLint wrapping, GLint filtering);
-  unsigned int createCubemap(std::vector<std::string> faces);
+  TextureManager();
+  ~TextureManager();
+
+  TextureManager(const TextureManager&) = delete;
+  TextureManager& operator=(const TextureManager&) = delete;
+
+  // Textures. Both return immediately with a 1x1 placeholder bound; the real
+  // image is decoded on a worker thread and swapped in by processPendingUploads.
+  // A baked .ktx (see tools/asset_baker) is preferred over the source image:
+  // next to the file for 2D textures, at bakedPath for cubemaps.
+  // Each call returns one reference. A texture already loaded from the same
+  // source is shared instead of loaded again (its sampler settings win).
+  TextureHandle createTexture(std::string path, GLenum target,
+                              GLint wrapping, GLint filtering);
+  TextureHandle createCubemap(std::vector<std::string> faces,
+                              const std::string& bakedPath = "");
+
+  // The GL texture is deleted when its last reference is released
+  void retainTexture(TextureHandle texture);
+  void releaseTexture(TextureHandle texture);
+  // 0 for a released handle
+  unsigned int getGLTexture(TextureHandle texture) const;
+  size_t getTextureCount() const { return textures_.size(); }
+
+  // Must be called on the GL thread once per frame. Uploads decoded images
+  // through a PBO until byteBudget is spent (at least one image per call).
+  void processPendingUploads(size_t byteBudget);
+  bool hasPendingWork() const;
+
+  // Mip streaming for large baked 2D textures (see TextureStreamer).
+  // screenPixels is how many pixels the texture's width spans on screen.
+  void requestTextureResolution(TextureHandle texture, float screenPixels);
+  void updateStreaming(size_t byteBudget);
+  const TextureStreamer* getStreamer() const { return streamer_.get(); }
+
 private:
+  struct TextureRecord {
+    unsigned int textureID = 0;
+    GLenum target = GL_TEXTURE_2D;
+    std::string key;  // source path(s), for sharing
+    size_t trackedBytes = 0;  // GPU bytes reported to the MemoryTracker
+  };
+
+  struct DecodedImage {
+    // The handle tells whether the texture is still alive at upload time
+    TextureHandle texture;
+    unsigned int textureID = 0;
+    int cubemapFace = -1;  // -1 for GL_TEXTURE_2D
+    std::string path;
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int numberOfChannels = 0;
+    bool generateMipmap = false;
+
+    // Baked KTX: a view of the file plus the level/face table parsed from it
+    bool baked = false;
+    FileView file;
+    KtxTexture ktx;
+  };
+
   unsigned int generateTexture(unsigned int count, GLenum target);
+  TextureHandle addTexture(GLenum target, const std::string& key);
+  void destroyTexture(const TextureRecord& record);
   void setTextureWrappingParamsInt(GLint parameter);
   void setTextureFilteringParamsInt(GLint parameter);
   unsigned char* loadTextureImage(const char* filename, int& width, int& height, int& numberOfChannels);
   void specifyTextureImage2D(unsigned char* data, unsigned int format, unsigned int width, unsigned int height, bool generateMipmap);
 
-  unsigned int loadCubemap(std::vector<std::string> faces);
+  void loadCubemap(TextureHandle texture, std::vector<std::string> faces,
+                   const std::string& bakedPath);
+
+  // Async decoding
+  // Also called from workers, so the GL id is passed along with the handle
+  void queueDecode(TextureHandle texture, unsigned int textureID,
+                   int cubemapFace, const std::string& path,
+                   bool flipVertically, bool generateMipmap,
+                   bool preferBaked);
+  void queueBakedCubemap(TextureHandle texture, unsigned int textureID,
+                         const std::string& bakedPath,
+                         std::vector<std::string> faces);
+  bool loadBakedTexture(const std::string& path, DecodedImage& image) const;
+  static std::string bakedPathFor(const std::string& path);
+  void queryCompressionSupport();
+  void specifyPlaceholder(GLenum target);
+
+  // GL-thread uploads
+  size_t uploadTexture2D(const DecodedImage& image);
+  size_t uploadCubemap(std::vector<DecodedImage>& faces);
+  size_t uploadBakedTexture(DecodedImage& image);
+  void* mapUploadBuffer(size_t size);
+  static GLenum formatFromChannels(int numberOfChannels);
+  static void freeImage(DecodedImage& image);
+
+  // Memory accounting: GPU bytes currently reported for each texture
+  void setTrackedSize(TextureHandle texture, size_t bytes);
+
+  // GL thread only; workers get the handle and GL id by value
+  HandlePool<TextureRecord, TextureTag> textures_{"Texture"};
+  std::unordered_map<std::string, TextureHandle> texturesByKey_;
+
+  unsigned int uploadPBO_ = 0;
+  size_t uploadPBOSize_ = 0;
+
+  // Written on the GL thread before the first job is queued, read by workers
+  bool compressionQueried_ = false;
+  bool s3tcSupported_ = false;
+
+  mutable std::mutex decodedMutex_;
+  std::deque<DecodedImage> decodedImages_;
+  std::atomic<size_t> pendingDecodes_{0};
+
+  // Cubemap faces are held back until all six are decoded so the texture
+  // never becomes cube-incomplete mid-swap
+  std::unordered_map<unsigned int, std::vector<DecodedImage>> pendingCubemapFaces_;
 
+  std::unique_ptr<TextureStreamer> streamer_;
+  // Declared last so workers stop before anything they write to goes away
+  std::unique_ptr<ThreadPool> loaderPool_;
 };
 
 #endif  // SOLAR_SYSTEM_OPENGL_TEXTUREMANAGER_H
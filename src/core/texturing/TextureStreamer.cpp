@@ -0,0 +1,360 @@
+#include "TextureStreamer.h"
+
+#include <core/logging/Logger.h>
+#include <core/memory/MemoryTracker.h>
+#include <core/threading/ThreadPool.h>
+#include <utils/debug_utils.h>
+
+#include <algorithm>
+
+namespace {
+// Limits staging memory and keeps the loader pool free for new textures
+constexpr size_t MAX_LOADS_IN_FLIGHT = 4;
+// Frames without a request before a texture counts as off-screen
+constexpr uint64_t STALE_FRAMES = 30;
+}  // namespace
+
+TextureStreamer::TextureStreamer(ThreadPool& loaderPool, size_t vramBudget,
+                                 uint32_t minResidentSize)
+    : loaderPool_(loaderPool),
+      vramBudget_(vramBudget),
+      minResidentSize_(minResidentSize) {}
+
+TextureStreamer::~TextureStreamer() {
+  MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::GPU,
+                         residentBytes_);
+
+  std::lock_guard<std::mutex> lock(loadedMutex_);
+  for (const auto& loaded : loadedLevels_) {
+    MemoryTracker::release(MemoryCategory::StreamingBuffers, MemoryDomain::CPU,
+                           loaded.bytes.size());
+  }
+}
+
+size_t TextureStreamer::registerTexture(unsigned int textureID, FileView file,
+                                        const KtxTexture& ktx,
+                                        std::string path) {
+  StreamedTexture& texture = textures_[textureID];
+  texture.textureID = textureID;
+  texture.registration = ++registrations_;
+  texture.file = FileView();
+  texture.path = std::move(path);
+  texture.ktx = ktx;
+
+  // The coarse tail is small enough to always keep
+  uint32_t tailBase = ktx.levels - 1;
+  for (uint32_t level = 0; level < ktx.levels; level++) {
+    const KtxSurface& surface = ktx.surface(level);
+    if (std::max(surface.width, surface.height) <= minResidentSize_) {
+      tailBase = level;
+      break;
+    }
+  }
+  texture.minResidentBase = tailBase;
+  texture.finestReadable = 0;
+  texture.residentBase = tailBase;
+  texture.desiredBase = tailBase;
+  texture.lastRequestFrame = frameIndex_;
+
+  glBindTexture(GL_TEXTURE_2D, textureID);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  size_t uploadedBytes = 0;
+  for (uint32_t level = 0; level < ktx.levels; level++) {
+    if (level < tailBase) {
+      // Drop whatever an earlier upload left at the finer levels
+      specifyLevel(texture, level, nullptr, true);
+      continue;
+    }
+    const KtxSurface& surface = ktx.surface(level);
+    GL_CHECK(specifyLevel(texture, level, file.data() + surface.offset, false));
+    uploadedBytes += surface.size;
+  }
+  // A loose file's copy goes away here, finer levels are read from disk
+  if (file.isMapped()) {
+    texture.file = std::move(file);
+  }
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+                  static_cast<GLint>(tailBase));
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                  static_cast<GLint>(ktx.levels) - 1);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  residentBytes_ += uploadedBytes;
+  MemoryTracker::allocate(MemoryCategory::Textures, MemoryDomain::GPU,
+                          uploadedBytes);
+  return uploadedBytes;
+}
+
+bool TextureStreamer::isStreamed(unsigned int textureID) const {
+  return textures_.count(textureID) > 0;
+}
+
+void TextureStreamer::unregisterTexture(unsigned int textureID) {
+  const auto it = textures_.find(textureID);
+  if (it == textures_.end()) {
+    return;
+  }
+
+  const StreamedTexture& texture = it->second;
+  size_t bytes = 0;
+  for (uint32_t level = texture.residentBase; level < texture.ktx.levels;
+       level++) {
+    bytes += levelSize(texture, level);
+  }
+  if (texture.loading) {
+    // Reserved by queueLoad
+    bytes += levelSize(texture, texture.residentBase - 1);
+    // A worker may still be copying out of the mapped file
+    if (it->second.file.isValid()) {
+      retiredFiles_.push_back(std::move(it->second.file));
+    }
+  }
+  residentBytes_ -= bytes;
+  MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::GPU, bytes);
+  textures_.erase(it);
+}
+
+void TextureStreamer::requestResolution(unsigned int textureID,
+                                        float screenPixels) {
+  const auto it = textures_.find(textureID);
+  if (it == textures_.end()) {
+    return;
+  }
+
+  StreamedTexture& texture = it->second;
+  if (texture.lastRequestFrame != frameIndex_) {
+    texture.requestedPixels = screenPixels;
+    texture.lastRequestFrame = frameIndex_;
+  } else {
+    texture.requestedPixels = std::max(texture.requestedPixels, screenPixels);
+  }
+}
+
+void TextureStreamer::update(size_t byteBudget) {
+  uploadLoadedLevels(byteBudget);
+  if (!retiredFiles_.empty() &&
+      loadsInFlight_.load(std::memory_order_acquire) == 0) {
+    retiredFiles_.clear();
+  }
+
+  for (auto& [textureID, texture] : textures_) {
+    texture.desiredBase = computeDesiredBase(texture);
+  }
+  startLoads();
+
+  ++frameIndex_;
+}
+
+bool TextureStreamer::hasPendingWork() const {
+  if (loadsInFlight_.load(std::memory_order_acquire) > 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(loadedMutex_);
+  return !loadedLevels_.empty();
+}
+
+uint32_t TextureStreamer::computeDesiredBase(
+    const StreamedTexture& texture) const {
+  if (frameIndex_ - texture.lastRequestFrame > STALE_FRAMES) {
+    return texture.minResidentBase;
+  }
+
+  // Finest level still needed: stop once the next one would be smaller
+  // than what covers the requested pixels
+  uint32_t level = texture.finestReadable;
+  while (level < texture.minResidentBase &&
+         static_cast<float>(texture.ktx.surface(level + 1).width) >=
+             texture.requestedPixels) {
+    level++;
+  }
+  return level;
+}
+
+size_t TextureStreamer::levelSize(const StreamedTexture& texture,
+                                  uint32_t level) const {
+  return texture.ktx.surface(level).size;
+}
+
+size_t TextureStreamer::uploadLoadedLevels(size_t byteBudget) {
+  size_t uploadedBytes = 0;
+  bool uploadedAny = false;
+
+  while (!uploadedAny || uploadedBytes < byteBudget) {
+    LoadedLevel loaded;
+    {
+      std::lock_guard<std::mutex> lock(loadedMutex_);
+      if (loadedLevels_.empty()) {
+        break;
+      }
+      loaded = std::move(loadedLevels_.front());
+      loadedLevels_.pop_front();
+    }
+
+    // The texture was unregistered (its reservation went with it), maybe
+    // with its GL id already reused by a new registration
+    const auto it = textures_.find(loaded.textureID);
+    if (it == textures_.end() ||
+        it->second.registration != loaded.registration) {
+      MemoryTracker::release(MemoryCategory::StreamingBuffers,
+                             MemoryDomain::CPU, loaded.bytes.size());
+      continue;
+    }
+
+    StreamedTexture& texture = it->second;
+    texture.loading = false;
+    if (loaded.bytes.empty()) {
+      // The read failed; retrying would fail again every frame, so the
+      // texture stays at the levels it already has
+      texture.finestReadable = loaded.level + 1;
+      texture.desiredBase = texture.residentBase;
+      const size_t size = levelSize(texture, loaded.level);
+      residentBytes_ -= size;
+      MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::GPU, size);
+      continue;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture.textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GL_CHECK(specifyLevel(texture, loaded.level, loaded.bytes.data(), false));
+    // The new level is complete, let the sampler use it
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+                    static_cast<GLint>(loaded.level));
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    texture.residentBase = loaded.level;
+    uploadedBytes += loaded.bytes.size();
+    uploadedAny = true;
+    MemoryTracker::release(MemoryCategory::StreamingBuffers, MemoryDomain::CPU,
+                           loaded.bytes.size());
+  }
+  return uploadedBytes;
+}
+
+void TextureStreamer::startLoads() {
+  for (auto& [textureID, texture] : textures_) {
+    if (loadsInFlight_.load(std::memory_order_relaxed) >= MAX_LOADS_IN_FLIGHT) {
+      return;
+    }
+    if (texture.loading || texture.desiredBase >= texture.residentBase) {
+      continue;
+    }
+
+    // One level at a time, coarse to fine, so detail sharpens progressively
+    const uint32_t level = texture.residentBase - 1;
+    const size_t size = levelSize(texture, level);
+    if (!hasRoomFor(size) && !makeRoom(size, texture)) {
+      continue;
+    }
+    queueLoad(texture, level);
+  }
+}
+
+void TextureStreamer::queueLoad(StreamedTexture& texture, uint32_t level) {
+  texture.loading = true;
+  // Reserved up front so concurrent loads cannot overshoot the budget
+  residentBytes_ += levelSize(texture, level);
+  MemoryTracker::allocate(MemoryCategory::Textures, MemoryDomain::GPU,
+                          levelSize(texture, level));
+  loadsInFlight_.fetch_add(1, std::memory_order_relaxed);
+
+  const KtxSurface& surface = texture.ktx.surface(level);
+  const unsigned char* source =
+      texture.file.isValid() ? texture.file.data() + surface.offset : nullptr;
+  const size_t offset = surface.offset;
+  const size_t size = surface.size;
+  const unsigned int textureID = texture.textureID;
+  const uint64_t registration = texture.registration;
+
+  // Copying on the worker is where the mapped pages are actually read
+  loaderPool_.submit([this, textureID, registration, level, source, offset,
+                      size, path = texture.path] {
+    LoadedLevel loaded;
+    loaded.textureID = textureID;
+    loaded.registration = registration;
+    loaded.level = level;
+    if (source) {
+      loaded.bytes.assign(source, source + size);
+    } else if (!VirtualFileSystem::readRange(path, offset, size,
+                                             loaded.bytes)) {
+      // Delivered empty so the GL thread drops the reservation
+      LOG_ERROR("Failed to stream level %u of %s", level, path.c_str());
+      loaded.bytes.clear();
+    }
+    MemoryTracker::allocate(MemoryCategory::StreamingBuffers,
+                            MemoryDomain::CPU, loaded.bytes.size());
+
+    {
+      std::lock_guard<std::mutex> lock(loadedMutex_);
+      loadedLevels_.push_back(std::move(loaded));
+    }
+    loadsInFlight_.fetch_sub(1, std::memory_order_release);
+  });
+}
+
+bool TextureStreamer::makeRoom(size_t bytes,
+                               const StreamedTexture& requester) {
+  while (!hasRoomFor(bytes)) {
+    // Evict detail nobody needs, least recently requested first
+    StreamedTexture* victim = nullptr;
+    for (auto& [textureID, texture] : textures_) {
+      if (&texture == &requester || texture.loading ||
+          texture.residentBase >= texture.desiredBase) {
+        continue;
+      }
+      if (!victim || texture.lastRequestFrame < victim->lastRequestFrame) {
+        victim = &texture;
+      }
+    }
+
+    if (!victim) {
+      return false;
+    }
+    evictLevel(*victim);
+  }
+  return true;
+}
+
+void TextureStreamer::evictLevel(StreamedTexture& texture) {
+  const uint32_t level = texture.residentBase;
+
+  glBindTexture(GL_TEXTURE_2D, texture.textureID);
+  // Move the base first so the texture never samples a released level
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL,
+                  static_cast<GLint>(level + 1));
+  GL_CHECK(specifyLevel(texture, level, nullptr, true));
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  texture.residentBase = level + 1;
+  residentBytes_ -= levelSize(texture, level);
+  MemoryTracker::release(MemoryCategory::Textures, MemoryDomain::GPU,
+                         levelSize(texture, level));
+}
+
+bool TextureStreamer::hasRoomFor(size_t bytes) const {
+  // Both the streamer's own budget and the global texture budget apply
+  return residentBytes_ + bytes <= vramBudget_ &&
+         MemoryTracker::canAllocate(MemoryCategory::Textures,
+                                    MemoryDomain::GPU, bytes);
+}
+
+void TextureStreamer::specifyLevel(const StreamedTexture& texture,
+                                   uint32_t level, const void* data,
+                                   bool release) const {
+  const KtxTexture& ktx = texture.ktx;
+  const KtxSurface& surface = ktx.surface(level);
+  const GLsizei width = release ? 0 : static_cast<GLsizei>(surface.width);
+  const GLsizei height = release ? 0 : static_cast<GLsizei>(surface.height);
+
+  if (ktx.isCompressed()) {
+    glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level),
+                           ktx.glInternalFormat, width, height, 0,
+                           release ? 0 : static_cast<GLsizei>(surface.size),
+                           data);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level),
+                 static_cast<GLint>(ktx.glInternalFormat), width, height, 0,
+                 ktx.glFormat, ktx.glType, data);
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef SOLAR_SYSTEM_OPENGL_TEXTURESTREAMER_H
+#define SOLAR_SYSTEM_OPENGL_TEXTURESTREAMER_H
+
+#include "glad/glad.h"
+
+#include <core/filesystem/VirtualFileSystem.h>
+#include <core/texturing/KtxFile.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+// Keeps only the mip levels a texture needs on screen resident in VRAM.
+//
+// Baked textures are registered with their small tail levels uploaded; the
+// renderer reports each texture's on-screen size every frame and update()
+// streams finer levels in one step at a time (bytes staged on the loader
+// pool, uploaded on the GL thread) or drops them again when over budget.
+// Residency is expressed with GL_TEXTURE_BASE_LEVEL; evicted levels are
+// redefined as 0x0 so the driver releases their storage.
+class TextureStreamer {
+ public:
+  TextureStreamer(ThreadPool& loaderPool, size_t vramBudget,
+                  uint32_t minResidentSize);
+  ~TextureStreamer();
+
+  TextureStreamer(const TextureStreamer&) = delete;
+  TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+  // GL thread. Uploads the levels no larger than minResidentSize and
+  // streams the rest from the file: straight from the view when it maps
+  // the pack, otherwise re-read from path one level at a time so a loose
+  // file is not held in memory. Returns the uploaded bytes.
+  size_t registerTexture(unsigned int textureID, FileView file,
+                         const KtxTexture& ktx, std::string path);
+  bool isStreamed(unsigned int textureID) const;
+  // Forgets a texture that is about to be deleted. A level still loading
+  // for it is dropped when it arrives.
+  void unregisterTexture(unsigned int textureID);
+
+  // How many pixels the texture's width covers on screen this frame;
+  // the largest request per frame wins
+  void requestResolution(unsigned int textureID, float screenPixels);
+
+  // GL thread, once per frame: uploads finished loads within byteBudget,
+  // starts new ones and evicts under the VRAM budget
+  void update(size_t byteBudget);
+
+  bool hasPendingWork() const;
+  size_t getResidentBytes() const { return residentBytes_; }
+  size_t getBudget() const { return vramBudget_; }
+
+ private:
+  struct StreamedTexture {
+    unsigned int textureID = 0;
+    uint64_t registration = 0;  // tells reused GL ids apart
+    FileView file;     // only kept when mapped
+    std::string path;  // loose files are read from here on demand
+    KtxTexture ktx;
+    uint32_t residentBase = 0;   // finest level in VRAM
+    uint32_t desiredBase = 0;    // finest level the screen size asks for
+    uint32_t minResidentBase = 0;  // coarse tail that is never evicted
+    uint32_t finestReadable = 0;   // raised past a level that failed to read
+    bool loading = false;
+    float requestedPixels = 0.0f;
+    uint64_t lastRequestFrame = 0;
+  };
+
+  struct LoadedLevel {
+    unsigned int textureID = 0;
+    uint64_t registration = 0;
+    uint32_t level = 0;
+    std::vector<unsigned char> bytes;
+  };
+
+  ThreadPool& loaderPool_;
+  const size_t vramBudget_;
+  const uint32_t minResidentSize_;
+
+  std::unordered_map<unsigned int, StreamedTexture> textures_;
+  size_t residentBytes_ = 0;
+  uint64_t frameIndex_ = 0;
+  uint64_t registrations_ = 0;
+  // Files of unregistered textures with a load still reading them
+  std::vector<FileView> retiredFiles_;
+
+  mutable std::mutex loadedMutex_;
+  std::deque<LoadedLevel> loadedLevels_;
+  std::atomic<size_t> loadsInFlight_{0};
+
+  uint32_t computeDesiredBase(const StreamedTexture& texture) const;
+  size_t levelSize(const StreamedTexture& texture, uint32_t level) const;
+
+  size_t uploadLoadedLevels(size_t byteBudget);
+  void startLoads();
+  void queueLoad(StreamedTexture& texture, uint32_t level);
+  bool hasRoomFor(size_t bytes) const;
+  bool makeRoom(size_t bytes, const StreamedTexture& requester);
+  void evictLevel(StreamedTexture& texture);
+  void specifyLevel(const StreamedTexture& texture, uint32_t level,
+                    const void* data, bool release) const;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_TEXTURESTREAMER_H
@@ -0,0 +1,26 @@
+#include "CommandQueue.h"
+
+CommandQueue::CommandQueue(size_t reserve) {
+  pending_.reserve(reserve);
+  executing_.reserve(reserve);
+}
+
+void CommandQueue::push(Command command) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.push_back(std::move(command));
+}
+
+size_t CommandQueue::execute() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Both vectors keep their capacity, so steady state does not allocate
+    pending_.swap(executing_);
+  }
+
+  for (auto& command : executing_) {
+    command();
+  }
+  const size_t count = executing_.size();
+  executing_.clear();
+  return count;
+}
@@ -0,0 +1,33 @@
+#ifndef SOLAR_SYSTEM_OPENGL_COMMANDQUEUE_H
+#define SOLAR_SYSTEM_OPENGL_COMMANDQUEUE_H
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Ordered stream of work from any thread to one consumer thread, e.g. input
+// actions from the main thread to the render thread that owns the GL
+// context and the camera. Producers only hold the lock for a push_back; the
+// consumer swaps the whole batch out and runs it unlocked.
+class CommandQueue {
+ public:
+  using Command = std::function<void()>;
+
+  explicit CommandQueue(size_t reserve = 256);
+
+  CommandQueue(const CommandQueue&) = delete;
+  CommandQueue& operator=(const CommandQueue&) = delete;
+
+  void push(Command command);
+  // Consumer thread: runs every command pushed so far, in push order.
+  // Returns how many ran.
+  size_t execute();
+
+ private:
+  std::mutex mutex_;
+  std::vector<Command> pending_;
+  std::vector<Command> executing_;  // consumer only
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_COMMANDQUEUE_H
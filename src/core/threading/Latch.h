@@ -0,0 +1,35 @@
+#ifndef SOLAR_SYSTEM_OPENGL_LATCH_H
+#define SOLAR_SYSTEM_OPENGL_LATCH_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Lets one thread wait for a known number of ThreadPool jobs, rather than
+// for the whole pool to go idle as ThreadPool::waitIdle() does
+class Latch {
+ public:
+  explicit Latch(size_t count) : count_(count) {}
+
+  Latch(const Latch&) = delete;
+  Latch& operator=(const Latch&) = delete;
+
+  void countDown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--count_ == 0) {
+      done_.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return count_ == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable done_;
+  size_t count_;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_LATCH_H
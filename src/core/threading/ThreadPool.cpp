@@ -0,0 +1,82 @@
+#include "ThreadPool.h"
+
+#include <iostream>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  if (threadCount == 0) {
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+  }
+
+  workers_.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers_.emplace_back([this] { workerLoop(); });
+  }
+
+  std::cout << "Thread pool started with " << threadCount << " workers"
+            << std::endl;
+}
+
+ThreadPool::~ThreadPool() {
+  // Jobs not started yet are dropped, so shutting down only waits for the
+  // ones already running instead of every queued texture decode
+  std::deque<Job> dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    dropped.swap(jobs_);
+  }
+  jobAvailable_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void ThreadPool::submit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(std::move(job));
+  }
+  jobAvailable_.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return jobs_.empty() && activeJobs_ == 0; });
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+      if (stopping_) {
+        return;
+      }
+
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      ++activeJobs_;
+    }
+
+    try {
+      job();
+    } catch (const std::exception& e) {
+      std::cerr << "ThreadPool: job threw an exception: " << e.what()
+                << std::endl;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --activeJobs_;
+      if (jobs_.empty() && activeJobs_ == 0) {
+        idle_.notify_all();
+      }
+    }
+  }
+}
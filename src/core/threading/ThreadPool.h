@@ -0,0 +1,47 @@
+#ifndef SOLAR_SYSTEM_OPENGL_THREADPOOL_H
+#define SOLAR_SYSTEM_OPENGL_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for CPU work that must stay off the GL
+// thread (image decoding, mip generation). Jobs must not touch OpenGL.
+// Destroying the pool waits for the running jobs and drops the queued
+// ones, so nothing may wait on a job past the pool's lifetime.
+class ThreadPool {
+ public:
+  using Job = std::function<void()>;
+
+  // threadCount == 0 picks hardware_concurrency() - 1 (at least one worker)
+  explicit ThreadPool(size_t threadCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(Job job);
+  // Blocks until the queue is empty and no job is running
+  void waitIdle();
+
+  size_t getThreadCount() const { return workers_.size(); }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::deque<Job> jobs_;
+
+  std::mutex mutex_;
+  std::condition_variable jobAvailable_;
+  std::condition_variable idle_;
+
+  size_t activeJobs_ = 0;
+  bool stopping_ = false;
+
+  void workerLoop();
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_THREADPOOL_H
@@ -0,0 +1,56 @@
+#ifndef SOLAR_SYSTEM_OPENGL_TRIPLEBUFFER_H
+#define SOLAR_SYSTEM_OPENGL_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer handoff of the latest value.
+// The writer fills writeBuffer() and publish()es it; the reader calls
+// update() and then reads readBuffer(). Neither side ever waits: the writer
+// always has a free buffer, and the reader always sees a complete one
+// (intermediate values it was too slow to pick up are skipped).
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Writer side
+  T& writeBuffer() { return buffers_[writeIndex_]; }
+  void publish() {
+    writeIndex_ =
+        middle_.exchange(writeIndex_ | DIRTY, std::memory_order_acq_rel) &
+        INDEX_MASK;
+  }
+
+  // Reader side; true if a newer value was published since the last call
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & DIRTY) == 0) {
+      return false;
+    }
+    readIndex_ =
+        middle_.exchange(readIndex_, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+  const T& readBuffer() const { return buffers_[readIndex_]; }
+
+  // Only before the threads start, e.g. to size all three buffers
+  template <typename Function>
+  void forEach(Function&& function) {
+    for (T& buffer : buffers_) {
+      function(buffer);
+    }
+  }
+
+ private:
+  static constexpr uint8_t DIRTY = 0x4;
+  static constexpr uint8_t INDEX_MASK = 0x3;
+
+  T buffers_[3];
+  uint8_t writeIndex_ = 0;
+  uint8_t readIndex_ = 1;
+  std::atomic<uint8_t> middle_{2};
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_TRIPLEBUFFER_H
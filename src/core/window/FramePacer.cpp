@@ -0,0 +1,303 @@
+#include "FramePacer.h"
+
+#include <AppConfig.h>
+#include <core/logging/Logger.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace {
+constexpr double REPORT_INTERVAL_SECONDS = 10.0;
+
+double toSeconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+std::chrono::steady_clock::duration fromSeconds(double seconds) {
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+}
+
+VsyncMode vsyncModeFromInterval(int interval) {
+  if (interval < 0) return VsyncMode::Adaptive;
+  return interval == 0 ? VsyncMode::Off : VsyncMode::On;
+}
+}  // namespace
+
+FramePacer::FramePacer()
+    : vsyncMode_(vsyncModeFromInterval(AppConfig::SWAP_INTERVAL)),
+      targetFps_(AppConfig::TARGET_FPS),
+      lowLatency_(AppConfig::LOW_LATENCY_MODE) {
+  if (const char* value = std::getenv("SOLAR_TARGET_FPS")) {
+    targetFps_ = std::max(0.0, std::atof(value));
+  }
+  if (const char* value = std::getenv("SOLAR_VSYNC")) {
+    if (std::strcmp(value, "off") == 0) {
+      vsyncMode_ = VsyncMode::Off;
+    } else if (std::strcmp(value, "on") == 0) {
+      vsyncMode_ = VsyncMode::On;
+    } else if (std::strcmp(value, "adaptive") == 0) {
+      vsyncMode_ = VsyncMode::Adaptive;
+    } else {
+      std::cerr << "Unknown SOLAR_VSYNC '" << value
+                << "', expected off|on|adaptive" << std::endl;
+    }
+  }
+  if (const char* value = std::getenv("SOLAR_LOW_LATENCY")) {
+    lowLatency_ = std::atoi(value) != 0;
+  }
+
+#ifdef _WIN32
+  // The default scheduler tick is 15.6 ms, far too coarse to sleep in
+  timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+  timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::initialize(GLFWwindow* window) {
+  GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+  if (!monitor) {
+    monitor = glfwGetPrimaryMonitor();
+  }
+  const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+  if (mode && mode->refreshRate > 0) {
+    refreshRate_ = mode->refreshRate;
+  }
+
+  adaptiveSupported_ = glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                       glfwExtensionSupported("GLX_EXT_swap_control_tear");
+  initialized_ = true;
+  applySwapInterval();
+
+  std::cout << "Frame pacing: vsync " << getVsyncModeName(vsyncMode_)
+            << ", target " << targetFps_ << " FPS"
+            << (lowLatency_ ? ", low latency" : "") << " (display "
+            << refreshRate_ << " Hz)" << std::endl;
+}
+
+void FramePacer::waitForFrame() {
+  const double period = framePeriod();
+  if (period > 0.0 && hasPreviousFrame_) {
+    // Without vsync a frame is shown as soon as it is swapped, so the plain
+    // cap already samples input right before the present
+    if (lowLatency_ && vsyncMode_ != VsyncMode::Off) {
+      // Start just early enough for the frame to be ready at the next
+      // vblank; input sampled now is as fresh as it can be
+      waitUntil(lastPresent_ +
+                fromSeconds(period - workEstimate_ -
+                            AppConfig::LOW_LATENCY_SAFETY_MS / 1000.0));
+    } else {
+      waitUntil(nextFrameStart_);
+    }
+  }
+
+  frameStart_ = Clock::now();
+  // Keep the cadence after a slightly late frame, restart it after a hitch
+  // instead of rushing frames out to catch up
+  nextFrameStart_ =
+      std::max(nextFrameStart_ + fromSeconds(period), frameStart_);
+}
+
+void FramePacer::markSubmitted() {
+  const double work = toSeconds(Clock::now() - frameStart_);
+  // Rise at once, decay slowly: one cheap frame must not make the next
+  // start too late
+  workEstimate_ = work > workEstimate_
+                      ? work
+                      : workEstimate_ + (work - workEstimate_) * 0.05;
+}
+
+void FramePacer::endFrame() {
+  if (lowLatency_) {
+    // Stops the driver from queueing frames ahead, so the swap returns at
+    // the actual present and the next frame can be timed against it
+    glFinish();
+  }
+
+  const Clock::time_point now = Clock::now();
+  if (hasPreviousFrame_) {
+    frameTimes_[nextFrameTime_] = toSeconds(now - lastPresent_);
+    nextFrameTime_ = (nextFrameTime_ + 1) % HISTORY_SIZE;
+    frameTimeCount_ = std::min(frameTimeCount_ + 1, HISTORY_SIZE);
+    updateStats();
+  } else {
+    lastReport_ = now;
+  }
+  lastPresent_ = now;
+  hasPreviousFrame_ = true;
+
+  if (pendingInput_ != Clock::time_point::max()) {
+    updateInputLatency(toSeconds(now - pendingInput_));
+    pendingInput_ = Clock::time_point::max();
+  }
+
+  if (toSeconds(now - lastReport_) >= REPORT_INTERVAL_SECONDS) {
+    lastReport_ = now;
+    LOG_INFO("Frame pacing: %.2f ms avg, %.3f ms deviation, %.2f ms worst, "
+             "%.2f ms work, %.2f ms input latency (%.2f worst)",
+             stats_.averageMs, stats_.deviationMs, stats_.worstMs,
+             stats_.workMs, stats_.inputLatencyMs,
+             stats_.inputLatencyWorstMs);
+  }
+}
+
+void FramePacer::resume() {
+  hasPreviousFrame_ = false;
+}
+
+void FramePacer::recordInputEvent(Clock::time_point eventTime) {
+  pendingInput_ = std::min(pendingInput_, eventTime);
+}
+
+void FramePacer::setVsyncMode(VsyncMode mode) {
+  vsyncMode_ = mode;
+  applySwapInterval();
+}
+
+VsyncMode FramePacer::getVsyncMode() const {
+  return vsyncMode_;
+}
+
+void FramePacer::cycleVsyncMode() {
+  switch (vsyncMode_) {
+    case VsyncMode::Off: setVsyncMode(VsyncMode::On); break;
+    case VsyncMode::On: setVsyncMode(VsyncMode::Adaptive); break;
+    default: setVsyncMode(VsyncMode::Off); break;
+  }
+  std::cout << "Vsync: " << getVsyncModeName(vsyncMode_) << std::endl;
+}
+
+const char* FramePacer::getVsyncModeName(VsyncMode mode) {
+  switch (mode) {
+    case VsyncMode::Off: return "OFF";
+    case VsyncMode::On: return "ON";
+    default: return "ADAPTIVE";
+  }
+}
+
+void FramePacer::setTargetFps(double fps) {
+  targetFps_ = std::max(0.0, fps);
+}
+
+double FramePacer::getTargetFps() const {
+  return targetFps_;
+}
+
+void FramePacer::setLowLatency(bool enabled) {
+  lowLatency_ = enabled;
+  std::cout << "Low latency mode: " << (enabled ? "on" : "off") << std::endl;
+}
+
+bool FramePacer::isLowLatency() const {
+  return lowLatency_;
+}
+
+const FramePacer::Stats& FramePacer::getStats() const {
+  return stats_;
+}
+
+double FramePacer::framePeriod() const {
+  if (targetFps_ > 0.0) {
+    return 1.0 / targetFps_;
+  }
+  // Uncapped with vsync: low latency still needs the refresh period to
+  // know when the next present is
+  if (lowLatency_ && vsyncMode_ != VsyncMode::Off) {
+    return 1.0 / refreshRate_;
+  }
+  return 0.0;
+}
+
+void FramePacer::waitUntil(Clock::time_point deadline) {
+  // Sleep in 1 ms steps while the deadline is far off; a sleep can wake up
+  // late by the scheduler granularity, so the last stretch is spun
+  while (true) {
+    const Clock::time_point before = Clock::now();
+    if (toSeconds(deadline - before) <= sleepEstimate_) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Track the longest 1 ms sleep, slowly forgetting old outliers
+    const double slept = toSeconds(Clock::now() - before);
+    sleepEstimate_ =
+        std::clamp(std::max(slept, sleepEstimate_ * 0.99), 0.001, 0.02);
+  }
+
+  while (Clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+}
+
+void FramePacer::applySwapInterval() const {
+  if (!initialized_) {
+    return;
+  }
+
+  int interval = vsyncMode_ == VsyncMode::Off ? 0 : 1;
+  if (vsyncMode_ == VsyncMode::Adaptive) {
+    if (adaptiveSupported_) {
+      interval = -1;
+    } else {
+      std::cout << "Adaptive vsync not supported, using vsync on"
+                << std::endl;
+    }
+  }
+  glfwSwapInterval(interval);
+}
+
+void FramePacer::updateStats() {
+  double sum = 0.0;
+  double worst = 0.0;
+  for (size_t i = 0; i < frameTimeCount_; ++i) {
+    sum += frameTimes_[i];
+    worst = std::max(worst, frameTimes_[i]);
+  }
+  const double average = sum / frameTimeCount_;
+
+  double variance = 0.0;
+  for (size_t i = 0; i < frameTimeCount_; ++i) {
+    const double delta = frameTimes_[i] - average;
+    variance += delta * delta;
+  }
+  variance /= frameTimeCount_;
+
+  stats_.averageMs = average * 1000.0;
+  stats_.deviationMs = std::sqrt(variance) * 1000.0;
+  stats_.worstMs = worst * 1000.0;
+  stats_.workMs = workEstimate_ * 1000.0;
+}
+
+void FramePacer::updateInputLatency(double latency) {
+  inputLatencies_[nextInputLatency_] = latency;
+  nextInputLatency_ = (nextInputLatency_ + 1) % HISTORY_SIZE;
+  inputLatencyCount_ = std::min(inputLatencyCount_ + 1, HISTORY_SIZE);
+
+  double sum = 0.0;
+  double worst = 0.0;
+  for (size_t i = 0; i < inputLatencyCount_; ++i) {
+    sum += inputLatencies_[i];
+    worst = std::max(worst, inputLatencies_[i]);
+  }
+  stats_.inputLatencyMs = sum / inputLatencyCount_ * 1000.0;
+  stats_.inputLatencyWorstMs = worst * 1000.0;
+}
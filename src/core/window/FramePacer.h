@@ -0,0 +1,108 @@
+#ifndef SOLAR_SYSTEM_OPENGL_FRAMEPACER_H
+#define SOLAR_SYSTEM_OPENGL_FRAMEPACER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+struct GLFWwindow;
+
+enum class VsyncMode {
+  Off,
+  On,
+  Adaptive  // tears instead of waiting a whole interval when a frame is late
+};
+
+// Paces the frame loop: swap interval, an optional frame-rate cap and a
+// low-latency mode that starts each frame as late as its measured cost
+// allows, so input is sampled just before the frame is presented. Waiting
+// sleeps while the deadline is far off and spins only for the last stretch.
+// Settings come from AppConfig, overridable with SOLAR_TARGET_FPS,
+// SOLAR_VSYNC=off|on|adaptive and SOLAR_LOW_LATENCY=0|1.
+// All methods run on the thread that owns the GL context.
+class FramePacer {
+ public:
+  struct Stats {
+    double averageMs = 0.0;
+    double deviationMs = 0.0;  // standard deviation of the frame time
+    double worstMs = 0.0;
+    double workMs = 0.0;  // estimated CPU cost of a frame
+    // From the oldest input event a frame consumed to its swap returning
+    double inputLatencyMs = 0.0;
+    double inputLatencyWorstMs = 0.0;
+  };
+
+  FramePacer();
+  ~FramePacer();
+
+  // With the context current: applies the swap interval and reads the
+  // display refresh rate
+  void initialize(GLFWwindow* window);
+
+  // Before input is sampled: waits until the frame is due
+  void waitForFrame();
+  // Right before the buffer swap
+  void markSubmitted();
+  // After the buffer swap: records the frame time
+  void endFrame();
+  // A frame was skipped (on-demand rendering): the gap is not a frame time
+  // and the next frame starts a new cadence
+  void resume();
+  // The frame being built consumed an input event seen at eventTime
+  void recordInputEvent(std::chrono::steady_clock::time_point eventTime);
+
+  void setVsyncMode(VsyncMode mode);
+  VsyncMode getVsyncMode() const;
+  // Off -> On -> Adaptive -> Off
+  void cycleVsyncMode();
+  static const char* getVsyncModeName(VsyncMode mode);
+
+  // 0 leaves the rate to vsync
+  void setTargetFps(double fps);
+  double getTargetFps() const;
+
+  void setLowLatency(bool enabled);
+  bool isLowLatency() const;
+
+  const Stats& getStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t HISTORY_SIZE = 128;
+
+  VsyncMode vsyncMode_ = VsyncMode::On;
+  double targetFps_ = 0.0;
+  bool lowLatency_ = false;
+  bool adaptiveSupported_ = false;
+  bool initialized_ = false;
+  double refreshRate_ = 60.0;
+
+  Clock::time_point frameStart_;
+  Clock::time_point nextFrameStart_;
+  Clock::time_point lastPresent_;
+  Clock::time_point lastReport_;
+  bool hasPreviousFrame_ = false;
+
+  // Seconds a 1 ms sleep may really take; closer than that to the deadline
+  // the wait spins instead
+  double sleepEstimate_ = 0.002;
+  double workEstimate_ = 0.0;
+
+  std::array<double, HISTORY_SIZE> frameTimes_{};
+  size_t frameTimeCount_ = 0;
+  size_t nextFrameTime_ = 0;
+  // Oldest input event of the frame being built, max() if none
+  Clock::time_point pendingInput_ = Clock::time_point::max();
+  std::array<double, HISTORY_SIZE> inputLatencies_{};
+  size_t inputLatencyCount_ = 0;
+  size_t nextInputLatency_ = 0;
+  Stats stats_;
+
+  double framePeriod() const;
+  void waitUntil(Clock::time_point deadline);
+  void applySwapInterval() const;
+  void updateStats();
+  void updateInputLatency(double latency);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_FRAMEPACER_H
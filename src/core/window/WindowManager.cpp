@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 WindowManager::~WindowManager() {
   shutdown();
@@ -20,6 +21,7 @@ void WindowManager::create(int width, int height, const std::string& title,
   }
 
   glfwMakeContextCurrent(window);
+  framePacer.initialize(window);
   std::cout << "Window created: " << title << " (" << width << "x" << height
             << ")" << std::endl;
 
@@ -33,23 +35,145 @@ void WindowManager::create(int width, int height, const std::string& title,
   }
 }
 
-void WindowManager::run(const std::function<void()>& onFrame) {
+void WindowManager::run(const FrameCallback& onFrame) {
   while (!glfwWindowShouldClose(window)) {
-    if (isTerminated) {
+    if (isTerminated || closeRequested) {
       glfwSetWindowShouldClose(window, true);
       return;
     }
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    const bool draw = waitForFrame();
+    if (draw) {
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
     currentTime = static_cast<float>(glfwGetTime());
 
     if (onFrame) {
-      onFrame();
+      onFrame(draw);
+    }
+
+    if (draw) {
+      framePacer.markSubmitted();
+      glfwSwapBuffers(window);
+      framePacer.endFrame();
     }
+  }
+}
+
+bool WindowManager::waitForFrame() {
+  if (onDemand && !redrawRequested.exchange(false)) {
+    // Nothing changed: sleep until input arrives or the idle tick is due
+    glfwWaitEventsTimeout(idleTimeout);
+    if (!redrawRequested.exchange(false)) {
+      framePacer.resume();
+      return false;
+    }
+  }
+
+  // Events are polled after the wait so the frame sees the latest input
+  framePacer.waitForFrame();
+  glfwPollEvents();
+  return true;
+}
+
+bool WindowManager::waitForRedraw(const std::atomic<bool>& rendering) {
+  if (!onDemand || redrawRequested.exchange(false)) {
+    return true;
+  }
 
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+  // The render thread cannot wait on GLFW events, requestRedraw wakes it
+  std::unique_lock<std::mutex> lock(redrawMutex);
+  redrawSignal.wait_for(
+      lock, std::chrono::duration<double>(idleTimeout), [this, &rendering] {
+        return redrawRequested.load() ||
+               !rendering.load(std::memory_order_acquire);
+      });
+  if (!redrawRequested.exchange(false)) {
+    framePacer.resume();
+    return false;
   }
+  return true;
+}
+
+void WindowManager::runThreaded(const FrameCallback& onFrame,
+                                const std::function<void()>& onEvents,
+                                double eventInterval) {
+  std::atomic<bool> rendering{true};
+
+  // A context can only be current on one thread at a time
+  glfwMakeContextCurrent(nullptr);
+  std::thread renderThread([this, &onFrame, &rendering] {
+    glfwMakeContextCurrent(window);
+    while (rendering.load(std::memory_order_acquire)) {
+      const bool draw = waitForRedraw(rendering);
+      if (draw) {
+        framePacer.waitForFrame();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      }
+
+      currentTime = static_cast<float>(glfwGetTime());
+
+      if (onFrame) {
+        onFrame(draw);
+      }
+
+      if (draw) {
+        // May block on vsync; only this thread waits for it
+        framePacer.markSubmitted();
+        glfwSwapBuffers(window);
+        framePacer.endFrame();
+      }
+    }
+    glfwMakeContextCurrent(nullptr);
+  });
+  std::cout << "Render thread started" << std::endl;
+
+  while (!glfwWindowShouldClose(window) && !isTerminated && !closeRequested) {
+    glfwWaitEventsTimeout(eventInterval);
+    if (onEvents) {
+      onEvents();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(redrawMutex);
+    rendering.store(false, std::memory_order_release);
+  }
+  redrawSignal.notify_all();
+  renderThread.join();
+  glfwMakeContextCurrent(window);
+  glfwSetWindowShouldClose(window, true);
+  std::cout << "Render thread stopped" << std::endl;
+}
+
+void WindowManager::requestClose() {
+  closeRequested = true;
+  // Wakes the main thread if it is waiting for events
+  glfwPostEmptyEvent();
+}
+
+void WindowManager::setOnDemand(bool enabled, double timeout) {
+  idleTimeout = timeout;
+  onDemand = enabled;
+  requestRedraw();
+  std::cout << "On-demand rendering: " << (enabled ? "on" : "off")
+            << std::endl;
+}
+
+bool WindowManager::isOnDemand() const {
+  return onDemand;
+}
+
+void WindowManager::requestRedraw() {
+  if (redrawRequested.exchange(true)) {
+    return;
+  }
+  {
+    // Pairs with the predicate check in waitForRedraw
+    std::lock_guard<std::mutex> lock(redrawMutex);
+  }
+  redrawSignal.notify_all();
+  glfwPostEmptyEvent();
 }
 
 void WindowManager::toggleFullscreen() {
@@ -80,6 +204,14 @@ GLFWwindow* WindowManager::getWindow() const {
   return window;
 }
 
+FramePacer& WindowManager::getFramePacer() {
+  return framePacer;
+}
+
+const FramePacer& WindowManager::getFramePacer() const {
+  return framePacer;
+}
+
 float WindowManager::getGLFWTime() const {
   return currentTime;
 }
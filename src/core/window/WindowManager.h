@@ -4,21 +4,47 @@
 
 #ifndef SOLAR_SYSTEM_OPENGL_WINDOWMANAGER_H
 #define SOLAR_SYSTEM_OPENGL_WINDOWMANAGER_H
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <string>
 
+#include <core/window/FramePacer.h>
+
 #include "GLFW/glfw3.h"
 
 class WindowManager {
 public:
+  // draw is false for frames skipped in on-demand mode: the callback still
+  // runs to look for changes, but nothing is cleared or swapped
+  using FrameCallback = std::function<void(bool draw)>;
+
   WindowManager() = default;
   ~WindowManager();
 
   void create(int width, int height, const std::string& title,
               const std::function<void()>& onWindowCreated);
-  void run(const std::function<void()>& onFrame = nullptr);
+  void run(const FrameCallback& onFrame = nullptr);
+  // Hands the GL context to a render thread that runs onFrame and swaps,
+  // while this (main) thread pumps OS events and calls onEvents at least
+  // every eventInterval seconds. Returns with the context current again.
+  void runThreaded(const FrameCallback& onFrame,
+                   const std::function<void()>& onEvents,
+                   double eventInterval);
+  // Any thread: ends run/runThreaded after the current frame
+  void requestClose();
+  // On-demand rendering: a frame is only drawn after requestRedraw. In
+  // between, the loop sleeps until an event arrives, waking every
+  // idleTimeout seconds so the frame callback can look for changes.
+  void setOnDemand(bool enabled, double idleTimeout);
+  bool isOnDemand() const;
+  // Any thread: draw the next frame, waking the loop if it is idle
+  void requestRedraw();
   void toggleFullscreen();
   GLFWwindow* getWindow() const;
+  FramePacer& getFramePacer();
+  const FramePacer& getFramePacer() const;
   float getGLFWTime() const;
   void shutdown();
 private:
@@ -31,7 +57,20 @@ private:
   int windowedPosX = 0;
   int windowedPosY = 0;
 
-  float currentTime = 0.0f;
+  FramePacer framePacer;
+
+  std::atomic<float> currentTime{0.0f};
+  std::atomic<bool> closeRequested{false};
+
+  // On-demand rendering
+  std::atomic<bool> onDemand{false};
+  double idleTimeout = 0.5;
+  std::atomic<bool> redrawRequested{true};
+  std::mutex redrawMutex;
+  std::condition_variable redrawSignal;
+
+  bool waitForFrame();
+  bool waitForRedraw(const std::atomic<bool>& rendering);
 
   // Cleanup
   bool isTerminated = false;
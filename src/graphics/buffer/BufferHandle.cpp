@@ -7,14 +7,20 @@
 #include "BufferManager.h"
 #include <utils/debug_utils.h>
 
-BufferHandle::BufferHandle(unsigned int vao, unsigned int vbo, unsigned int ebo,
+BufferHandle::BufferHandle(MeshHandle mesh, unsigned int vao,
+                           unsigned int vbo, unsigned int ebo,
                            BufferManager* manager)
-    : vao(vao), vbo(vbo), ebo(ebo), manager(manager) {}
+    : mesh(mesh), vao(vao), vbo(vbo), ebo(ebo), manager(manager) {}
 
 BufferHandle::~BufferHandle() { release(); }
 
 BufferHandle::BufferHandle(BufferHandle&& other) noexcept
-    : vao(other.vao), vbo(other.vbo), ebo(other.ebo), manager(other.manager) {
+    : mesh(other.mesh),
+      vao(other.vao),
+      vbo(other.vbo),
+      ebo(other.ebo),
+      manager(other.manager) {
+  other.mesh = {};
   other.vao = 0;
   other.vbo = 0;
   other.ebo = 0;
@@ -24,10 +30,12 @@ BufferHandle::BufferHandle(BufferHandle&& other) noexcept
 BufferHandle& BufferHandle::operator=(BufferHandle&& other) noexcept {
   if (this != &other) {
     release();
+    mesh = other.mesh;
     vao = other.vao;
     vbo = other.vbo;
     ebo = other.ebo;
     manager = other.manager;
+    other.mesh = {};
     other.vao = 0;
     other.vbo = 0;
     other.ebo = 0;
@@ -42,13 +50,14 @@ void BufferHandle::release() {
   }
 
   if (manager != nullptr) {
-    manager->releaseBufferSet(vao, vbo, ebo);
+    manager->releaseBufferSet(mesh);
   } else {
     GL_CHECK(glDeleteVertexArrays(1, &vao));
     GL_CHECK(glDeleteBuffers(1, &vbo));
     GL_CHECK(glDeleteBuffers(1, &ebo));
   }
 
+  mesh = {};
   vao = vbo = ebo = 0;
   manager = nullptr;
 }
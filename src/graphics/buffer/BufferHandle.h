@@ -5,6 +5,10 @@
 #ifndef BUFFER_HANDLE_H
 #define BUFFER_HANDLE_H
 
+#include <core/resources/Handle.h>
+
+class BufferManager;
+
 class BufferHandle {
  public:
   BufferHandle() = default;
@@ -19,15 +23,19 @@ class BufferHandle {
   unsigned int getVAO() const { return vao; }
   unsigned int getVBO() const { return vbo; }
   unsigned int getEBO() const { return ebo; }
+  MeshHandle getMesh() const { return mesh; }
 
   bool isValid() const { return vao != 0; }
 
  private:
   friend class BufferManager;
 
-  BufferHandle(unsigned int vao, unsigned int vbo, unsigned int ebo,
-               BufferManager* manager);
+  BufferHandle(MeshHandle mesh, unsigned int vao, unsigned int vbo,
+               unsigned int ebo, BufferManager* manager);
 
+  // Owns one reference to the manager's entry; the GL names are cached so
+  // binding never goes through the pool
+  MeshHandle mesh;
   unsigned int vao = 0;
   unsigned int vbo = 0;
   unsigned int ebo = 0;
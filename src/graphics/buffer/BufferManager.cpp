@@ -6,6 +6,9 @@
 #include "BufferHandle.h"
 
 #include <iostream>
+#include <optional>
+#include <core/logging/Logger.h>
+#include <core/resources/GpuDeletionQueue.h>
 #include <utils/debug_utils.h>
 
 
@@ -14,12 +17,15 @@ BufferManager::~BufferManager() {
     std::cout << "BufferManager: Cleaning up " << bufferRegistry.size()
               << " remaining buffer sets\n";
 
-    for (const auto& [vao, info] : bufferRegistry) {
-      std::cout << "  - " << info.ownerName << "\n";
+    bufferRegistry.each([this](MeshHandle mesh, const BufferInfo& info) {
+      std::cout << "  - " << info.ownerName << " ("
+                << bufferRegistry.getRefCount(mesh) << " references)\n";
+      MemoryTracker::release(info.category, MemoryDomain::GPU,
+                             info.vertexDataSize + info.indexDataSize);
       glDeleteVertexArrays(1, &info.vao);
       glDeleteBuffers(1, &info.vbo);
       glDeleteBuffers(1, &info.ebo);
-    }
+    });
   } else {
     std::cout << "BufferManager: All buffers were properly released\n";
   }
@@ -35,6 +41,10 @@ BufferHandle BufferManager::createBufferSet(
     GLenum usage,
     bool isBufferText
 ) {
+    // Text quads are rewritten every glyph: 6 vertices of vec4
+    const size_t vertexBytes = isBufferText ? sizeof(float) * 24
+                                            : vertexData.size() * sizeof(float);
+
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -77,38 +87,46 @@ BufferHandle BufferManager::createBufferSet(
     GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
     GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
-    registerBuffer(vao, vbo, ebo, ownerName,
-                  vertexData.size() * sizeof(float),
-                  indexData.size() * sizeof(unsigned int));
+    const MeshHandle mesh = registerBuffer(
+        vao, vbo, ebo, ownerName, vertexBytes,
+        indexData.size() * sizeof(unsigned int),
+        isBufferText ? MemoryCategory::UI : MemoryCategory::Meshes);
 
-    std::cout << "Created buffer set for: " << ownerName
-              << " (VAO=" << vao << ")\n";
+    LOG_DEBUG("Created buffer set for: %s (VAO=%u)", ownerName.c_str(), vao);
+
+    return BufferHandle(mesh, vao, vbo, ebo, this);
+}
 
-    return BufferHandle(vao, vbo, ebo, this);
+void BufferManager::retainBufferSet(MeshHandle mesh) {
+  bufferRegistry.retain(mesh);
 }
 
-void BufferManager::releaseBufferSet(unsigned int vao, unsigned int vbo,
-                                     unsigned int ebo) {
-  auto it = bufferRegistry.find(vao);
-  if (it != bufferRegistry.end()) {
-    std::cout << "Releasing buffer set: " << it->second.ownerName
-              << " (VAO=" << vao << ")\n";
-    bufferRegistry.erase(it);
+void BufferManager::releaseBufferSet(MeshHandle mesh) {
+  const std::optional<BufferInfo> info = bufferRegistry.release(mesh);
+  if (!info) {
+    return;
   }
 
-  glUseProgram(0);
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  LOG_DEBUG("Releasing buffer set: %s (VAO=%u)", info->ownerName.c_str(),
+            info->vao);
 
-  glDeleteVertexArrays(1, &vao);
-  glDeleteBuffers(1, &vbo);
-  glDeleteBuffers(1, &ebo);
+  // Deleted in bulk once the GPU is past this frame, no unbinding here
+  GpuDeletionQueue::deleteVertexArray(info->vao);
+  GpuDeletionQueue::deleteBuffer(info->vbo);
+  GpuDeletionQueue::deleteBuffer(info->ebo);
+  GpuDeletionQueue::releaseBytes(info->category,
+                                 info->vertexDataSize + info->indexDataSize);
 }
 
-void BufferManager::registerBuffer(unsigned int vao, unsigned int vbo,
-                                   unsigned int ebo, const std::string& ownerName,
-                                   size_t vertexSize, size_t indexSize) {
+const BufferInfo* BufferManager::getBufferSet(MeshHandle mesh) const {
+  return bufferRegistry.get(mesh);
+}
+
+MeshHandle BufferManager::registerBuffer(unsigned int vao, unsigned int vbo,
+                                         unsigned int ebo,
+                                         const std::string& ownerName,
+                                         size_t vertexSize, size_t indexSize,
+                                         MemoryCategory category) {
     BufferInfo info;
     info.vao = vao;
     info.vbo = vbo;
@@ -116,29 +134,32 @@ void BufferManager::registerBuffer(unsigned int vao, unsigned int vbo,
     info.ownerName = ownerName;
     info.vertexDataSize = vertexSize;
     info.indexDataSize = indexSize;
+    info.category = category;
     info.active = true;
 
-    bufferRegistry[vao] = info;
+    MemoryTracker::allocate(category, MemoryDomain::GPU, vertexSize + indexSize);
+    return bufferRegistry.create(std::move(info));
 }
 
 void BufferManager::printActiveBuffers() const {
     std::cout << "\n=== Active Buffer Sets ===\n";
-    for (const auto& [vao, info] : bufferRegistry) {
+    bufferRegistry.each([this](MeshHandle mesh, const BufferInfo& info) {
         std::cout << "  " << info.ownerName
                   << " - VAO: " << info.vao
                   << ", VBO: " << info.vbo
                   << ", EBO: " << info.ebo
                   << " | VRAM: " << (info.vertexDataSize + info.indexDataSize) / 1024
-                  << " KB\n";
-    }
+                  << " KB, " << bufferRegistry.getRefCount(mesh)
+                  << " references\n";
+    });
     std::cout << "Total buffer sets: " << bufferRegistry.size() << "\n";
     std::cout << "Total VRAM: " << getTotalVRAMUsage() / 1024 / 1024 << " MB\n\n";
 }
 
 size_t BufferManager::getTotalVRAMUsage() const {
     size_t total = 0;
-    for (const auto& [vao, info] : bufferRegistry) {
+    bufferRegistry.each([&total](MeshHandle, const BufferInfo& info) {
         total += info.vertexDataSize + info.indexDataSize;
-    }
+    });
     return total;
 }
\ No newline at end of file
@@ -6,8 +6,11 @@
 #define BUFFER_MANAGER_H
 
 #include "glad/glad.h"
+
+#include <core/memory/MemoryTracker.h>
+#include <core/resources/HandlePool.h>
+
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class BufferHandle;
@@ -28,6 +31,7 @@ struct BufferInfo {
   std::string ownerName;
   size_t vertexDataSize;
   size_t indexDataSize;
+  MemoryCategory category;
   bool active;
 };
 
@@ -43,7 +47,12 @@ class BufferManager {
                                GLenum usage = GL_STATIC_DRAW,
                                bool isBufferText = false);
 
-  void releaseBufferSet(unsigned int vao, unsigned int vbo, unsigned int ebo);
+  // Reference counting for owners that share a buffer set beyond its
+  // BufferHandle; the GL objects go with the last reference
+  void retainBufferSet(MeshHandle mesh);
+  void releaseBufferSet(MeshHandle mesh);
+  // nullptr for a released handle
+  const BufferInfo* getBufferSet(MeshHandle mesh) const;
 
   // Diagnostics
   void printActiveBuffers() const;
@@ -51,11 +60,12 @@ class BufferManager {
   size_t getTotalVRAMUsage() const;
 
  private:
-  std::unordered_map<unsigned int, BufferInfo> bufferRegistry;
+  HandlePool<BufferInfo, MeshTag> bufferRegistry{"Mesh"};
 
-  void registerBuffer(unsigned int vao, unsigned int vbo, unsigned int ebo,
-                      const std::string& ownerName, size_t vertexSize,
-                      size_t indexSize);
+  MeshHandle registerBuffer(unsigned int vao, unsigned int vbo,
+                            unsigned int ebo, const std::string& ownerName,
+                            size_t vertexSize, size_t indexSize,
+                            MemoryCategory category);
 };
 
 #endif
\ No newline at end of file
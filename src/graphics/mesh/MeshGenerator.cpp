@@ -4,12 +4,45 @@
 
 #include "MeshGenerator.h"
 
+#include <graphics/mesh/MeshOptimizer.h>
 #include <utils/math_utils.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "glm/glm.hpp"
+
+namespace {
+constexpr unsigned int VERTEX_FLOATS = 5;  // position, texture coordinates
+
+// Equirectangular coordinates as generateSphereMesh lays them out: u runs
+// from +x towards +z around the y axis, v from the north pole (0) to the
+// south pole (1)
+float longitudeU(const glm::vec3& direction) {
+  const float u = std::atan2(direction.z, direction.x) /
+                  static_cast<float>(2 * M_PI);
+  return u < 0.0f ? u + 1.0f : u;
+}
+
+float latitudeV(const glm::vec3& direction) {
+  return 0.5f - std::asin(std::clamp(direction.y, -1.0f, 1.0f)) /
+                    static_cast<float>(M_PI);
+}
+}  // namespace
+
 SphereMeshData MeshGenerator::generateSphereMesh(float radius,
                                                  unsigned int sectorCount,
                                                  unsigned int stackCount) const {
   SphereMeshData data;
+  // A ring of sectorCount + 1 vertices per stack boundary; one triangle
+  // per sector at each pole and two everywhere else
+  data.vertices.reserve(static_cast<size_t>(stackCount + 1) *
+                        (sectorCount + 1) * VERTEX_FLOATS);
+  data.indices.reserve(static_cast<size_t>(sectorCount) *
+                       (stackCount > 1 ? stackCount - 1 : 0) * 6);
 
   float x, y, z, xy;
   float sectorStep = 2 * M_PI / sectorCount;
@@ -60,7 +93,189 @@ SphereMeshData MeshGenerator::generateSphereMesh(float radius,
     }
   }
 
+  MeshOptimizer::optimize(data, VERTEX_FLOATS, "UV sphere");
   data.indicesCount = data.indices.size();
 
   return data;
+}
+
+SphereMeshData MeshGenerator::generateIcosphereMesh(
+    float radius, unsigned int subdivisions) const {
+  // Unit icosahedron, wound like generateSphereMesh's triangles
+  const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+  std::vector<glm::vec3> positions = {
+      {-1.0f, t, 0.0f}, {1.0f, t, 0.0f},   {-1.0f, -t, 0.0f}, {1.0f, -t, 0.0f},
+      {0.0f, -1.0f, t}, {0.0f, 1.0f, t},   {0.0f, -1.0f, -t}, {0.0f, 1.0f, -t},
+      {t, 0.0f, -1.0f}, {t, 0.0f, 1.0f},   {-t, 0.0f, -1.0f}, {-t, 0.0f, 1.0f}};
+  for (glm::vec3& position : positions) {
+    position = glm::normalize(position);
+  }
+  std::vector<unsigned int> triangles = {
+      0, 5, 11, 0, 1, 5, 0, 7, 1,  0, 10, 7, 0, 11, 10,
+      1, 9, 5,  5, 4, 11, 11, 2, 10, 10, 6, 7, 7, 8, 1,
+      3, 4, 9,  3, 2, 4, 3, 6, 2,  3, 8, 6, 3, 9, 8,
+      4, 5, 9,  2, 11, 4, 6, 10, 2, 8, 7, 6, 9, 1, 8};
+
+  // Each pass splits every triangle in four; an edge's midpoint is shared
+  // by the two triangles on either side of it
+  // Each pass adds a vertex per edge: 10 * 4^n + 2 vertices in the end
+  positions.reserve(10 * (size_t(1) << (2 * subdivisions)) + 2);
+  for (unsigned int pass = 0; pass < subdivisions; ++pass) {
+    std::unordered_map<uint64_t, unsigned int> midpoints;
+    midpoints.reserve(triangles.size() / 2);
+    const auto midpoint = [&](unsigned int a, unsigned int b) {
+      const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) |
+                           std::max(a, b);
+      const auto found = midpoints.find(key);
+      if (found != midpoints.end()) {
+        return found->second;
+      }
+      const auto index = static_cast<unsigned int>(positions.size());
+      positions.push_back(glm::normalize(positions[a] + positions[b]));
+      midpoints.emplace(key, index);
+      return index;
+    };
+
+    std::vector<unsigned int> split;
+    split.reserve(triangles.size() * 4);
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+      const unsigned int a = triangles[i];
+      const unsigned int b = triangles[i + 1];
+      const unsigned int c = triangles[i + 2];
+      const unsigned int ab = midpoint(a, b);
+      const unsigned int bc = midpoint(b, c);
+      const unsigned int ca = midpoint(c, a);
+      split.insert(split.end(),
+                   {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+    }
+    triangles.swap(split);
+  }
+
+  // Texture coordinates are per corner: a triangle across the u = 0/1
+  // seam takes its small-u corners past 1 (the textures repeat), and a
+  // pole, where longitude is undefined, takes the mean of the other two.
+  // Corners that agree share a vertex.
+  SphereMeshData data;
+  // Exact for the indices; the seam and poles add a few vertices beyond
+  // the shared ones
+  data.indices.reserve(triangles.size());
+  data.vertices.reserve(positions.size() * VERTEX_FLOATS);
+  std::unordered_map<uint64_t, unsigned int> corners;
+  corners.reserve(positions.size());
+  for (size_t i = 0; i < triangles.size(); i += 3) {
+    float u[3];
+    bool pole[3];
+    float low = 1.0f;
+    float high = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+      const glm::vec3& p = positions[triangles[i + k]];
+      pole[k] = p.x * p.x + p.z * p.z < 1e-10f;
+      u[k] = pole[k] ? 0.0f : longitudeU(p);
+      if (!pole[k]) {
+        low = std::min(low, u[k]);
+        high = std::max(high, u[k]);
+      }
+    }
+    for (int k = 0; k < 3; ++k) {
+      if (!pole[k] && high - low > 0.5f && u[k] < 0.5f) {
+        u[k] += 1.0f;
+      }
+    }
+    for (int k = 0; k < 3; ++k) {
+      if (pole[k]) {
+        u[k] = (u[(k + 1) % 3] + u[(k + 2) % 3]) * 0.5f;
+      }
+    }
+
+    for (int k = 0; k < 3; ++k) {
+      const unsigned int source = triangles[i + k];
+      uint32_t uBits;
+      std::memcpy(&uBits, &u[k], sizeof(uBits));
+      const uint64_t key = (static_cast<uint64_t>(source) << 32) | uBits;
+      auto found = corners.find(key);
+      if (found == corners.end()) {
+        const glm::vec3& p = positions[source];
+        const auto index =
+            static_cast<unsigned int>(data.vertices.size() / VERTEX_FLOATS);
+        data.vertices.insert(data.vertices.end(),
+                             {p.x * radius, p.y * radius, p.z * radius, u[k],
+                              latitudeV(p)});
+        found = corners.emplace(key, index).first;
+      }
+      data.indices.push_back(found->second);
+    }
+  }
+
+  MeshOptimizer::optimize(data, VERTEX_FLOATS, "Icosphere");
+  data.indicesCount = data.indices.size();
+
+  return data;
+}
+
+SphereLodMeshData MeshGenerator::generateSphereLods(
+    float radius, SphereTopology topology) const {
+  // Sectors and stacks, finest first; the middle level is the sphere
+  // bodies were drawn with before levels of detail
+  static constexpr unsigned int UV_LEVELS[SPHERE_LOD_LEVELS][2] = {
+      {128, 64}, {72, 36}, {36, 18}, {18, 9}, {10, 5}};
+
+  // Each level comes out optimised on its own; concatenating them keeps
+  // that, and knowing every level first sizes the buffers exactly
+  std::vector<SphereMeshData> levels;
+  levels.reserve(SPHERE_LOD_LEVELS);
+  size_t vertexFloats = 0;
+  size_t indexCount = 0;
+  for (unsigned int level = 0; level < SPHERE_LOD_LEVELS; ++level) {
+    levels.push_back(topology == SphereTopology::Icosphere
+                         ? generateIcosphereMesh(radius,
+                                                 SPHERE_LOD_LEVELS - level)
+                         : generateSphereMesh(radius, UV_LEVELS[level][0],
+                                              UV_LEVELS[level][1]));
+    vertexFloats += levels.back().vertices.size();
+    indexCount += levels.back().indices.size();
+  }
+
+  SphereLodMeshData data;
+  data.vertices.reserve(vertexFloats);
+  data.indices.reserve(indexCount);
+  data.lods.reserve(SPHERE_LOD_LEVELS);
+  for (const SphereMeshData& mesh : levels) {
+    const auto firstVertex =
+        static_cast<unsigned int>(data.vertices.size() / VERTEX_FLOATS);
+    data.lods.push_back({static_cast<unsigned int>(data.indices.size()),
+                         mesh.indicesCount,
+                         measureSphereError(mesh, radius)});
+    data.vertices.insert(data.vertices.end(), mesh.vertices.begin(),
+                         mesh.vertices.end());
+    for (const unsigned int index : mesh.indices) {
+      data.indices.push_back(firstVertex + index);
+    }
+  }
+
+  data.indicesCount = data.indices.size();
+
+  return data;
+}
+
+float MeshGenerator::measureSphereError(const ObjectMeshData& data,
+                                        float radius) {
+  // The deepest point of a triangle inscribed in the sphere is the foot of
+  // the perpendicular from the centre onto its plane
+  const auto position = [&data](unsigned int index) {
+    const float* vertex = data.vertices.data() + index * VERTEX_FLOATS;
+    return glm::vec3(vertex[0], vertex[1], vertex[2]);
+  };
+  float error = 0.0f;
+  for (size_t i = 0; i + 2 < data.indices.size(); i += 3) {
+    const glm::vec3 a = position(data.indices[i]);
+    const glm::vec3 normal = glm::cross(position(data.indices[i + 1]) - a,
+                                        position(data.indices[i + 2]) - a);
+    const float length = glm::length(normal);
+    if (length <= 0.0f) {
+      continue;
+    }
+    const float distance = std::abs(glm::dot(normal, a)) / length;
+    error = std::max(error, 1.0f - distance / radius);
+  }
+  return error;
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #ifndef SOLAR_SYSTEM_OPENGL_MESHGENERATOR_H
 #define SOLAR_SYSTEM_OPENGL_MESHGENERATOR_H
+#include <graphics/mesh/MeshLod.h>
+
 #include <vector>
 
 struct ObjectMeshData {
@@ -15,9 +17,35 @@ struct ObjectMeshData {
 struct SphereMeshData : ObjectMeshData {};
 struct BoxMeshData : ObjectMeshData {};
 
+// Every level of detail of one sphere in a single vertex and index buffer;
+// each level's indices already point at its own vertices
+struct SphereLodMeshData : ObjectMeshData {
+  MeshLodChain lods;
+};
+
+enum class SphereTopology {
+  Uv,        // sectors and stacks; crowds triangles at the poles
+  Icosphere  // subdivided icosahedron; near-uniform triangles
+};
+
+// Vertices are position (3 floats) then texture coordinates (2 floats),
+// mapped equirectangularly whatever the topology
 class MeshGenerator {
 public:
   SphereMeshData generateSphereMesh(float radius, unsigned int sectorCount,
                                     unsigned int stackCount) const;
+  // 20 * 4^subdivisions triangles
+  SphereMeshData generateIcosphereMesh(float radius,
+                                       unsigned int subdivisions) const;
+  // SPHERE_LOD_LEVELS levels, finest first, the error of each measured
+  // from its triangles
+  SphereLodMeshData generateSphereLods(float radius,
+                                       SphereTopology topology) const;
+
+  static constexpr unsigned int SPHERE_LOD_LEVELS = 5;
+
+private:
+  // Largest gap between a triangle of data and the sphere, over radius
+  static float measureSphereError(const ObjectMeshData& data, float radius);
 };
 #endif  // SOLAR_SYSTEM_OPENGL_MESHGENERATOR_H
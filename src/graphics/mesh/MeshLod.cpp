@@ -0,0 +1,31 @@
+#include "MeshLod.h"
+
+namespace {
+// Coarsest level within maxError; the finest if none is
+unsigned int coarsestWithin(const MeshLodChain& lods, float screenRadius,
+                            float maxError) {
+  unsigned int level = 0;
+  while (level + 1 < lods.size() &&
+         lods[level + 1].relativeError * screenRadius <= maxError) {
+    level++;
+  }
+  return level;
+}
+}  // namespace
+
+unsigned int selectMeshLod(const MeshLodChain& lods, float screenRadius,
+                           float maxErrorPixels, float hysteresis,
+                           unsigned int current) {
+  if (lods.empty()) {
+    return 0;
+  }
+  if (current >= lods.size() ||
+      lods[current].relativeError * screenRadius > maxErrorPixels) {
+    // Too coarse (or unknown): refine right away, popping is worse than a
+    // few extra triangles
+    return coarsestWithin(lods, screenRadius, maxErrorPixels);
+  }
+  const unsigned int coarser = coarsestWithin(
+      lods, screenRadius, maxErrorPixels * (1.0f - hysteresis));
+  return coarser > current ? coarser : current;
+}
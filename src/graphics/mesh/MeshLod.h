@@ -0,0 +1,26 @@
+#ifndef SOLAR_SYSTEM_OPENGL_MESHLOD_H
+#define SOLAR_SYSTEM_OPENGL_MESHLOD_H
+
+#include <vector>
+
+// One level of detail of a mesh whose levels share a single index buffer
+struct MeshLod {
+  unsigned int firstIndex;
+  unsigned int indexCount;
+  // Largest gap between the triangles and the true surface, as a fraction
+  // of the radius
+  float relativeError;
+};
+
+// Levels of one mesh, finest first
+using MeshLodChain = std::vector<MeshLod>;
+
+// Index into lods of the coarsest level whose error, at a projected radius
+// of screenRadius pixels, stays within maxErrorPixels. Going coarser from
+// current needs the error to fit within (1 - hysteresis) of that, so a body
+// sitting at a threshold does not flip between two levels every frame.
+unsigned int selectMeshLod(const MeshLodChain& lods, float screenRadius,
+                           float maxErrorPixels, float hysteresis,
+                           unsigned int current);
+
+#endif  // SOLAR_SYSTEM_OPENGL_MESHLOD_H
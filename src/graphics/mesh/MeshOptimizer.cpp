@@ -0,0 +1,359 @@
+#include "MeshOptimizer.h"
+
+#include <core/logging/Logger.h>
+#include <graphics/mesh/MeshGenerator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "glm/glm.hpp"
+
+namespace {
+// Forsyth's tuning: the LRU cache the scores model, and how strongly they
+// favour recently used vertices and vertices with few triangles left
+constexpr unsigned int LRU_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+constexpr unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+
+float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+  if (remainingTriangles == 0) {
+    // Nothing left to draw with it
+    return -1.0f;
+  }
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    if (cachePosition < 3) {
+      // In the triangle just drawn: a fixed score, so the next triangle
+      // does not simply hug the last edge
+      score = LAST_TRIANGLE_SCORE;
+    } else {
+      const float scaler = 1.0f / static_cast<float>(LRU_CACHE_SIZE - 3);
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler,
+                       CACHE_DECAY_POWER);
+    }
+  }
+  return score +
+         VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles),
+                                        -VALENCE_BOOST_POWER);
+}
+
+// FIFO post-transform cache, simulated with insertion timestamps: a vertex
+// is cached while fewer than size vertices were inserted after it
+class FifoCache {
+ public:
+  FifoCache(size_t vertexCount, unsigned int size)
+      : size_(size), insertedAt_(vertexCount, 0), time_(size + 1) {}
+
+  // True on a miss, which inserts the vertex
+  bool transform(unsigned int vertex) {
+    if (time_ - insertedAt_[vertex] <= size_) {
+      return false;
+    }
+    insertedAt_[vertex] = time_++;
+    return true;
+  }
+
+  // Empties the cache in O(1): every timestamp falls out of the window
+  void clear() { time_ += size_ + 1; }
+
+ private:
+  unsigned int size_;
+  std::vector<unsigned int> insertedAt_;
+  unsigned int time_;
+};
+}  // namespace
+
+void MeshOptimizer::optimize(ObjectMeshData& mesh, unsigned int vertexFloats,
+                             const char* name) {
+  const VertexCacheStats before = analyzeVertexCache(
+      mesh.indices, mesh.vertices.size() / vertexFloats);
+
+  optimizeVertexCache(mesh.indices, mesh.vertices.size() / vertexFloats);
+  optimizeOverdraw(mesh.indices, mesh.vertices, vertexFloats,
+                   OVERDRAW_THRESHOLD);
+  optimizeVertexFetch(mesh.indices, mesh.vertices, vertexFloats);
+
+  const VertexCacheStats after = analyzeVertexCache(
+      mesh.indices, mesh.vertices.size() / vertexFloats);
+  LOG_DEBUG("%s, %zu triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", name,
+            mesh.indices.size() / 3, before.acmr, after.acmr, before.atvr,
+            after.atvr);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices,
+                                        size_t vertexCount) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  // Each vertex's triangles not yet drawn, packed: the first remaining[v]
+  // entries from offsets[v]
+  std::vector<unsigned int> offsets(vertexCount + 1, 0);
+  for (const unsigned int index : indices) {
+    offsets[index + 1]++;
+  }
+  std::vector<unsigned int> remaining(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    remaining[v] = offsets[v + 1];
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<unsigned int> adjacency(indices.size());
+  {
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+      adjacency[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+  }
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    vertexScores[v] = vertexScore(-1, remaining[v]);
+  }
+  std::vector<float> triangleScores(triangleCount);
+  for (size_t t = 0; t < triangleCount; t++) {
+    triangleScores[t] = vertexScores[indices[t * 3]] +
+                        vertexScores[indices[t * 3 + 1]] +
+                        vertexScores[indices[t * 3 + 2]];
+  }
+
+  std::vector<uint8_t> drawn(triangleCount, 0);
+  std::vector<unsigned int> output;
+  output.reserve(triangleCount * 3);
+  // One extra triangle's worth: the vertices it pushes out
+  unsigned int cache[LRU_CACHE_SIZE + 3];
+  unsigned int cacheSize = 0;
+  size_t nextUndrawn = 0;
+  size_t best = 0;
+
+  for (size_t step = 0; step < triangleCount; step++) {
+    drawn[best] = 1;
+    const unsigned int* triangle = &indices[best * 3];
+    unsigned int next[LRU_CACHE_SIZE + 3];
+    unsigned int nextSize = 0;
+    for (int k = 0; k < 3; k++) {
+      const unsigned int v = triangle[k];
+      output.push_back(v);
+      unsigned int* begin = &adjacency[offsets[v]];
+      unsigned int* end = begin + remaining[v];
+      std::iter_swap(std::find(begin, end, static_cast<unsigned int>(best)),
+                     end - 1);
+      remaining[v]--;
+      if (std::find(next, next + nextSize, v) == next + nextSize) {
+        next[nextSize++] = v;
+      }
+    }
+    const unsigned int triangleVertices = nextSize;
+    for (unsigned int i = 0; i < cacheSize; i++) {
+      if (std::find(next, next + triangleVertices, cache[i]) ==
+          next + triangleVertices) {
+        next[nextSize++] = cache[i];
+      }
+    }
+
+    // Rescore everything whose cache position moved, including what fell
+    // out, and the triangles they are part of
+    for (unsigned int i = 0; i < nextSize; i++) {
+      const unsigned int v = next[i];
+      cachePosition[v] = i < LRU_CACHE_SIZE ? static_cast<int>(i) : -1;
+      const float score = vertexScore(cachePosition[v], remaining[v]);
+      const float delta = score - vertexScores[v];
+      vertexScores[v] = score;
+      for (unsigned int a = 0; a < remaining[v]; a++) {
+        triangleScores[adjacency[offsets[v] + a]] += delta;
+      }
+    }
+    cacheSize = std::min(nextSize, LRU_CACHE_SIZE);
+    std::copy(next, next + cacheSize, cache);
+
+    // Next: the best triangle touching the cache, else the first one
+    // left in the input order
+    float bestScore = -1.0f;
+    bool found = false;
+    for (unsigned int i = 0; i < cacheSize; i++) {
+      const unsigned int v = cache[i];
+      for (unsigned int a = 0; a < remaining[v]; a++) {
+        const unsigned int t = adjacency[offsets[v] + a];
+        if (triangleScores[t] > bestScore) {
+          bestScore = triangleScores[t];
+          best = t;
+          found = true;
+        }
+      }
+    }
+    if (!found) {
+      while (nextUndrawn < triangleCount && drawn[nextUndrawn]) {
+        nextUndrawn++;
+      }
+      best = nextUndrawn;
+    }
+  }
+
+  indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices,
+                                     const std::vector<float>& vertices,
+                                     unsigned int vertexFloats,
+                                     float threshold) {
+  const size_t triangleCount = indices.size() / 3;
+  if (triangleCount < 2) {
+    return;
+  }
+  const auto position = [&](unsigned int index) {
+    const float* vertex = vertices.data() + size_t(index) * vertexFloats;
+    return glm::vec3(vertex[0], vertex[1], vertex[2]);
+  };
+
+  // Misses per triangle in the current order; where all three miss, the
+  // cache order restarts anyway and the order can be cut for free
+  std::vector<uint8_t> misses(triangleCount);
+  FifoCache cache(vertices.size() / vertexFloats, STATS_CACHE_SIZE);
+  for (size_t t = 0; t < triangleCount; t++) {
+    misses[t] = static_cast<uint8_t>(cache.transform(indices[t * 3]) +
+                                     cache.transform(indices[t * 3 + 1]) +
+                                     cache.transform(indices[t * 3 + 2]));
+  }
+
+  // Within those runs, cut again wherever the cluster so far, drawn from
+  // a cold cache as it will be once clusters are reordered, is already
+  // within threshold of the whole run's ACMR
+  std::vector<size_t> clusterStarts;
+  size_t hardStart = 0;
+  while (hardStart < triangleCount) {
+    size_t hardEnd = hardStart + 1;
+    size_t hardMisses = misses[hardStart];
+    while (hardEnd < triangleCount && misses[hardEnd] < 3) {
+      hardMisses += misses[hardEnd++];
+    }
+    const float runAcmr = static_cast<float>(hardMisses) /
+                          static_cast<float>(hardEnd - hardStart);
+
+    size_t start = hardStart;
+    size_t clusterMisses = 0;
+    clusterStarts.push_back(start);
+    cache.clear();
+    for (size_t t = hardStart; t + 1 < hardEnd; t++) {
+      clusterMisses += cache.transform(indices[t * 3]) +
+                       cache.transform(indices[t * 3 + 1]) +
+                       cache.transform(indices[t * 3 + 2]);
+      if (static_cast<float>(clusterMisses) <=
+          runAcmr * threshold * static_cast<float>(t + 1 - start)) {
+        start = t + 1;
+        clusterMisses = 0;
+        clusterStarts.push_back(start);
+        cache.clear();
+      }
+    }
+    hardStart = hardEnd;
+  }
+  clusterStarts.push_back(triangleCount);
+  const size_t clusterCount = clusterStarts.size() - 1;
+  if (clusterCount < 2) {
+    return;
+  }
+
+  // Clusters facing away from the middle of the mesh are drawn first: on a
+  // convex mesh they are the outside, which hides what comes after
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+  std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+  for (size_t c = 0; c < clusterCount; c++) {
+    float clusterArea = 0.0f;
+    for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+      const glm::vec3 a = position(indices[t * 3]);
+      const glm::vec3 b = position(indices[t * 3 + 1]);
+      const glm::vec3 d = position(indices[t * 3 + 2]);
+      const glm::vec3 normal = glm::cross(b - a, d - a);
+      const float area = glm::length(normal);
+      const glm::vec3 centroid = (a + b + d) * (area / 3.0f);
+      clusterCentroids[c] += centroid;
+      clusterNormals[c] += normal;
+      clusterArea += area;
+      meshCentroid += centroid;
+      meshArea += area;
+    }
+    if (clusterArea > 0.0f) {
+      clusterCentroids[c] /= clusterArea;
+    }
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+
+  std::vector<float> keys(clusterCount);
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++) {
+    const float length = glm::length(clusterNormals[c]);
+    keys[c] = length > 0.0f ? glm::dot(clusterCentroids[c] - meshCentroid,
+                                       clusterNormals[c] / length)
+                            : 0.0f;
+    order[c] = c;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+  std::vector<unsigned int> output;
+  output.reserve(indices.size());
+  for (const size_t c : order) {
+    output.insert(output.end(), indices.begin() + clusterStarts[c] * 3,
+                  indices.begin() + clusterStarts[c + 1] * 3);
+  }
+  indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<unsigned int>& indices,
+                                        std::vector<float>& vertices,
+                                        unsigned int vertexFloats) {
+  const size_t vertexCount = vertices.size() / vertexFloats;
+  std::vector<unsigned int> remap(vertexCount, UNUSED);
+  unsigned int used = 0;
+  for (unsigned int& index : indices) {
+    if (remap[index] == UNUSED) {
+      remap[index] = used++;
+    }
+    index = remap[index];
+  }
+
+  std::vector<float> reordered(size_t(used) * vertexFloats);
+  for (size_t v = 0; v < vertexCount; v++) {
+    if (remap[v] != UNUSED) {
+      std::copy(vertices.begin() + v * vertexFloats,
+                vertices.begin() + (v + 1) * vertexFloats,
+                reordered.begin() + size_t(remap[v]) * vertexFloats);
+    }
+  }
+  vertices.swap(reordered);
+}
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(
+    const std::vector<unsigned int>& indices, size_t vertexCount,
+    unsigned int cacheSize) {
+  VertexCacheStats stats;
+  if (indices.empty()) {
+    return stats;
+  }
+  FifoCache cache(vertexCount, cacheSize);
+  std::vector<uint8_t> referenced(vertexCount, 0);
+  size_t transformed = 0;
+  size_t unique = 0;
+  for (const unsigned int index : indices) {
+    transformed += cache.transform(index);
+    if (!referenced[index]) {
+      referenced[index] = 1;
+      unique++;
+    }
+  }
+  stats.acmr = static_cast<float>(transformed) /
+               static_cast<float>(indices.size() / 3);
+  stats.atvr = static_cast<float>(transformed) / static_cast<float>(unique);
+  return stats;
+}
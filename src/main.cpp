@@ -2,20 +2,37 @@
 
 #include "SolarSystemApp.h"
 
+#include <AppConfig.h>
+#include <core/logging/Logger.h>
+#include <core/memory/AllocationTracker.h>
+
 int main() {
+  if (!AllocationTracker::configureFromEnvironment()) {
+    return AllocationTracker::getCheckExitCode();
+  }
+
+  Logger::start(AppConfig::LOG_FILE_PATH);
+
+  int exitCode = 0;
   try {
     SolarSystemApp app;
     if (!app.initialize()) {
       std::cout << "App initialization failed" << std::endl;
-      return -1;
+      exitCode = -1;
+    } else {
+      app.run();
     }
-
-    app.run();
   } catch (const std::exception& e) {
     std::cerr << "Fatal error: " << e.what() << std::endl;
-    return -1;
+    exitCode = -1;
   }
 
+  // Writes whatever is still queued before the process exits
+  Logger::shutdown();
+
+  if (exitCode != 0) {
+    return exitCode;
+  }
   std::cout << "Application terminated successfully\n";
-  return 0;
-}
\ No newline at end of file
+  return AllocationTracker::getCheckExitCode();
+}
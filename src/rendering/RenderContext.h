@@ -6,16 +6,26 @@
 #define SOLAR_SYSTEM_OPENGL_RENDERCONTEXT_H
 
 #include <core/Camera.h>
-#include <CelestialBodyTypes.h>
+#include <celestialbody/BodyRegistry.h>
+
+class FramePacer;
+class FrustumCuller;
 
 struct RenderContext {
   const Camera& camera;
-  const BodyType& selectedBodyType;
+  const BodyRegistry& bodies;
+  BodyHandle selectedBody;
   unsigned int screenWidth;
   unsigned int screenHeight;
   float currentTime;
   float fps;
   bool canRenderPanel;
+  bool canRenderMemoryPage;
+  const FramePacer& framePacer;
+  bool paused;
+  bool onDemand;
+  // This frame's visible bodies and rings, set before any pass draws
+  const FrustumCuller* culling = nullptr;
 };
 
 #endif  // SOLAR_SYSTEM_OPENGL_RENDERCONTEXT_H
@@ -0,0 +1,16 @@
+#ifndef SOLAR_SYSTEM_OPENGL_SCENE_H
+#define SOLAR_SYSTEM_OPENGL_SCENE_H
+
+class BodyRegistry;
+class Skybox;
+class TextureManager;
+
+// What the scene pass draws: the bodies, the skybox behind them and the
+// texture manager that streams their textures
+struct Scene {
+  const BodyRegistry& bodies;
+  const Skybox* skybox;
+  TextureManager& textureManager;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_SCENE_H
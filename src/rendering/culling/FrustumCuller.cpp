@@ -0,0 +1,272 @@
+#include "FrustumCuller.h"
+
+#include <AppConfig.h>
+#include <celestialbody/BodyComponents.h>
+#include <celestialbody/BodyRegistry.h>
+#include <core/threading/ThreadPool.h>
+#include <rendering/culling/OcclusionCuller.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOLAR_FRUSTUM_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Bodies are unit spheres scaled by their transform
+float boundingRadius(const TransformComponent& transform) {
+  const glm::vec3& scale = transform.scale;
+  return std::max(scale.x, std::max(scale.y, scale.z));
+}
+}  // namespace
+
+FrustumCuller::FrustumCuller() {
+  bool occlusion = AppConfig::OCCLUSION_CULLING;
+  if (const char* value = std::getenv("SOLAR_OCCLUSION_CULLING")) {
+    occlusion = std::atoi(value) != 0;
+  }
+  if (!occlusion) {
+    return;
+  }
+  if (AppConfig::OCCLUSION_CULLING_THREADS > 0) {
+    occlusionPool_ =
+        std::make_unique<ThreadPool>(AppConfig::OCCLUSION_CULLING_THREADS);
+  }
+  occlusion_ = std::make_unique<OcclusionCuller>(
+      AppConfig::OCCLUSION_BUFFER_WIDTH, AppConfig::OCCLUSION_BUFFER_HEIGHT,
+      occlusionPool_.get());
+}
+
+// Out of line: OcclusionCuller and ThreadPool are incomplete in the header
+FrustumCuller::~FrustumCuller() = default;
+
+void FrustumCuller::SphereSet::clear() {
+  x.clear();
+  y.clear();
+  z.clear();
+  radius.clear();
+  visible.clear();
+}
+
+void FrustumCuller::SphereSet::add(const glm::vec3& center, float r) {
+  x.push_back(center.x);
+  y.push_back(center.y);
+  z.push_back(center.z);
+  radius.push_back(r);
+}
+
+void FrustumCuller::cull(const BodyRegistry& bodies, const glm::mat4& view,
+                         const glm::mat4& projection,
+                         unsigned int screenHeight) {
+  frustum_ = extractPlanes(projection * view);
+  const World& world = bodies.getWorld();
+
+  bodySpheres_.clear();
+  bodyCandidates_.clear();
+  world.each<const TransformComponent, const RenderComponent>(
+      [&](Entity entity, const TransformComponent& transform,
+          const RenderComponent& render) {
+        bodySpheres_.add(transform.position, boundingRadius(transform));
+        bodyCandidates_.push_back(
+            {entity, &transform, &render, 0, render.indexCount});
+      });
+
+  ringSpheres_.clear();
+  ringCandidates_.clear();
+  world.each<const TransformComponent, const RingComponent>(
+      [&](Entity entity, const TransformComponent& transform,
+          const RingComponent& ring) {
+        // The ring is a square quad extent wide; its corners are the
+        // furthest points
+        ringSpheres_.add(transform.position, boundingRadius(transform) *
+                                                 ring.extent *
+                                                 0.70710678f);
+        ringCandidates_.push_back({entity, &transform, &ring});
+      });
+
+  cullSpheres(bodySpheres_.x.data(), bodySpheres_.y.data(),
+              bodySpheres_.z.data(), bodySpheres_.radius.data(),
+              bodyCandidates_.size(), frustum_, bodySpheres_.visible);
+  cullSpheres(ringSpheres_.x.data(), ringSpheres_.y.data(),
+              ringSpheres_.z.data(), ringSpheres_.radius.data(),
+              ringCandidates_.size(), frustum_, ringSpheres_.visible);
+  testedCount_ = bodyCandidates_.size() + ringCandidates_.size();
+  occludedCount_ = 0;
+  if (occlusion_) {
+    cullOccluded(view, projection);
+  }
+
+  // A new serial invalidates every mark of the previous cull at once
+  if (++serial_ == 0) {
+    std::fill(visibleSerial_.begin(), visibleSerial_.end(), 0);
+    serial_ = 1;
+  }
+
+  // Projected radius in pixels is radius / distance times this; inside
+  // the sphere it fills the screen
+  const float halfScreen = static_cast<float>(screenHeight) * 0.5f;
+  const float pixelScale = projection[1][1] * halfScreen;
+  visibleBodies_.clear();
+  for (const uint32_t index : bodySpheres_.visible) {
+    VisibleBody& body = visibleBodies_.emplace_back(bodyCandidates_[index]);
+    markVisible(body.entity);
+    const float radius = bodySpheres_.radius[index];
+    const float distance = glm::length(glm::vec3(
+        view * glm::vec4(bodySpheres_.x[index], bodySpheres_.y[index],
+                         bodySpheres_.z[index], 1.0f)));
+    selectLod(body, distance <= radius ? halfScreen
+                                       : radius / distance * pixelScale);
+  }
+  visibleRings_.clear();
+  for (const uint32_t index : ringSpheres_.visible) {
+    visibleRings_.push_back(ringCandidates_[index]);
+    markVisible(ringCandidates_[index].entity);
+  }
+}
+
+void FrustumCuller::cullOccluded(const glm::mat4& view,
+                                 const glm::mat4& projection) {
+  // Rings are mostly see-through and never occlude
+  occlusion_->begin(view, projection);
+  for (const uint32_t index : bodySpheres_.visible) {
+    occlusion_->addOccluder(glm::vec3(bodySpheres_.x[index],
+                                      bodySpheres_.y[index],
+                                      bodySpheres_.z[index]),
+                            bodySpheres_.radius[index]);
+  }
+  occlusion_->rasterize();
+  if (occlusion_->getOccluderCount() == 0) {
+    return;
+  }
+  occludedCount_ =
+      removeOccluded(bodySpheres_) + removeOccluded(ringSpheres_);
+}
+
+size_t FrustumCuller::removeOccluded(SphereSet& spheres) const {
+  // An occluder is never hidden by itself: its far side, which is the
+  // depth it writes, lies behind its near side
+  const auto hidden = [&](uint32_t index) {
+    return occlusion_->isOccluded(
+        glm::vec3(spheres.x[index], spheres.y[index], spheres.z[index]),
+        spheres.radius[index]);
+  };
+  const auto end =
+      std::remove_if(spheres.visible.begin(), spheres.visible.end(), hidden);
+  const size_t removed = static_cast<size_t>(spheres.visible.end() - end);
+  spheres.visible.erase(end, spheres.visible.end());
+  return removed;
+}
+
+bool FrustumCuller::isVisible(Entity body) const {
+  return body.isValid() && body.index < visibleSerial_.size() &&
+         visibleSerial_[body.index] == serial_;
+}
+
+void FrustumCuller::markVisible(Entity body) {
+  if (visibleSerial_.size() <= body.index) {
+    visibleSerial_.resize(body.index + 1, 0);
+  }
+  visibleSerial_[body.index] = serial_;
+}
+
+void FrustumCuller::selectLod(VisibleBody& body, float screenRadius) {
+  const MeshLodChain* lods = body.render->lods;
+  if (!lods || lods->empty()) {
+    return;
+  }
+  if (lodLevel_.size() <= body.entity.index) {
+    // Unseen bodies start coarse and refine straight to what they need
+    lodLevel_.resize(body.entity.index + 1,
+                     static_cast<uint8_t>(lods->size() - 1));
+  }
+  uint8_t& level = lodLevel_[body.entity.index];
+  level = static_cast<uint8_t>(selectMeshLod(
+      *lods, screenRadius, AppConfig::SPHERE_LOD_MAX_ERROR_PIXELS,
+      AppConfig::SPHERE_LOD_HYSTERESIS, level));
+  body.firstIndex = (*lods)[level].firstIndex;
+  body.indexCount = (*lods)[level].indexCount;
+}
+
+SphereBvh::Frustum FrustumCuller::extractPlanes(
+    const glm::mat4& viewProjection) {
+  // Rows of the matrix combined as in Gribb and Hartmann; glm is column
+  // major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+  const auto row = [&viewProjection](int i) {
+    return glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                     viewProjection[2][i], viewProjection[3][i]);
+  };
+  SphereBvh::Frustum frustum = {
+      row(3) + row(0), row(3) - row(0),  // left, right
+      row(3) + row(1), row(3) - row(1),  // bottom, top
+      row(3) + row(2), row(3) - row(2),  // near, far
+  };
+  for (glm::vec4& plane : frustum) {
+    const float length = glm::length(glm::vec3(plane));
+    if (length > 0.0f) {
+      plane /= length;
+    }
+  }
+  return frustum;
+}
+
+void FrustumCuller::cullSpheres(const float* x, const float* y,
+                                const float* z, const float* radius,
+                                size_t count,
+                                const SphereBvh::Frustum& frustum,
+                                std::vector<uint32_t>& visible) {
+  visible.clear();
+  size_t i = 0;
+
+#ifdef SOLAR_FRUSTUM_CULLER_SSE
+  __m128 planeX[6];
+  __m128 planeY[6];
+  __m128 planeZ[6];
+  __m128 planeW[6];
+  for (int p = 0; p < 6; p++) {
+    planeX[p] = _mm_set1_ps(frustum[p].x);
+    planeY[p] = _mm_set1_ps(frustum[p].y);
+    planeZ[p] = _mm_set1_ps(frustum[p].z);
+    planeW[p] = _mm_set1_ps(frustum[p].w);
+  }
+
+  for (; i + 4 <= count; i += 4) {
+    const __m128 cx = _mm_loadu_ps(x + i);
+    const __m128 cy = _mm_loadu_ps(y + i);
+    const __m128 cz = _mm_loadu_ps(z + i);
+    const __m128 negativeRadius =
+        _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+    // Outside as soon as the centre is more than a radius behind a plane
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; p++) {
+      const __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+          _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+    }
+
+    const int mask = _mm_movemask_ps(inside);
+    for (int lane = 0; lane < 4; lane++) {
+      if ((mask & (1 << lane)) != 0) {
+        visible.push_back(static_cast<uint32_t>(i + lane));
+      }
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    bool inside = true;
+    for (int p = 0; p < 6 && inside; p++) {
+      const glm::vec4& plane = frustum[p];
+      inside = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >=
+               -radius[i];
+    }
+    if (inside) {
+      visible.push_back(static_cast<uint32_t>(i));
+    }
+  }
+}
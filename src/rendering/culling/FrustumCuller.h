@@ -0,0 +1,124 @@
+#ifndef SOLAR_SYSTEM_OPENGL_FRUSTUMCULLER_H
+#define SOLAR_SYSTEM_OPENGL_FRUSTUMCULLER_H
+
+#include <core/ecs/World.h>
+#include <core/spatial/SphereBvh.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class BodyRegistry;
+class OcclusionCuller;
+class ThreadPool;
+
+struct RenderComponent;
+struct RingComponent;
+struct TransformComponent;
+
+// Component pointers stay valid for the frame: nothing is added to or
+// removed from the world while it is drawn
+struct VisibleBody {
+  Entity entity;
+  const TransformComponent* transform;
+  const RenderComponent* render;
+  // This frame's level of detail, as a range of the mesh's indices
+  unsigned int firstIndex;
+  unsigned int indexCount;
+};
+
+struct VisibleRing {
+  Entity entity;
+  const TransformComponent* transform;
+  const RingComponent* ring;
+};
+
+// Per-frame visibility: each body's bounding sphere, and separately its
+// ring's, is tested against the six camera frustum planes, and the
+// survivors are listed for the scene, picking and label passes. The
+// spheres are gathered into SoA arrays first so the plane tests run four
+// spheres per SSE instruction. With occlusion culling on, the bodies that
+// survive also occlude: the largest are drawn into an OcclusionCuller and
+// whatever hides behind them is dropped as well. Each visible body then
+// gets the level of detail its size on screen calls for.
+class FrustumCuller {
+ public:
+  FrustumCuller();
+  ~FrustumCuller();
+
+  FrustumCuller(const FrustumCuller&) = delete;
+  FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+  // view and projection as used to draw the scene, on a viewport
+  // screenHeight pixels high
+  void cull(const BodyRegistry& bodies, const glm::mat4& view,
+            const glm::mat4& projection, unsigned int screenHeight);
+
+  const std::vector<VisibleBody>& getVisibleBodies() const {
+    return visibleBodies_;
+  }
+  const std::vector<VisibleRing>& getVisibleRings() const {
+    return visibleRings_;
+  }
+  // Body or ring survived the last cull()
+  bool isVisible(Entity body) const;
+  const SphereBvh::Frustum& getFrustum() const { return frustum_; }
+  // Spheres tested by the last cull()
+  size_t getTestedCount() const { return testedCount_; }
+  // Inside the frustum but hidden behind other bodies, last cull()
+  size_t getOccludedCount() const { return occludedCount_; }
+  // nullptr while occlusion culling is off
+  const OcclusionCuller* getOcclusionCuller() const {
+    return occlusion_.get();
+  }
+
+  // Normalised planes, inside where dot(xyz, p) + w >= 0
+  static SphereBvh::Frustum extractPlanes(const glm::mat4& viewProjection);
+  // Appends the index of every sphere not fully outside a plane
+  static void cullSpheres(const float* x, const float* y, const float* z,
+                          const float* radius, size_t count,
+                          const SphereBvh::Frustum& frustum,
+                          std::vector<uint32_t>& visible);
+
+ private:
+  // Candidates of one pass, reused across frames
+  struct SphereSet {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radius;
+    std::vector<uint32_t> visible;
+
+    void clear();
+    void add(const glm::vec3& center, float r);
+  };
+
+  SphereBvh::Frustum frustum_{};
+  SphereSet bodySpheres_;
+  SphereSet ringSpheres_;
+  std::vector<VisibleBody> bodyCandidates_;
+  std::vector<VisibleRing> ringCandidates_;
+  std::vector<VisibleBody> visibleBodies_;
+  std::vector<VisibleRing> visibleRings_;
+  // Indexed by entity index: the cull() serial that last saw it visible,
+  // and the level of detail it was last drawn at
+  std::vector<uint32_t> visibleSerial_;
+  std::vector<uint8_t> lodLevel_;
+  uint32_t serial_ = 0;
+  size_t testedCount_ = 0;
+  size_t occludedCount_ = 0;
+
+  std::unique_ptr<ThreadPool> occlusionPool_;
+  std::unique_ptr<OcclusionCuller> occlusion_;
+
+  void markVisible(Entity body);
+  void selectLod(VisibleBody& body, float screenRadius);
+  void cullOccluded(const glm::mat4& view, const glm::mat4& projection);
+  // Drops the visible spheres the occluders hide
+  size_t removeOccluded(SphereSet& spheres) const;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_FRUSTUMCULLER_H
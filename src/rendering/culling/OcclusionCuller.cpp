@@ -0,0 +1,229 @@
+#include "OcclusionCuller.h"
+
+#include <core/threading/Latch.h>
+#include <core/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOLAR_OCCLUSION_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr float EMPTY_DEPTH = std::numeric_limits<float>::infinity();
+
+// Pixel index range [begin, end) clamped to [0, size]
+int clampToPixels(float value, unsigned int size) {
+  return static_cast<int>(
+      std::min(std::max(value, 0.0f), static_cast<float>(size)));
+}
+}  // namespace
+
+OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height,
+                                 ThreadPool* pool)
+    : width_(std::max(width, 1u)), height_(std::max(height, 1u)),
+      pool_(pool) {
+  unsigned int levelWidth = width_;
+  unsigned int levelHeight = height_;
+  while (true) {
+    levels_.push_back({levelWidth, levelHeight,
+                       std::vector<float>(levelWidth * levelHeight,
+                                          EMPTY_DEPTH)});
+    if (levelWidth == 1 && levelHeight == 1) {
+      break;
+    }
+    levelWidth = std::max(1u, (levelWidth + 1) / 2);
+    levelHeight = std::max(1u, (levelHeight + 1) / 2);
+  }
+}
+
+void OcclusionCuller::begin(const glm::mat4& view,
+                            const glm::mat4& projection) {
+  view_ = view;
+  scaleX_ = projection[0][0] * 0.5f * static_cast<float>(width_);
+  scaleY_ = projection[1][1] * 0.5f * static_cast<float>(height_);
+  // glm::perspective: [2][2] = -(f + n) / (f - n), [3][2] = -2fn / (f - n)
+  near_ = projection[3][2] / (projection[2][2] - 1.0f);
+  occluders_.clear();
+}
+
+void OcclusionCuller::addOccluder(const glm::vec3& center, float radius) {
+  const glm::vec4 viewPosition = view_ * glm::vec4(center, 1.0f);
+  const float depth = -viewPosition.z;
+  if (depth - radius <= near_) {
+    return;
+  }
+
+  const float radiusX = radius / depth * scaleX_;
+  const float radiusY = radius / depth * scaleY_;
+  if (std::min(radiusX, radiusY) < MIN_OCCLUDER_PIXELS) {
+    return;
+  }
+  occluders_.push_back(
+      {viewPosition.x / depth * scaleX_ + static_cast<float>(width_) * 0.5f,
+       viewPosition.y / depth * scaleY_ + static_cast<float>(height_) * 0.5f,
+       radiusX, radiusY, depth + radius});
+}
+
+void OcclusionCuller::rasterize() {
+  if (occluders_.empty()) {
+    return;
+  }
+  if (occluders_.size() > MAX_OCCLUDERS) {
+    std::nth_element(occluders_.begin(), occluders_.begin() + MAX_OCCLUDERS,
+                     occluders_.end(),
+                     [](const Occluder& a, const Occluder& b) {
+                       return a.radiusX > b.radiusX;
+                     });
+    occluders_.resize(MAX_OCCLUDERS);
+  }
+
+  const unsigned int bands =
+      pool_ ? std::min<unsigned int>(
+                  static_cast<unsigned int>(pool_->getThreadCount()) + 1,
+                  height_)
+            : 1;
+  if (bands <= 1) {
+    rasterizeRows(0, height_);
+  } else {
+    // The calling thread takes the first band instead of idling
+    Latch latch(bands - 1);
+    for (unsigned int band = 1; band < bands; band++) {
+      pool_->submit([this, &latch, band, bands] {
+        rasterizeRows(height_ * band / bands, height_ * (band + 1) / bands);
+        latch.countDown();
+      });
+    }
+    rasterizeRows(0, height_ / bands);
+    latch.wait();
+  }
+  buildPyramid();
+}
+
+void OcclusionCuller::rasterizeRows(unsigned int begin, unsigned int end) {
+  std::vector<float>& depth = levels_[0].depth;
+  std::fill(depth.begin() + begin * width_, depth.begin() + end * width_,
+            EMPTY_DEPTH);
+
+  for (const Occluder& occluder : occluders_) {
+    const int firstRow = std::max(
+        static_cast<int>(begin),
+        clampToPixels(std::floor(occluder.y - occluder.radiusY), height_));
+    const int lastRow = std::min(
+        static_cast<int>(end),
+        clampToPixels(std::ceil(occluder.y + occluder.radiusY), height_));
+    const float inverseRadiusY = 1.0f / occluder.radiusY;
+
+    for (int row = firstRow; row < lastRow; row++) {
+      // A pixel is written only if the disc covers all of it: the span
+      // the disc covers across the whole row is the narrower of the spans
+      // along the row's two edges
+      const float bottom = (static_cast<float>(row) - occluder.y) *
+                           inverseRadiusY;
+      const float top = bottom + inverseRadiusY;
+      const float edge = std::max(bottom * bottom, top * top);
+      if (edge >= 1.0f) {
+        continue;
+      }
+      const float half = occluder.radiusX * std::sqrt(1.0f - edge);
+      int x = clampToPixels(std::ceil(occluder.x - half), width_);
+      const int spanEnd = clampToPixels(std::floor(occluder.x + half), width_);
+
+      float* pixels = depth.data() + static_cast<size_t>(row) * width_;
+#ifdef SOLAR_OCCLUSION_CULLER_SSE
+      const __m128 occluderDepth = _mm_set1_ps(occluder.depth);
+      for (; x + 4 <= spanEnd; x += 4) {
+        _mm_storeu_ps(pixels + x,
+                      _mm_min_ps(_mm_loadu_ps(pixels + x), occluderDepth));
+      }
+#endif
+      for (; x < spanEnd; x++) {
+        pixels[x] = std::min(pixels[x], occluder.depth);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::buildPyramid() {
+  for (size_t i = 1; i < levels_.size(); i++) {
+    const Level& source = levels_[i - 1];
+    Level& level = levels_[i];
+    for (unsigned int y = 0; y < level.height; y++) {
+      // Odd sizes: the last texel covers the one source row or column left
+      const unsigned int y0 = 2 * y;
+      const unsigned int y1 = std::min(y0 + 1, source.height - 1);
+      for (unsigned int x = 0; x < level.width; x++) {
+        const unsigned int x0 = 2 * x;
+        const unsigned int x1 = std::min(x0 + 1, source.width - 1);
+        level.depth[y * level.width + x] =
+            std::max(std::max(source.depth[y0 * source.width + x0],
+                              source.depth[y0 * source.width + x1]),
+                     std::max(source.depth[y1 * source.width + x0],
+                              source.depth[y1 * source.width + x1]));
+      }
+    }
+  }
+}
+
+bool OcclusionCuller::isOccluded(const glm::vec3& center,
+                                 float radius) const {
+  if (occluders_.empty()) {
+    return false;
+  }
+  const glm::vec4 viewPosition = view_ * glm::vec4(center, 1.0f);
+  const float depth = -viewPosition.z;
+  const float nearest = depth - radius;
+  if (nearest <= near_) {
+    return false;
+  }
+
+  // Screen bounds of the view-space box around the sphere: x / z is
+  // largest at the box's largest x, over its nearest z when that x is
+  // positive and its farthest z otherwise
+  const float farthest = depth + radius;
+  const auto bounds = [&](float coordinate, float& low, float& high) {
+    const float lowEdge = coordinate - radius;
+    const float highEdge = coordinate + radius;
+    low = lowEdge / (lowEdge <= 0.0f ? nearest : farthest);
+    high = highEdge / (highEdge >= 0.0f ? nearest : farthest);
+  };
+  float lowX, highX, lowY, highY;
+  bounds(viewPosition.x, lowX, highX);
+  bounds(viewPosition.y, lowY, highY);
+
+  const float halfWidth = static_cast<float>(width_) * 0.5f;
+  const float halfHeight = static_cast<float>(height_) * 0.5f;
+  const int x0 = clampToPixels(std::floor(lowX * scaleX_ + halfWidth), width_);
+  const int x1 =
+      clampToPixels(std::floor(highX * scaleX_ + halfWidth) + 1.0f, width_);
+  const int y0 =
+      clampToPixels(std::floor(lowY * scaleY_ + halfHeight), height_);
+  const int y1 =
+      clampToPixels(std::floor(highY * scaleY_ + halfHeight) + 1.0f, height_);
+  if (x0 >= x1 || y0 >= y1) {
+    // Off the buffer; frustum culling decides
+    return false;
+  }
+
+  // The coarsest level where the rectangle spans at most 4x4 texels
+  size_t level = 0;
+  while (level + 1 < levels_.size() &&
+         (((x1 - 1) >> level) - (x0 >> level) >= 4 ||
+          ((y1 - 1) >> level) - (y0 >> level) >= 4)) {
+    level++;
+  }
+
+  const Level& texels = levels_[level];
+  for (int y = y0 >> level; y <= (y1 - 1) >> level; y++) {
+    for (int x = x0 >> level; x <= (x1 - 1) >> level; x++) {
+      if (texels.depth[y * texels.width + x] >= nearest) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
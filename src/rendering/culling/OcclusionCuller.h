@@ -0,0 +1,83 @@
+#ifndef SOLAR_SYSTEM_OPENGL_OCCLUSIONCULLER_H
+#define SOLAR_SYSTEM_OPENGL_OCCLUSIONCULLER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class ThreadPool;
+
+// Software occlusion culling against a small depth buffer on the CPU.
+//
+// Large spheres are drawn as occluders: each covers the disc its cross
+// section through the centre projects to (always inside the sphere's
+// silhouette) at the depth of its far side, so the buffer never claims
+// more than the spheres hide. A max-depth pyramid over the buffer then
+// answers whether everything a sphere could cover lies behind occluders,
+// testing at most 4x4 texels per sphere. Depths are linear view-space
+// distances; the projection must be a symmetric perspective one.
+//
+// Rows are split into bands rasterised on a ThreadPool in parallel, each
+// band walking every occluder, so no two threads write the same pixel.
+class OcclusionCuller {
+ public:
+  // pool may be null: rasterise on the calling thread
+  OcclusionCuller(unsigned int width, unsigned int height, ThreadPool* pool);
+
+  OcclusionCuller(const OcclusionCuller&) = delete;
+  OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+  // Starts a frame with the scene camera; drops the previous occluders
+  void begin(const glm::mat4& view, const glm::mat4& projection);
+  // Candidates smaller than MIN_OCCLUDER_PIXELS, or crossing the near
+  // plane, are ignored; only the largest MAX_OCCLUDERS are drawn
+  void addOccluder(const glm::vec3& center, float radius);
+  // Draws the occluders and builds the depth pyramid
+  void rasterize();
+  // Hidden behind the occluders everywhere it could appear on screen
+  bool isOccluded(const glm::vec3& center, float radius) const;
+
+  size_t getOccluderCount() const { return occluders_.size(); }
+  unsigned int getWidth() const { return width_; }
+  unsigned int getHeight() const { return height_; }
+  // Level 0 is the full buffer, width() x height() floats, row 0 at the
+  // bottom; uncovered texels hold infinity
+  const std::vector<float>& getDepth() const { return levels_[0].depth; }
+
+ private:
+  // In buffer pixels; below this an occluder hides almost nothing
+  static constexpr float MIN_OCCLUDER_PIXELS = 4.0f;
+  static constexpr size_t MAX_OCCLUDERS = 64;
+
+  struct Occluder {
+    float x;  // projected centre, buffer pixels
+    float y;
+    float radiusX;  // semi-axes of the projected cross section
+    float radiusY;
+    float depth;  // of the far side
+  };
+
+  struct Level {
+    unsigned int width;
+    unsigned int height;
+    std::vector<float> depth;
+  };
+
+  unsigned int width_;
+  unsigned int height_;
+  ThreadPool* pool_;
+  std::vector<Level> levels_;
+  std::vector<Occluder> occluders_;
+
+  glm::mat4 view_{1.0f};
+  // Projection scale (focal lengths) in buffer pixels
+  float scaleX_ = 1.0f;
+  float scaleY_ = 1.0f;
+  float near_ = 0.1f;
+
+  void rasterizeRows(unsigned int begin, unsigned int end);
+  void buildPyramid();
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_OCCLUSIONCULLER_H
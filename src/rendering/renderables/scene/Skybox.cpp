@@ -1,31 +1,34 @@
 #include "Skybox.h"
 
 #include <core/Shader.h>
+#include <core/ShaderManager.h>
 #include <graphics/buffer/BufferManager.h>
 
 #include <iostream>
 
 #include <AppConfig.h>
 
-Skybox::Skybox(BufferManager& bufferManager, TextureManager& textureManager)
+Skybox::Skybox(BufferManager& bufferManager, TextureManager& textureManager,
+               ShaderManager& shaderManager)
     : textureManager_(textureManager),
       bufferManager_(bufferManager),
-      m_textureID(0),
+      shaderManager_(shaderManager),
       m_indexCount(0),
       m_enabled(true) {
   std::cout << "\n=== SKYBOX CREATION ===" << std::endl;
 
   try {
-    m_shader = std::make_unique<Shader>("../shaders/skybox.vert",
-                                        "../shaders/skybox.frag");
+    m_shader = shaderManager_.load("../shaders/skybox.vert",
+                                   "../shaders/skybox.frag");
 
-    if (m_shader == nullptr) {
+    if (!m_shader.isValid()) {
       std::cerr << "SKYBOX CREATION ERROR: failed to create shader" << std::endl;
     }
 
-    this->m_textureID = textureManager_.createCubemap(AppConfig::SKYBOX_FACES);
+    this->m_texture = textureManager_.createCubemap(AppConfig::SKYBOX_FACES,
+                                                    AppConfig::SKYBOX_BAKED);
 
-    if (m_textureID == 0) {
+    if (textureManager_.getGLTexture(m_texture) == 0) {
       std::cerr << "ERROR: Failed to create cubemap texture" << std::endl;
       return;
     }
@@ -91,27 +94,32 @@ Skybox::Skybox(BufferManager& bufferManager, TextureManager& textureManager)
   }
 }
 
-void Skybox::render(const glm::mat4 model, const glm::mat4 view,
-                    const glm::mat4 projection) const {
-  if (!m_enabled) {
+Skybox::~Skybox() {
+  textureManager_.releaseTexture(m_texture);
+  shaderManager_.release(m_shader);
+}
+
+void Skybox::render(const glm::mat4& view, const glm::mat4& projection) const {
+  const Shader* shader = shaderManager_.get(m_shader);
+  if (!m_enabled || !shader) {
     return;
   }
 
   glDepthMask(GL_FALSE);
   glDepthFunc(GL_LEQUAL);  // Change depth function
 
-  m_shader->use();
+  shader->use();
   glBindVertexArray(bufferHandle_.getVAO());
 
   // Remove translation from view matrix - this is the key!
   const auto skyboxView =
       glm::mat4(glm::mat3(view));  // Convert to mat3 then back to mat4
 
-  m_shader->setMat4("view", skyboxView);
-  m_shader->setMat4("projection", projection);
-  m_shader->setInt("skybox", 0);
+  shader->setMat4("view", skyboxView);
+  shader->setMat4("projection", projection);
+  shader->setInt("skybox", 0);
 
-  glBindTexture(GL_TEXTURE_CUBE_MAP, m_textureID);
+  glBindTexture(GL_TEXTURE_CUBE_MAP, textureManager_.getGLTexture(m_texture));
   glDrawArrays(GL_TRIANGLES, 0, 36);
 
   glDepthFunc(GL_LESS);  // Reset depth function
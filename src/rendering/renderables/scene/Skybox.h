@@ -1,31 +1,31 @@
 #ifndef SKYBOX_H
 #define SKYBOX_H
 
-#include <rendering/renderables/scene/ISceneRenderable.h>
-
 #include <glm/glm.hpp>
-#include <memory>
 
+#include <core/resources/Handle.h>
 #include <core/texturing/TextureManager.h>
 #include <graphics/buffer/BufferHandle.h>
 
-class Shader;
+class ShaderManager;
 
-class Skybox : public ISceneRenderable {
+class Skybox {
  public:
-  Skybox(BufferManager& bufferManager, TextureManager& textureManager);
-  ~Skybox() override = default;
+  Skybox(BufferManager& bufferManager, TextureManager& textureManager,
+         ShaderManager& shaderManager);
+  ~Skybox();
 
-  void render(glm::mat4 model, glm::mat4 view, glm::mat4 projection) const override;
+  void render(const glm::mat4& view, const glm::mat4& projection) const;
 
  private:
   BufferManager& bufferManager_;
   BufferHandle bufferHandle_;
   TextureManager& textureManager_;
+  ShaderManager& shaderManager_;
 
-  unsigned int m_textureID;
+  TextureHandle m_texture;
 
-  std::unique_ptr<Shader> m_shader;
+  ProgramHandle m_shader;
 
   unsigned int m_indexCount;
 
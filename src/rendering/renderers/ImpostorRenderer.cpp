@@ -0,0 +1,149 @@
+#include "ImpostorRenderer.h"
+
+#include <core/Shader.h>
+#include <core/ShaderManager.h>
+#include <core/memory/MemoryTracker.h>
+#include <core/resources/GpuDeletionQueue.h>
+#include <utils/debug_utils.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "glad/glad.h"
+
+namespace {
+// Triangle strip over the quad
+constexpr float QUAD_CORNERS[] = {-1.0f, -1.0f, 1.0f, -1.0f,
+                                  -1.0f, 1.0f,  1.0f, 1.0f};
+}  // namespace
+
+ImpostorRenderer::ImpostorRenderer(ShaderManager& shaderManager)
+    : shaderManager_(shaderManager),
+      shader_(shaderManager.load("../shaders/impostor.vert",
+                                 "../shaders/impostor.frag")) {
+  GL_CHECK(glGenVertexArrays(1, &vao_));
+  GL_CHECK(glGenBuffers(1, &cornerBuffer_));
+  GL_CHECK(glGenBuffers(1, &instanceBuffer_));
+
+  GL_CHECK(glBindVertexArray(vao_));
+  GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, cornerBuffer_));
+  GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD_CORNERS), QUAD_CORNERS,
+                        GL_STATIC_DRAW));
+  GL_CHECK(glEnableVertexAttribArray(0));
+  GL_CHECK(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                                 (void*)0));
+
+  // Pointed at each batch's first instance by bindInstances()
+  GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_));
+  GL_CHECK(glEnableVertexAttribArray(1));
+  GL_CHECK(glVertexAttribDivisor(1, 1));
+  GL_CHECK(glEnableVertexAttribArray(2));
+  GL_CHECK(glVertexAttribDivisor(2, 1));
+  GL_CHECK(glBindVertexArray(0));
+  GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+  MemoryTracker::allocate(MemoryCategory::Meshes, MemoryDomain::GPU,
+                          sizeof(QUAD_CORNERS));
+}
+
+ImpostorRenderer::~ImpostorRenderer() {
+  MemoryTracker::release(MemoryCategory::Meshes, MemoryDomain::GPU,
+                         sizeof(QUAD_CORNERS));
+  MemoryTracker::release(MemoryCategory::StreamingBuffers, MemoryDomain::GPU,
+                         instanceCapacity_ * sizeof(Instance));
+  GpuDeletionQueue::deleteVertexArray(vao_);
+  GpuDeletionQueue::deleteBuffer(cornerBuffer_);
+  GpuDeletionQueue::deleteBuffer(instanceBuffer_);
+  shaderManager_.release(shader_);
+}
+
+void ImpostorRenderer::add(const glm::vec3& center, float radius,
+                           const glm::quat& rotation, unsigned int texture) {
+  const glm::quat inverse = glm::conjugate(rotation);
+  items_.push_back({texture,
+                    {glm::vec4(center, radius),
+                     glm::vec4(inverse.x, inverse.y, inverse.z, inverse.w)}});
+}
+
+void ImpostorRenderer::flush(const glm::mat4& view,
+                             const glm::mat4& projection) {
+  const Shader* shader = shaderManager_.get(shader_);
+  if (items_.empty() || !shader) {
+    items_.clear();
+    return;
+  }
+
+  // Same texture, same draw
+  std::sort(items_.begin(), items_.end(),
+            [](const Item& a, const Item& b) { return a.texture < b.texture; });
+  upload();
+
+  shader->use();
+  shader->setMat4("view", view);
+  shader->setMat4("projection", projection);
+  // The view matrix is a rigid transform, so its inverse rotation is the
+  // transpose
+  shader->setMat3("inverseView", glm::transpose(glm::mat3(view)));
+  shader->setInt("bodyTexture", 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindVertexArray(vao_);
+
+  // GL 3.3 has no base instance, so each batch re-points the instance
+  // attributes at its first sphere instead
+  size_t first = 0;
+  while (first < items_.size()) {
+    const unsigned int texture = items_[first].texture;
+    size_t end = first + 1;
+    while (end < items_.size() && items_[end].texture == texture) {
+      end++;
+    }
+    bindInstances(first);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                          static_cast<GLsizei>(end - first));
+    first = end;
+  }
+  glBindVertexArray(0);
+
+  items_.clear();
+}
+
+void ImpostorRenderer::upload() {
+  instances_.clear();
+  for (const Item& item : items_) {
+    instances_.push_back(item.instance);
+  }
+
+  GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_));
+  if (instances_.size() > instanceCapacity_) {
+    // Grown in powers of two, so a growing catalogue reallocates rarely
+    size_t capacity = std::max<size_t>(instanceCapacity_, 64);
+    while (capacity < instances_.size()) {
+      capacity *= 2;
+    }
+    MemoryTracker::resize(MemoryCategory::StreamingBuffers, MemoryDomain::GPU,
+                          instanceCapacity_ * sizeof(Instance),
+                          capacity * sizeof(Instance));
+    instanceCapacity_ = capacity;
+  }
+  // Orphaned every frame: the driver hands out fresh storage instead of
+  // waiting for last frame's draws to finish reading it
+  GL_CHECK(glBufferData(GL_ARRAY_BUFFER, instanceCapacity_ * sizeof(Instance),
+                        nullptr, GL_STREAM_DRAW));
+  GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0,
+                           instances_.size() * sizeof(Instance),
+                           instances_.data()));
+  GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void ImpostorRenderer::bindInstances(size_t first) const {
+  const uintptr_t offset = first * sizeof(Instance);
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+  glVertexAttribPointer(
+      1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+      reinterpret_cast<const void*>(offset + offsetof(Instance, sphere)));
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                        reinterpret_cast<const void*>(
+                            offset + offsetof(Instance, inverseRotation)));
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
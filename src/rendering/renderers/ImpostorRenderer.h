@@ -0,0 +1,62 @@
+#ifndef SOLAR_SYSTEM_OPENGL_IMPOSTORRENDERER_H
+#define SOLAR_SYSTEM_OPENGL_IMPOSTORRENDERER_H
+
+#include <core/resources/Handle.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+class ShaderManager;
+
+// Draws spheres as ray-cast impostors: each is one instanced quad facing
+// the eye, and the fragment shader intersects the sphere analytically for
+// its depth and texture coordinates. A sphere costs four vertices however
+// close it is, so small and distant bodies come out pixel exact without a
+// mesh. Spheres are batched per texture, one instanced draw each.
+class ImpostorRenderer {
+ public:
+  explicit ImpostorRenderer(ShaderManager& shaderManager);
+  ~ImpostorRenderer();
+
+  ImpostorRenderer(const ImpostorRenderer&) = delete;
+  ImpostorRenderer& operator=(const ImpostorRenderer&) = delete;
+
+  // Queues a sphere for the next flush(); rotation is the body's model
+  // rotation, texture a GL texture mapped like the sphere meshes
+  void add(const glm::vec3& center, float radius, const glm::quat& rotation,
+           unsigned int texture);
+  // Draws everything queued, depth tested and written, then clears it
+  void flush(const glm::mat4& view, const glm::mat4& projection);
+  // False if the shader failed; draw meshes instead
+  bool isAvailable() const { return shader_.isValid(); }
+
+ private:
+  // Per-instance vertex data, attributes 1 and 2
+  struct Instance {
+    glm::vec4 sphere;           // world centre, radius
+    glm::vec4 inverseRotation;  // x, y, z, w
+  };
+
+  struct Item {
+    unsigned int texture;
+    Instance instance;
+  };
+
+  ShaderManager& shaderManager_;
+  ProgramHandle shader_;
+  unsigned int vao_ = 0;
+  unsigned int cornerBuffer_ = 0;
+  unsigned int instanceBuffer_ = 0;
+  size_t instanceCapacity_ = 0;
+  // Reused across frames
+  std::vector<Item> items_;
+  std::vector<Instance> instances_;
+
+  void upload();
+  void bindInstances(size_t first) const;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_IMPOSTORRENDERER_H
@@ -0,0 +1,266 @@
+#include "PickingRenderer.h"
+
+#include <AppConfig.h>
+#include <celestialbody/BodyComponents.h>
+#include <core/Shader.h>
+#include <core/ShaderManager.h>
+#include <core/logging/Logger.h>
+#include <core/resources/GpuDeletionQueue.h>
+#include <core/texturing/TextureManager.h>
+#include <rendering/RenderContext.h>
+#include <rendering/Scene.h>
+#include <rendering/culling/FrustumCuller.h>
+#include <rendering/renderers/SceneRenderer.h>
+#include <utils/debug_utils.h>
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace {
+// Two unsigned ints per pixel: handle index + 1 and generation
+constexpr size_t ID_PIXEL_BYTES = 2 * sizeof(GLuint);
+}  // namespace
+
+PickingRenderer::PickingRenderer(ShaderManager& shaderManager)
+    : shaderManager_(shaderManager),
+      shader_(shaderManager.load("../shaders/object.vert",
+                                 "../shaders/picking.frag")),
+      regionSize_(AppConfig::GPU_PICKING_REGION),
+      readback_(regionSize_ * regionSize_ * 2) {
+  const GLsizei size = static_cast<GLsizei>(regionSize_);
+
+  GL_CHECK(glGenTextures(1, &idTexture_));
+  GL_CHECK(glBindTexture(GL_TEXTURE_2D, idTexture_));
+  GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, size, size, 0,
+                        GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr));
+  GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+
+  GL_CHECK(glGenTextures(1, &depthTexture_));
+  GL_CHECK(glBindTexture(GL_TEXTURE_2D, depthTexture_));
+  GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0,
+                        GL_DEPTH_COMPONENT, GL_FLOAT, nullptr));
+  GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
+
+  GL_CHECK(glGenFramebuffers(1, &framebuffer_));
+  GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_));
+  GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                  GL_TEXTURE_2D, idTexture_, 0));
+  GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                                  GL_TEXTURE_2D, depthTexture_, 0));
+  const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    LOG_ERROR("Picking framebuffer incomplete (0x%x), GPU picking disabled",
+              status);
+    GpuDeletionQueue::deleteFramebuffer(framebuffer_);
+    framebuffer_ = 0;
+  }
+
+  for (Slot& slot : slots_) {
+    GL_CHECK(glGenBuffers(1, &slot.pixelBuffer));
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer));
+    GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER,
+                          regionSize_ * regionSize_ * ID_PIXEL_BYTES, nullptr,
+                          GL_STREAM_READ));
+  }
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+}
+
+PickingRenderer::~PickingRenderer() {
+  for (Slot& slot : slots_) {
+    if (slot.fence) {
+      glDeleteSync(static_cast<GLsync>(slot.fence));
+    }
+    GpuDeletionQueue::deleteBuffer(slot.pixelBuffer);
+  }
+  GpuDeletionQueue::deleteFramebuffer(framebuffer_);
+  GpuDeletionQueue::deleteTexture(idTexture_);
+  GpuDeletionQueue::deleteTexture(depthTexture_);
+  shaderManager_.release(shader_);
+}
+
+void PickingRenderer::requestPick(unsigned int x, unsigned int y,
+                                  Callback callback) {
+  request_ = {x, y, std::move(callback)};
+  hasRequest_ = true;
+}
+
+void PickingRenderer::render(const Scene& scene,
+                             const RenderContext& context) {
+  // Only readbacks fenced in earlier frames can be done by now
+  collectReadbacks(scene);
+  if (hasRequest_ && isAvailable()) {
+    drawRegion(scene, context);
+  }
+}
+
+bool PickingRenderer::hasPendingWork() const {
+  if (hasRequest_) {
+    return true;
+  }
+  for (const Slot& slot : slots_) {
+    if (slot.fence) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PickingRenderer::isAvailable() const {
+  return framebuffer_ != 0 && shader_.isValid();
+}
+
+void PickingRenderer::drawRegion(const Scene& scene,
+                                 const RenderContext& context) {
+  Slot& slot = slots_[nextSlot_];
+  if (slot.fence) {
+    // Every readback still in flight; the request waits a frame
+    return;
+  }
+  const Shader* shader = shaderManager_.get(shader_);
+  if (!shader) {
+    return;
+  }
+
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_));
+  GL_CHECK(glViewport(0, 0, static_cast<GLsizei>(regionSize_),
+                      static_cast<GLsizei>(regionSize_)));
+  const GLuint background[4] = {0, 0, 0, 0};
+  const GLfloat farDepth = 1.0f;
+  glDepthMask(GL_TRUE);
+  GL_CHECK(glClearBufferuiv(GL_COLOR, 0, background));
+  GL_CHECK(glClearBufferfv(GL_DEPTH, 0, &farDepth));
+
+  // Stretches the region around the pick point over the whole target, the
+  // way gluPickMatrix does
+  const float size = static_cast<float>(regionSize_);
+  const float width = static_cast<float>(context.screenWidth);
+  const float height = static_cast<float>(context.screenHeight);
+  const float left = static_cast<float>(request_.x) - size * 0.5f + 0.5f;
+  const float bottom = static_cast<float>(request_.y) - size * 0.5f + 0.5f;
+  glm::mat4 pick = glm::translate(
+      glm::mat4(1.0f), glm::vec3((width - 2.0f * left) / size - 1.0f,
+                                 (height - 2.0f * bottom) / size - 1.0f,
+                                 0.0f));
+  pick = glm::scale(pick, glm::vec3(width / size, height / size, 1.0f));
+
+  shader->use();
+  shader->setMat4("view", context.camera.getViewMatrix());
+  shader->setMat4("projection",
+                  pick * SceneRenderer::calculateProjection(context));
+  shader->setInt("alphaTexture", 0);
+  glActiveTexture(GL_TEXTURE0);
+
+  // The region lies on screen, so what the frustum culled cannot be in it
+  shader->setBool("alphaTest", false);
+  for (const VisibleBody& body : context.culling->getVisibleBodies()) {
+    shader->setMat4("model", SceneRenderer::calculateModelMatrix(
+                                 *body.transform, context.currentTime));
+    shader->setUVec2("bodyId", body.entity.index + 1, body.entity.generation);
+    glBindVertexArray(body.render->vao);
+    glDrawElements(GL_TRIANGLES, body.indexCount, GL_UNSIGNED_INT,
+                   reinterpret_cast<const void*>(body.firstIndex *
+                                                 sizeof(unsigned int)));
+  }
+
+  // Rings pick their planet, from both sides and only where they are drawn
+  const bool cullFaceWasEnabled = glIsEnabled(GL_CULL_FACE);
+  if (cullFaceWasEnabled) {
+    glDisable(GL_CULL_FACE);
+  }
+  shader->setBool("alphaTest", true);
+  for (const VisibleRing& body : context.culling->getVisibleRings()) {
+    shader->setMat4("model", SceneRenderer::calculateModelMatrix(
+                                 *body.transform, context.currentTime));
+    shader->setUVec2("bodyId", body.entity.index + 1, body.entity.generation);
+    glBindTexture(GL_TEXTURE_2D,
+                  scene.textureManager.getGLTexture(body.ring->texture));
+    glBindVertexArray(body.ring->vao);
+    glDrawElements(GL_TRIANGLES, body.ring->indexCount, GL_UNSIGNED_INT, 0);
+  }
+  if (cullFaceWasEnabled) {
+    glEnable(GL_CULL_FACE);
+  }
+  glBindVertexArray(0);
+
+  // Into the pixel buffer: the call returns without waiting for the draws
+  GL_CHECK(glReadBuffer(GL_COLOR_ATTACHMENT0));
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer));
+  GL_CHECK(glReadPixels(0, 0, static_cast<GLsizei>(regionSize_),
+                        static_cast<GLsizei>(regionSize_), GL_RG_INTEGER,
+                        GL_UNSIGNED_INT, nullptr));
+  GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.callback = std::move(request_.callback);
+  hasRequest_ = false;
+  nextSlot_ = (nextSlot_ + 1) % SLOT_COUNT;
+
+  GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+  GL_CHECK(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+}
+
+void PickingRenderer::collectReadbacks(const Scene& scene) {
+  // Fences pass in submission order, stop at the first one still busy
+  for (int i = 0; i < SLOT_COUNT; i++) {
+    Slot& slot = slots_[(nextSlot_ + i) % SLOT_COUNT];
+    if (!slot.fence) {
+      continue;
+    }
+    const GLsync fence = static_cast<GLsync>(slot.fence);
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+      break;
+    }
+    glDeleteSync(fence);
+    slot.fence = nullptr;
+
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer));
+    const size_t bytes = readback_.size() * sizeof(unsigned int);
+    const void* mapped =
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    BodyHandle body;
+    if (mapped) {
+      std::memcpy(readback_.data(), mapped, bytes);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      body = decode(readback_.data(), scene);
+    }
+    GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+    // The callback may request the next pick
+    Callback callback = std::move(slot.callback);
+    slot.callback = nullptr;
+    if (callback) {
+      callback(body);
+    }
+  }
+}
+
+BodyHandle PickingRenderer::decode(const unsigned int* ids,
+                                   const Scene& scene) const {
+  // The body nearest the centre of the region, so small or distant bodies
+  // can be picked within a few pixels
+  const int center = static_cast<int>(regionSize_ / 2);
+  int bestDistance = std::numeric_limits<int>::max();
+  BodyHandle best;
+  for (int y = 0; y < static_cast<int>(regionSize_); y++) {
+    for (int x = 0; x < static_cast<int>(regionSize_); x++) {
+      const unsigned int* pixel = ids + 2 * (y * regionSize_ + x);
+      const int distance =
+          (x - center) * (x - center) + (y - center) * (y - center);
+      if (pixel[0] == 0 || distance >= bestDistance) {
+        continue;
+      }
+      bestDistance = distance;
+      best = {pixel[0] - 1, pixel[1]};
+    }
+  }
+  // The body may have been removed while the readback was in flight
+  return scene.bodies.isValid(best) ? best : BodyHandle{};
+}
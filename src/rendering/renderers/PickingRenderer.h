@@ -0,0 +1,77 @@
+#ifndef SOLAR_SYSTEM_OPENGL_PICKINGRENDERER_H
+#define SOLAR_SYSTEM_OPENGL_PICKINGRENDERER_H
+
+#include <celestialbody/BodyRegistry.h>
+#include <core/resources/Handle.h>
+
+#include <functional>
+#include <vector>
+
+class ShaderManager;
+
+struct RenderContext;
+struct Scene;
+
+// Picks what is actually on screen: the bodies (and their rings) are drawn
+// again with their handles as colour into a small integer target covering
+// only the pixels around the pick point. The result is copied into a pixel
+// buffer and read back once its fence has passed, a frame or two later, so
+// the CPU never waits for the GPU.
+class PickingRenderer {
+ public:
+  // Invalid handle when nothing was under the pick point
+  using Callback = std::function<void(BodyHandle)>;
+
+  explicit PickingRenderer(ShaderManager& shaderManager);
+  ~PickingRenderer();
+
+  PickingRenderer(const PickingRenderer&) = delete;
+  PickingRenderer& operator=(const PickingRenderer&) = delete;
+
+  // Picks around window pixel (x, y), origin bottom left. A newer request
+  // replaces one that has not been drawn yet.
+  void requestPick(unsigned int x, unsigned int y, Callback callback);
+  // Once per drawn frame, after the scene: draws the pending request and
+  // hands finished readbacks to their callbacks
+  void render(const Scene& scene, const RenderContext& context);
+  // Requests not yet delivered; frames must keep coming until they are
+  bool hasPendingWork() const;
+  // False if the ID target could not be created; pick on the CPU instead
+  bool isAvailable() const;
+
+ private:
+  // Readbacks in flight at once
+  static constexpr int SLOT_COUNT = 3;
+
+  struct Request {
+    unsigned int x = 0;
+    unsigned int y = 0;
+    Callback callback;
+  };
+
+  struct Slot {
+    unsigned int pixelBuffer = 0;
+    void* fence = nullptr;  // GLsync, set while the readback is in flight
+    Callback callback;
+  };
+
+  ShaderManager& shaderManager_;
+  ProgramHandle shader_;
+  unsigned int framebuffer_ = 0;
+  unsigned int idTexture_ = 0;
+  unsigned int depthTexture_ = 0;
+  unsigned int regionSize_;
+  // CPU copy of one mapped readback
+  std::vector<unsigned int> readback_;
+  bool hasRequest_ = false;
+  Request request_;
+  // Used round robin, so the in-flight ones are oldest first from nextSlot_
+  Slot slots_[SLOT_COUNT];
+  int nextSlot_ = 0;
+
+  void drawRegion(const Scene& scene, const RenderContext& context);
+  void collectReadbacks(const Scene& scene);
+  BodyHandle decode(const unsigned int* ids, const Scene& scene) const;
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_PICKINGRENDERER_H
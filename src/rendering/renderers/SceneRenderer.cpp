@@ -1,55 +1,250 @@
 ﻿#include "SceneRenderer.h"
 
-#include <celestialbody/CelestialBodyFactory.h>
+#include <AppConfig.h>
+#include <celestialbody/BodyComponents.h>
+#include <celestialbody/BodyRegistry.h>
+#include <core/Shader.h>
+#include <core/ShaderManager.h>
+#include <core/memory/FrameArena.h>
+#include <core/texturing/TextureManager.h>
 #include <rendering/RenderContext.h>
-#include <rendering/renderables/scene/CelestialBody.h>
+#include <rendering/Scene.h>
+#include <rendering/culling/FrustumCuller.h>
+#include <rendering/renderables/scene/Skybox.h>
+#include <rendering/renderers/ImpostorRenderer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "glm/detail/func_geometric.hpp"
 #include "glm/detail/func_trigonometric.hpp"
 #include "glm/detail/type_mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
-SceneRenderer::SceneRenderer() = default;
-SceneRenderer::~SceneRenderer() = default;
+namespace {
+struct DrawItem {
+  glm::mat4 model;
+  unsigned int vao;
+  unsigned int firstIndex;
+  unsigned int indexCount;
+  unsigned int textureID;
+};
+}  // namespace
+
+SceneRenderer::SceneRenderer(ShaderManager& shaderManager)
+    : shaderManager_(shaderManager),
+      bodyShader_(shaderManager.load("../shaders/object.vert",
+                                     "../shaders/object.frag")),
+      ringShader_(shaderManager.load("../shaders/ring.vert",
+                                     "../shaders/ring.frag")) {
+  if (!bodyShader_.isValid() || !ringShader_.isValid()) {
+    std::cout << "ERROR: Failed to create body shaders" << std::endl;
+  }
+
+  bool impostors = AppConfig::IMPOSTORS;
+  if (const char* value = std::getenv("SOLAR_IMPOSTORS")) {
+    impostors = std::atoi(value) != 0;
+  }
+  if (impostors) {
+    impostors_ = std::make_unique<ImpostorRenderer>(shaderManager);
+    if (!impostors_->isAvailable()) {
+      std::cout << "ERROR: Failed to create impostor shader, drawing every "
+                   "body as a mesh"
+                << std::endl;
+      impostors_.reset();
+    }
+  }
+}
+
+SceneRenderer::~SceneRenderer() {
+  shaderManager_.release(bodyShader_);
+  shaderManager_.release(ringShader_);
+}
 
-void SceneRenderer::render(const std::deque<ISceneRenderable*>& renderables,
+void SceneRenderer::render(const Scene& scene,
                            const RenderContext& context) const {
   glm::mat4 view = context.camera.getViewMatrix();
-  glm::mat4 projection =
-      glm::perspective(glm::radians(context.camera.Zoom),
-                       static_cast<float>(context.screenWidth) /
-                           static_cast<float>(context.screenHeight),
-                       0.1f, 10000.0f);
-
-  for (auto& renderable : renderables) {
-    // If IRenderable is a type of CelestialBody
-    if (const auto body = dynamic_cast<CelestialBody*>(renderable)) {
-      glm::mat4 model = calculateModelMatrix(*body, context.currentTime);
-      renderable->render(model, view, projection);
-    } else {
-      auto model = glm::mat4(1.0f);
-      renderable->render(model, view, projection);
+  glm::mat4 projection = calculateProjection(context);
+
+  if (scene.skybox) {
+    scene.skybox->render(view, projection);
+  }
+  if (!bodyShader_.isValid()) {
+    return;
+  }
+
+  renderBodies(scene, context, view, projection);
+  // Blended, so after every opaque body
+  renderRings(scene, context, view, projection);
+}
+
+void SceneRenderer::renderBodies(const Scene& scene,
+                                 const RenderContext& context,
+                                 const glm::mat4& view,
+                                 const glm::mat4& projection) const {
+  // Only what survived culling; textures of bodies off screen are not
+  // requested and stream down
+  const auto& visible = context.culling->getVisibleBodies();
+  // The queue lives in the frame arena and is gone after FrameArena::reset
+  FrameVector<DrawItem> drawQueue;
+  drawQueue.reserve(visible.size());
+
+  for (const VisibleBody& body : visible) {
+    const TransformComponent& transform = *body.transform;
+    const RenderComponent& render = *body.render;
+    const float screenRadius = calculateScreenRadius(transform, context);
+    // The equirectangular map wraps around the sphere, so the visible half
+    // of its width spans the disc diameter
+    scene.textureManager.requestTextureResolution(render.texture,
+                                                  screenRadius * 4.0f);
+    if (impostors_ && screenRadius <= AppConfig::IMPOSTOR_MAX_SCREEN_RADIUS) {
+      const glm::vec3& scale = transform.scale;
+      impostors_->add(
+          transform.position, std::max(scale.x, std::max(scale.y, scale.z)),
+          glm::angleAxis(
+              context.currentTime * glm::radians(transform.rotationSpeed),
+              glm::normalize(transform.rotationAxis)),
+          scene.textureManager.getGLTexture(render.texture));
+      continue;
+    }
+    drawQueue.push_back(
+        {calculateModelMatrix(transform, context.currentTime), render.vao,
+         body.firstIndex, body.indexCount,
+         scene.textureManager.getGLTexture(render.texture)});
+  }
+
+  const Shader& bodyShader = *shaderManager_.get(bodyShader_);
+  bodyShader.use();
+  bodyShader.setMat4("view", view);
+  bodyShader.setMat4("projection", projection);
+  bodyShader.setInt("texture", 0);
+  glActiveTexture(GL_TEXTURE0);
+
+  // Bodies share one mesh, every level of detail in it, so the VAO is
+  // bound once
+  unsigned int boundVAO = 0;
+  for (const auto& item : drawQueue) {
+    if (item.vao != boundVAO) {
+      glBindVertexArray(item.vao);
+      boundVAO = item.vao;
     }
+    bodyShader.setMat4("model", item.model);
+    glBindTexture(GL_TEXTURE_2D, item.textureID);
+    glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT,
+                   reinterpret_cast<const void*>(item.firstIndex *
+                                                 sizeof(unsigned int)));
   }
+  glBindVertexArray(0);
+
+  if (impostors_) {
+    impostors_->flush(view, projection);
+  }
+}
+
+void SceneRenderer::renderRings(const Scene& scene,
+                                const RenderContext& context,
+                                const glm::mat4& view,
+                                const glm::mat4& projection) const {
+  const auto& visible = context.culling->getVisibleRings();
+  FrameVector<DrawItem> drawQueue;
+  drawQueue.reserve(visible.size());
+
+  for (const VisibleRing& body : visible) {
+    const TransformComponent& transform = *body.transform;
+    const RingComponent& ring = *body.ring;
+    scene.textureManager.requestTextureResolution(
+        ring.texture, calculateScreenRadius(transform, context) * ring.extent);
+    drawQueue.push_back(
+        {calculateModelMatrix(transform, context.currentTime), ring.vao, 0,
+         ring.indexCount, scene.textureManager.getGLTexture(ring.texture)});
+  }
+  const Shader* ringShader = shaderManager_.get(ringShader_);
+  if (drawQueue.empty() || !ringShader) {
+    return;
+  }
+
+  bool cullFaceWasEnabled = glIsEnabled(GL_CULL_FACE);
+  bool depthTestWasEnabled = glIsEnabled(GL_DEPTH_TEST);
+
+  // Disable face culling (ring should be visible from both sides)
+  if (cullFaceWasEnabled) {
+    glDisable(GL_CULL_FACE);
+  }
+
+  // Keep depth testing on but do not write depth, so a ring never blocks
+  // what is behind it
+  if (!depthTestWasEnabled) {
+    glEnable(GL_DEPTH_TEST);
+  }
+  glDepthMask(GL_FALSE);
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  ringShader->use();
+  ringShader->setMat4("view", view);
+  ringShader->setMat4("projection", projection);
+  ringShader->setInt("ringTexture", 0);
+  glActiveTexture(GL_TEXTURE0);
+
+  for (const auto& item : drawQueue) {
+    ringShader->setMat4("model", item.model);
+    glBindTexture(GL_TEXTURE_2D, item.textureID);
+    glBindVertexArray(item.vao);
+    glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT, 0);
+  }
+  glBindVertexArray(0);
+
+  glDepthMask(GL_TRUE);
+  if (cullFaceWasEnabled) {
+    glEnable(GL_CULL_FACE);
+  }
+  if (!depthTestWasEnabled) {
+    glDisable(GL_DEPTH_TEST);
+  }
+  glDisable(GL_BLEND);
+}
+
+float SceneRenderer::calculateScreenRadius(const TransformComponent& transform,
+                                           const RenderContext& context) {
+  // Bodies are unit spheres scaled by their transform
+  const glm::vec3& scale = transform.scale;
+  const float radius = std::max(scale.x, std::max(scale.y, scale.z));
+  const float distance =
+      glm::length(transform.position - context.camera.Position);
+
+  const float halfScreen = static_cast<float>(context.screenHeight) * 0.5f;
+  if (distance <= radius) {
+    return halfScreen;
+  }
+
+  const float tanHalfFov = std::tan(glm::radians(context.camera.Zoom) * 0.5f);
+  return radius / (distance * tanHalfFov) * halfScreen;
+}
+
+glm::mat4 SceneRenderer::calculateProjection(const RenderContext& context) {
+  return glm::perspective(glm::radians(context.camera.Zoom),
+                          static_cast<float>(context.screenWidth) /
+                              static_cast<float>(context.screenHeight),
+                          0.1f, 10000.0f);
 }
 
-glm::mat4 SceneRenderer::calculateModelMatrix(const CelestialBody& body,
-                                              float currentTime) const {
+glm::mat4 SceneRenderer::calculateModelMatrix(
+    const TransformComponent& transform, float currentTime) {
   glm::mat4 model = glm::mat4(1.0f);
 
   // Translation
-  model = glm::translate(model, body.getBodyProps().position);
+  model = glm::translate(model, transform.position);
 
   // Rotation
-  float rotationSpeed =
-      CelestialBodyFactory::getRotationSpeed(body.getBodyProps().type);
-  glm::vec3 rotationAxis =
-      CelestialBodyFactory::getRotationAxis(body.getBodyProps().type);
-  model = glm::rotate(model, currentTime * glm::radians(rotationSpeed),
-                      rotationAxis);
+  model = glm::rotate(model,
+                      currentTime * glm::radians(transform.rotationSpeed),
+                      transform.rotationAxis);
 
   // Scale
-  glm::vec3 scale = CelestialBodyFactory::getScale(body.getBodyProps().type);
-  model = glm::scale(model, scale);
+  model = glm::scale(model, transform.scale);
 
   return model;
 }
\ No newline at end of file
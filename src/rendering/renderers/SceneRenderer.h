@@ -5,25 +5,45 @@
 #ifndef SCENE_RENDERER_H
 #define SCENE_RENDERER_H
 
+#include <core/resources/Handle.h>
+
 #include <memory>
-#include <queue>
 
 #include "glm/detail/type_mat.hpp"
 
-class CelestialBody;
-class ISceneRenderable;
+class ImpostorRenderer;
+class ShaderManager;
 
 struct RenderContext;
+struct Scene;
+struct TransformComponent;
 
 class SceneRenderer {
  public:
-  SceneRenderer();
+  explicit SceneRenderer(ShaderManager& shaderManager);
   ~SceneRenderer();
-  void render(const std::deque<ISceneRenderable*>& renderables,
-                   const RenderContext& context) const;
+  void render(const Scene& scene, const RenderContext& context) const;
+
+  // Shared with the passes that must line up with the scene (picking)
+  static glm::mat4 calculateProjection(const RenderContext& context);
+  static glm::mat4 calculateModelMatrix(const TransformComponent& transform,
+                                        float currentTime);
 
  private:
-  glm::mat4 calculateModelMatrix(const CelestialBody& body, float currentTime) const;
+  ShaderManager& shaderManager_;
+  // Shared by every body; compiled once instead of per body
+  ProgramHandle bodyShader_;
+  ProgramHandle ringShader_;
+  // Bodies no larger than IMPOSTOR_MAX_SCREEN_RADIUS on screen; null while
+  // impostors are off
+  std::unique_ptr<ImpostorRenderer> impostors_;
+
+  void renderBodies(const Scene& scene, const RenderContext& context,
+                    const glm::mat4& view, const glm::mat4& projection) const;
+  void renderRings(const Scene& scene, const RenderContext& context,
+                   const glm::mat4& view, const glm::mat4& projection) const;
+  static float calculateScreenRadius(const TransformComponent& transform,
+                                     const RenderContext& context);
 };
 
 #endif  // SCENE_RENDERER_H
\ No newline at end of file
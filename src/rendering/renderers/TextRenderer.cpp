@@ -1,29 +1,29 @@
 ﻿#include "TextRenderer.h"
 
 #include <core/Shader.h>
+#include <core/ShaderManager.h>
 
+#include <core/memory/MemoryTracker.h>
 #include <graphics/buffer/BufferManager.h>
 
 #include <iostream>
 
 #include "glm/gtc/matrix_transform.hpp"
 
-TextRenderer::TextRenderer(BufferManager& bufferManager, const int screenWidth,
-                           const int screenHeight)
+TextRenderer::TextRenderer(BufferManager& bufferManager,
+                           ShaderManager& shaderManager,
+                           const int screenWidth, const int screenHeight)
     : bufferManager_(bufferManager),
+      shaderManager_(shaderManager),
       screenWidth_(screenWidth),
       screenHeight_(screenHeight) {
-  try {
-    textShader = std::make_unique<Shader>("../shaders/uiText.vert",
-                                          "../shaders/uiText.frag");
-  } catch (const std::exception& e) {
-    std::cerr << "ERROR: Failed to load text shader: " << e.what() << std::endl;
+  textShader = shaderManager_.load("../shaders/uiText.vert",
+                                   "../shaders/uiText.frag");
+  if (!textShader.isValid()) {
+    std::cerr << "ERROR: Failed to load text shader" << std::endl;
   }
 
-  glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(screenWidth_),
-                                    0.0f, static_cast<float>(screenHeight_));
-  textShader->use();
-  textShader->setMat4("projection", projection);
+  setScreenSize();
 
   std::vector<VertexAttribute> attributes = {
       // position
@@ -41,7 +41,11 @@ TextRenderer::~TextRenderer() {
   for (auto& pair : Characters) {
     glDeleteTextures(1, &pair.second.TextureID);
   }
+  // 8x8 single-channel glyphs
+  MemoryTracker::release(MemoryCategory::UI, MemoryDomain::GPU,
+                         Characters.size() * 64);
   Characters.clear();
+  shaderManager_.release(textShader);
 
   std::cout << "Text renderer cleaned up" << std::endl;
 }
@@ -133,6 +137,8 @@ bool TextRenderer::loadFont() {
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
+    MemoryTracker::allocate(MemoryCategory::UI, MemoryDomain::GPU,
+                            Characters.size() * 64);
     return true;
   } catch (const std::exception& e) {
     std::cerr << "ERROR: Failed to load font: " << e.what() << std::endl;
@@ -140,8 +146,13 @@ bool TextRenderer::loadFont() {
   }
 }
 
-void TextRenderer::renderText(const std::string& text, float x, float y,
+void TextRenderer::renderText(std::string_view text, float x, float y,
                               float scale, glm::vec3 color) {
+  const Shader* shader = shaderManager_.get(textShader);
+  if (!shader) {
+    return;
+  }
+
   GLboolean blendEnabled = glIsEnabled(GL_BLEND);
   GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
   GLint blendSrc, blendDst;
@@ -153,8 +164,8 @@ void TextRenderer::renderText(const std::string& text, float x, float y,
 
   glDisable(GL_DEPTH_TEST);
 
-  textShader->use();
-  textShader->setVec3("textColor", color);
+  shader->use();
+  shader->setVec3("textColor", color);
   glActiveTexture(GL_TEXTURE0);
   glBindVertexArray(bufferHandle_.getVAO());
 
@@ -162,8 +173,7 @@ void TextRenderer::renderText(const std::string& text, float x, float y,
   float yPos =
       screenHeight_ - y - (8 * scale);  // Adjust for character height
 
-  std::string::const_iterator c;
-  for (c = text.begin(); c != text.end(); c++) {
+  for (auto c = text.begin(); c != text.end(); c++) {
     if (Characters.find(*c) == Characters.end()) {
       continue;  // Skip characters we don't have
     }
@@ -213,11 +223,11 @@ void TextRenderer::renderText(const std::string& text, float x, float y,
 }
 
 void TextRenderer::setScreenSize() const {
-  if (textShader) {
+  if (const Shader* shader = shaderManager_.get(textShader)) {
     glm::mat4 projection =
         glm::ortho(0.0f, static_cast<float>(screenWidth_), 0.0f,
                    static_cast<float>(screenHeight_));
-    textShader->use();
-    textShader->setMat4("projection", projection);
+    shader->use();
+    shader->setMat4("projection", projection);
   }
 }
\ No newline at end of file
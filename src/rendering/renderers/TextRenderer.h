@@ -5,13 +5,14 @@
 #ifndef TEXTRENDERER_H
 #define TEXTRENDERER_H
 
-class Shader;
+class ShaderManager;
 
 #include <glm/glm.hpp>
 #include <map>
 #include <memory>
-#include <string>
+#include <string_view>
 
+#include <core/resources/Handle.h>
 #include <graphics/buffer/BufferHandle.h>
 
 struct Character {
@@ -23,19 +24,21 @@ struct Character {
 
 class TextRenderer {
  public:
-  TextRenderer(BufferManager& bufferManager, int screenWidth, int screenHeight);
+  TextRenderer(BufferManager& bufferManager, ShaderManager& shaderManager,
+               int screenWidth, int screenHeight);
   ~TextRenderer();
 
-  void renderText(const std::string& text, float x, float y, float scale,
+  void renderText(std::string_view text, float x, float y, float scale,
                   glm::vec3 color = glm::vec3(1.0f, 1.0f, 1.0f));
   void setScreenSize() const;
 
  private:
   BufferHandle bufferHandle_;
   BufferManager& bufferManager_;
+  ShaderManager& shaderManager_;
 
   std::map<char, Character> Characters;
-  std::unique_ptr<Shader> textShader;
+  ProgramHandle textShader;
   const int screenWidth_;
   const int screenHeight_;
 
@@ -5,14 +5,43 @@
 #include "UIRenderer.h"
 
 #include <CelestialBodyTypes.h>
-#include <celestialbody/CelestialBodyFactory.h>
+#include <celestialbody/BodyComponents.h>
+#include <core/debug/GLValidation.h>
+#include <core/memory/AllocationTracker.h>
+#include <core/memory/FrameArena.h>
+#include <core/memory/MemoryTracker.h>
+#include <core/window/FramePacer.h>
 #include <helpers/RenderHelper.h>
 #include <rendering/RenderContext.h>
 #include <rendering/ScreenPosition.h>
+#include <rendering/culling/FrustumCuller.h>
 
-#include <iomanip>
-#include <ios>
-#include <sstream>
+#include <cstdarg>
+#include <cstdio>
+
+namespace {
+// printf into a frame-arena string; the HUD text only lives for this frame
+FrameString formatText(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  va_list sizeArgs;
+  va_copy(sizeArgs, args);
+  const int length = std::vsnprintf(nullptr, 0, format, sizeArgs);
+  va_end(sizeArgs);
+
+  FrameString text;
+  if (length > 0) {
+    text.resize(static_cast<size_t>(length));
+    std::vsnprintf(text.data(), text.size() + 1, format, args);
+  }
+  va_end(args);
+  return text;
+}
+
+float toMB(size_t bytes) {
+  return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+}
+}  // namespace
 
 UIRenderer::UIRenderer(TextRenderer& textRenderer)
     : textRenderer_(textRenderer) {}
@@ -24,24 +53,63 @@ void UIRenderer::render(const RenderContext& renderContext) const {
   renderCameraPosition(renderContext);
   renderCrosshair(renderContext);
   renderPanel(renderContext);
+  renderMemoryPage(renderContext);
 }
 
 void UIRenderer::renderFPS(const RenderContext& renderContext) const {
   float fpsX = renderContext.screenWidth - 500.0f;
   float fpsY = 20.0f;
 
-  std::string fpsText =
-      "FPS: " + std::to_string(static_cast<int>(renderContext.fps));
+  const FrameString fpsText =
+      formatText("FPS: %d", static_cast<int>(renderContext.fps));
   textRenderer_.renderText(fpsText, fpsX, fpsY, 3.0f,
                            glm::vec3(0.0f, 1.0f, 0.0f));
 
   if (renderContext.fps > 0.0f) {
     float frameTime = 1000.0f / renderContext.fps;
-    std::string frameTimeText =
-        std::to_string(static_cast<int>(frameTime)) + " MS";
+    const FrameString frameTimeText =
+        formatText("%d MS", static_cast<int>(frameTime));
     textRenderer_.renderText(frameTimeText, fpsX, fpsY + 30.0f, 2.5f,
                              glm::vec3(0.8f, 0.8f, 0.8f));
   }
+
+  const GLValidationLevel validation = GLValidation::getLevel();
+  textRenderer_.renderText(
+      formatText("GL VALIDATION: %s", GLValidation::getLevelName(validation)),
+      fpsX, fpsY + 60.0f, 2.2f,
+      validation == GLValidationLevel::Off ? glm::vec3(0.6f, 0.6f, 0.6f)
+                                           : glm::vec3(1.0f, 0.8f, 0.3f));
+
+  const FramePacer& pacer = renderContext.framePacer;
+  const FramePacer::Stats& pacing = pacer.getStats();
+  const double targetFps = pacer.getTargetFps();
+  textRenderer_.renderText(
+      targetFps > 0.0
+          ? formatText("VSYNC: %s  CAP: %d%s",
+                       FramePacer::getVsyncModeName(pacer.getVsyncMode()),
+                       static_cast<int>(targetFps),
+                       pacer.isLowLatency() ? "  LOW LATENCY" : "")
+          : formatText("VSYNC: %s%s",
+                       FramePacer::getVsyncModeName(pacer.getVsyncMode()),
+                       pacer.isLowLatency() ? "  LOW LATENCY" : ""),
+      fpsX, fpsY + 90.0f, 2.2f, glm::vec3(0.8f, 0.8f, 0.8f));
+  // Deviation is what the eye notices as stutter, not the average
+  textRenderer_.renderText(
+      formatText("FRAME %.2f MS  DEV %.2f  MAX %.2f", pacing.averageMs,
+                 pacing.deviationMs, pacing.worstMs),
+      fpsX, fpsY + 120.0f, 2.2f,
+      pacing.deviationMs > 2.0 ? glm::vec3(1.0f, 0.4f, 0.4f)
+                               : glm::vec3(0.8f, 0.8f, 0.8f));
+
+  textRenderer_.renderText(
+      formatText("INPUT LATENCY %.1f MS  MAX %.1f", pacing.inputLatencyMs,
+                 pacing.inputLatencyWorstMs),
+      fpsX, fpsY + 150.0f, 2.2f, glm::vec3(0.8f, 0.8f, 0.8f));
+
+  if (renderContext.onDemand) {
+    textRenderer_.renderText("RENDERING: ON DEMAND", fpsX, fpsY + 180.0f,
+                             2.2f, glm::vec3(0.6f, 0.8f, 1.0f));
+  }
 }
 
 void UIRenderer::renderControls() const {
@@ -63,7 +131,17 @@ void UIRenderer::renderControls() const {
                            glm::vec3(1.0f, 1.0f, 1.0f));
   textRenderer_.renderText("CLICK        - SELECT PLANET", 20.0f, 260.0f, 2.2f,
                            glm::vec3(0.5f, 1.0f, 0.5f));
-  textRenderer_.renderText("ESC          - EXIT", 20.0f, 290.0f, 2.2f,
+  textRenderer_.renderText("M            - MEMORY STATS", 20.0f, 290.0f, 2.2f,
+                           glm::vec3(1.0f, 1.0f, 1.0f));
+  textRenderer_.renderText("V            - GL VALIDATION", 20.0f, 320.0f, 2.2f,
+                           glm::vec3(1.0f, 1.0f, 1.0f));
+  textRenderer_.renderText("F            - VSYNC", 20.0f, 350.0f, 2.2f,
+                           glm::vec3(1.0f, 1.0f, 1.0f));
+  textRenderer_.renderText("L            - LOW LATENCY", 20.0f, 380.0f, 2.2f,
+                           glm::vec3(1.0f, 1.0f, 1.0f));
+  textRenderer_.renderText("P            - PAUSE", 20.0f, 410.0f, 2.2f,
+                           glm::vec3(1.0f, 1.0f, 1.0f));
+  textRenderer_.renderText("ESC          - EXIT", 20.0f, 440.0f, 2.2f,
                            glm::vec3(1.0f, 0.5f, 0.5f));
 }
 
@@ -71,15 +149,20 @@ void UIRenderer::renderTitle(const RenderContext& renderContext) const {
   textRenderer_.renderText(
       "SOLAR SYSTEM SIMULATION", (renderContext.screenWidth / 2.0f) - 300.0f,
       (renderContext.screenHeight / 15.0f), 3.0f, glm::vec3(0.0f, 0.8f, 1.0f));
+
+  if (renderContext.paused) {
+    textRenderer_.renderText("PAUSED", (renderContext.screenWidth / 2.0f) - 60.0f,
+                             (renderContext.screenHeight / 8.0f) + 40.0f, 3.0f,
+                             glm::vec3(1.0f, 0.8f, 0.3f));
+  }
 }
 
 void UIRenderer::renderCameraPosition(
     const RenderContext& renderContext) const {
   glm::vec3 camPos = renderContext.camera.Position;
-  std::string posText =
-      "POSITION: X:" + std::to_string(static_cast<int>(camPos.x)) +
-      " Y:" + std::to_string(static_cast<int>(camPos.y)) +
-      " Z:" + std::to_string(static_cast<int>(camPos.z));
+  const FrameString posText = formatText(
+      "POSITION: X:%d Y:%d Z:%d", static_cast<int>(camPos.x),
+      static_cast<int>(camPos.y), static_cast<int>(camPos.z));
 
   textRenderer_.renderText(posText, (renderContext.screenWidth / 2.0f) - 300.0f,
                            (renderContext.screenHeight / 8.0f), 3.0f,
@@ -94,12 +177,22 @@ void UIRenderer::renderCrosshair(const RenderContext& renderContext) const {
 }
 
 void UIRenderer::renderPanel(const RenderContext& renderContext) const {
-  if (!renderContext.canRenderPanel) {
+  // A body culled this frame is off screen, and so is its label
+  if (!renderContext.canRenderPanel ||
+      !renderContext.culling->isVisible(renderContext.selectedBody)) {
+    return;
+  }
+  const auto* transform =
+      renderContext.bodies.getWorld().get<TransformComponent>(
+          renderContext.selectedBody);
+  const BodyInfo* body =
+      renderContext.bodies.getInfo(renderContext.selectedBody);
+  if (!transform || !body) {
     return;
   }
+
   // Calculate the position above the planet
-  glm::vec3 panelWorldPos = CelestialBodyFactory::getBodyProps(renderContext.selectedBodyType).position +
-                            glm::vec3(0.0f, 2.0f, 0.0f);
+  glm::vec3 panelWorldPos = transform->position + glm::vec3(0.0f, 2.0f, 0.0f);
 
   ScreenPosition screenPos =
       RenderHelper::worldToScreen(panelWorldPos, renderContext);
@@ -126,66 +219,146 @@ void UIRenderer::renderPanel(const RenderContext& renderContext) const {
     panelX = renderContext.screenWidth - panelWidth - 10.0f;
   if (panelY < 10.0f) panelY = 10.0f;
 
+  const BodyInfo& info = *body;
+
   // Render title
-  textRenderer_.renderText(CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).name,
-                           panelX + 10.0f, panelY + 10.0f, titleScale,
-                           glm::vec3(1.0f, 0.9f, 0.2f));
+  textRenderer_.renderText(info.name, panelX + 10.0f, panelY + 10.0f,
+                           titleScale, glm::vec3(1.0f, 0.9f, 0.2f));
 
   float currentY = panelY + 45.0f;
 
   // Render type with color coding
   glm::vec3 typeColor = glm::vec3(0.5f, 0.9f, 1.0f);
-  if (CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).type == "STAR")
+  if (info.type == "STAR")
     typeColor = glm::vec3(1.0f, 0.9f, 0.3f);
-  else if (CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).type == "GAS GIANT")
+  else if (info.type == "GAS GIANT")
     typeColor = glm::vec3(0.9f, 0.7f, 0.5f);
-  else if (CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).type == "ICE GIANT")
+  else if (info.type == "ICE GIANT")
     typeColor = glm::vec3(0.6f, 0.8f, 1.0f);
 
-  textRenderer_.renderText(
-      "TYPE: " + CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).type, panelX + 10.0f,
-      currentY, textScale, typeColor);
+  textRenderer_.renderText(formatText("TYPE: %s", info.type.c_str()),
+                           panelX + 10.0f, currentY, textScale, typeColor);
   currentY += lineHeight;
 
   // Distance from Sun
-  std::stringstream distStream;
-  distStream << std::fixed << std::setprecision(2)
-             << CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).distanceFromSun;
-  textRenderer_.renderText("DISTANCE: " + distStream.str() + " AU",
-                           panelX + 10.0f, currentY, textScale,
-                           glm::vec3(0.8f, 0.8f, 1.0f));
+  textRenderer_.renderText(
+      formatText("DISTANCE: %.2f AU", info.distanceFromSun), panelX + 10.0f,
+      currentY, textScale, glm::vec3(0.8f, 0.8f, 1.0f));
   currentY += lineHeight;
 
   // Temperature
-  std::stringstream tempStream;
-  tempStream << std::fixed << std::setprecision(0)
-             << CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).temperature;
-  textRenderer_.renderText("TEMP: " + tempStream.str() + " C", panelX + 10.0f,
-                           currentY, textScale, glm::vec3(1.0f, 0.6f, 0.4f));
+  textRenderer_.renderText(formatText("TEMP: %.0f C", info.temperature),
+                           panelX + 10.0f, currentY, textScale,
+                           glm::vec3(1.0f, 0.6f, 0.4f));
   currentY += lineHeight;
 
   // Mass
-  std::stringstream massStream;
-  massStream << std::fixed << std::setprecision(2)
-             << CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).mass;
-  textRenderer_.renderText("MASS: " + massStream.str() + " EARTHS",
+  textRenderer_.renderText(formatText("MASS: %.2f EARTHS", info.mass),
                            panelX + 10.0f, currentY, textScale,
                            glm::vec3(0.7f, 1.0f, 0.7f));
   currentY += lineHeight;
 
   // Diameter
-  std::stringstream diamStream;
-  diamStream << std::fixed << std::setprecision(0)
-             << CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).diameter;
-  textRenderer_.renderText("DIAMETER: " + diamStream.str() + " KM",
+  textRenderer_.renderText(formatText("DIAMETER: %.0f KM", info.diameter),
                            panelX + 10.0f, currentY, textScale,
                            glm::vec3(0.9f, 0.9f, 0.9f));
   currentY += lineHeight;
 
   // Moons
+  textRenderer_.renderText(formatText("MOONS: %d", info.moons),
+                           panelX + 10.0f, currentY, textScale,
+                           glm::vec3(0.8f, 0.8f, 0.9f));
+}
+
+void UIRenderer::renderMemoryPage(const RenderContext& renderContext) const {
+  if (!renderContext.canRenderMemoryPage) {
+    return;
+  }
+
+  const float x = 20.0f;
+  float y = 470.0f;
+  const float lineHeight = 25.0f;
+  const float textScale = 2.0f;
+
+  textRenderer_.renderText("MEMORY (MB)       CURRENT  PEAK    BUDGET", x, y,
+                           2.2f, glm::vec3(1.0f, 1.0f, 0.0f));
+  y += lineHeight + 5.0f;
+
+  for (const auto domain : {MemoryDomain::GPU, MemoryDomain::CPU}) {
+    for (int i = 0; i < static_cast<int>(MemoryCategory::Count); i++) {
+      const auto category = static_cast<MemoryCategory>(i);
+      const MemoryStats stats = MemoryTracker::getStats(category, domain);
+
+      // Close to the budget turns red
+      glm::vec3 color(0.8f, 0.8f, 0.8f);
+      if (stats.budget > 0 && stats.current > stats.budget * 9 / 10) {
+        color = glm::vec3(1.0f, 0.4f, 0.4f);
+      }
+
+      FrameString line = formatText(
+          "%s %-*s%-9.1f%-8.1f", MemoryTracker::getDomainName(domain),
+          static_cast<int>(17 - std::char_traits<char>::length(
+                                    MemoryTracker::getDomainName(domain))),
+          MemoryTracker::getCategoryName(category), toMB(stats.current),
+          toMB(stats.peak));
+      line += stats.budget > 0 ? formatText("%.1f", toMB(stats.budget)) : "-";
+      textRenderer_.renderText(line, x, y, textScale, color);
+      y += lineHeight;
+    }
+
+    textRenderer_.renderText(
+        formatText("%s TOTAL%*s%.1f", MemoryTracker::getDomainName(domain),
+                   static_cast<int>(12 - std::char_traits<char>::length(
+                                             MemoryTracker::getDomainName(
+                                                 domain))),
+                   "", toMB(MemoryTracker::getTotal(domain))),
+        x, y, textScale, glm::vec3(0.5f, 1.0f, 0.5f));
+    y += lineHeight + 10.0f;
+  }
+
+  textRenderer_.renderText(
+      formatText("FRAME ARENA USED %.2f PEAK %.2f OF %.1f",
+                 toMB(FrameArena::getUsedBytes()),
+                 toMB(FrameArena::getPeakBytes()),
+                 toMB(FrameArena::getCapacity())),
+      x, y, textScale, glm::vec3(0.8f, 0.8f, 0.8f));
+
+  renderAllocationStats(renderContext);
+}
+
+void UIRenderer::renderAllocationStats(
+    const RenderContext& renderContext) const {
+  const float x = renderContext.screenWidth - 500.0f;
+  float y = 470.0f;
+  const float lineHeight = 25.0f;
+  const float textScale = 2.0f;
+
+  if (!AllocationTracker::isEnabled()) {
+    textRenderer_.renderText("ALLOCATION TRACKING OFF", x, y, 2.2f,
+                             glm::vec3(0.6f, 0.6f, 0.6f));
+    return;
+  }
+
+  // Any allocation in a frame is worth noticing, so non-zero shows red
+  const AllocationStats& frame = AllocationTracker::getLastFrame();
   textRenderer_.renderText(
-      "MOONS: " + std::to_string(CelestialBodyFactory::getBodyInfo(renderContext.selectedBodyType).moons),
-      panelX + 10.0f, currentY, textScale, glm::vec3(0.8f, 0.8f, 0.9f));
+      formatText("ALLOCS PER FRAME: %zu (%zu KB)", frame.allocations,
+                 frame.bytes / 1024),
+      x, y, 2.2f,
+      frame.allocations > 0 ? glm::vec3(1.0f, 0.4f, 0.4f)
+                            : glm::vec3(0.5f, 1.0f, 0.5f));
+  y += lineHeight + 5.0f;
+
+  for (size_t zone = 0; zone < AllocationTracker::getZoneCount(); zone++) {
+    const AllocationStats& stats = AllocationTracker::getZoneStats(zone);
+    textRenderer_.renderText(
+        formatText("%-12s%-6zu%zu B", AllocationTracker::getZoneName(zone),
+                   stats.allocations, stats.bytes),
+        x, y, textScale,
+        stats.allocations > 0 ? glm::vec3(1.0f, 0.6f, 0.6f)
+                              : glm::vec3(0.8f, 0.8f, 0.8f));
+    y += lineHeight;
+  }
 }
 
 // void CelestialBodyInfoPanel::renderBackground(float x, float y, float width,
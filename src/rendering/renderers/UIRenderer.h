@@ -24,6 +24,8 @@ class UIRenderer {
   void renderCameraPosition(const RenderContext& renderContext) const;
   void renderCrosshair(const RenderContext& renderContext) const;
   void renderPanel(const RenderContext& renderContext) const;
+  void renderMemoryPage(const RenderContext& renderContext) const;
+  void renderAllocationStats(const RenderContext& renderContext) const;
   // void renderBackground(float x, float y, float width, float height);
 
   // void renderCelestialBodyInfo(const glm::vec3& bodyPosition,
@@ -4,15 +4,28 @@
 
 #include <glad/glad.h>
 
+#include <core/debug/GLValidation.h>
+#include <core/logging/Logger.h>
+
 #include <iostream>
 #include <string>
 
-// Simple OpenGL Error checking macro
-#define GL_CHECK(stmt)                           \
-  do {                                           \
-    stmt;                                        \
-    checkOpenGLError(#stmt, __FILE__, __LINE__); \
+// Per-call glGetError check, only at the Synchronous validation level and
+// compiled out of release builds (see GLValidation)
+#if SOLAR_GL_SYNC_VALIDATION
+#define GL_CHECK(stmt)                             \
+  do {                                             \
+    stmt;                                          \
+    if (GLValidation::isSynchronous()) {           \
+      checkOpenGLError(#stmt, __FILE__, __LINE__); \
+    }                                              \
+  } while (0)
+#else
+#define GL_CHECK(stmt) \
+  do {                 \
+    stmt;              \
   } while (0)
+#endif
 
 inline void checkOpenGLError(const char* stmt, const char* fname, int line) {
   GLenum err = glGetError();
@@ -53,6 +66,9 @@ inline void checkOpenGLError(const char* stmt, const char* fname, int line) {
     glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &currentVAO);
     std::cout << "Current VAO: " << currentVAO << std::endl;
 
+    // Let the queued log lines leading up to the error reach the console
+    Logger::flush();
+
 // Break into debugger on Windows
 #ifdef _WIN32
     __debugbreak();
@@ -100,14 +116,14 @@ inline void checkBufferBinding(GLenum target, const std::string& bufferName) {
   }
 
   glGetIntegerv(queryTarget, &boundBuffer);
-  std::cout << bufferName << " bound to ID: " << boundBuffer << std::endl;
+  LOG_TRACE("%s bound to ID: %d", bufferName.c_str(), boundBuffer);
 }
 
 // Check VAO binding
 inline void checkVAOBinding() {
   int boundVAO;
   glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &boundVAO);
-  std::cout << "Currently bound VAO: " << boundVAO << std::endl;
+  LOG_TRACE("Currently bound VAO: %d", boundVAO);
 }
 
 // Check texture binding
@@ -115,8 +131,8 @@ inline void checkTextureBinding(GLenum textureUnit = GL_TEXTURE0) {
   glActiveTexture(textureUnit);
   int boundTexture;
   glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
-  std::cout << "Texture unit " << (textureUnit - GL_TEXTURE0)
-            << " has texture ID: " << boundTexture << " bound" << std::endl;
+  LOG_TRACE("Texture unit %u has texture ID: %d bound",
+            textureUnit - GL_TEXTURE0, boundTexture);
 }
 
 // Initialize basic debugging (without advanced debug context)
@@ -124,8 +140,7 @@ inline void initializeBasicDebugging() {
   std::cout << "Initializing basic OpenGL debugging..." << std::endl;
   printOpenGLInfo();
 
-  // Check for common issues
-  GL_CHECK(glGetError());  // Clear any existing errors
+  glGetError();  // Clear any existing error
 
   std::cout << "Basic debugging initialized" << std::endl;
 }
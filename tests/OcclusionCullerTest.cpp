@@ -0,0 +1,153 @@
+// Checks OcclusionCuller against spheres placed around one large occluder
+// and times a dense scene.
+//
+//   occlusion_culler_test
+//
+// Returns non-zero if a sphere is classified wrongly.
+
+#include <core/threading/ThreadPool.h>
+#include <rendering/culling/OcclusionCuller.h>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+// Same buffer and worker count as the app's defaults in AppConfig
+constexpr unsigned int BUFFER_WIDTH = 256;
+constexpr unsigned int BUFFER_HEIGHT = 128;
+constexpr size_t WORKER_THREADS = 2;
+
+constexpr int TIMED_FRAMES = 200;
+constexpr size_t DENSE_OCCLUDERS = 200;
+constexpr size_t DENSE_SPHERES = 20000;
+
+using Clock = std::chrono::steady_clock;
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+  std::printf("%s: %s\n", condition ? "ok" : "FAIL", what);
+  if (!condition) {
+    failures++;
+  }
+}
+
+// Camera at the origin looking down -z, as a 2:1 window would see it
+void beginFrame(OcclusionCuller& culler) {
+  const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0, 0, -1),
+                                     glm::vec3(0, 1, 0));
+  const glm::mat4 projection =
+      glm::perspective(glm::radians(45.0f), 2.0f, 0.1f, 1000.0f);
+  culler.begin(view, projection);
+}
+
+void checkCases(ThreadPool* pool) {
+  OcclusionCuller culler(BUFFER_WIDTH, BUFFER_HEIGHT, pool);
+  beginFrame(culler);
+  // Covers about a fifth of the view's width, 50 units out
+  culler.addOccluder(glm::vec3(0, 0, -50), 10.0f);
+  culler.rasterize();
+  expect(culler.getOccluderCount() == 1, "large sphere becomes an occluder");
+
+  expect(culler.isOccluded(glm::vec3(0, 0, -100), 2.0f),
+         "sphere straight behind the occluder is hidden");
+  expect(culler.isOccluded(glm::vec3(5, -5, -200), 5.0f),
+         "distant sphere inside the occluder's silhouette is hidden");
+  // The occluder's edge is at x = 20 this far out
+  expect(!culler.isOccluded(glm::vec3(20, 0, -100), 3.0f),
+         "partly hidden sphere across the occluder's edge is visible");
+  expect(!culler.isOccluded(glm::vec3(0, 0, -30), 2.0f),
+         "sphere in front of the occluder is visible");
+  expect(!culler.isOccluded(glm::vec3(0, 0, -55), 8.0f),
+         "sphere overlapping the occluder in depth is visible");
+  expect(!culler.isOccluded(glm::vec3(500, 0, -100), 2.0f),
+         "sphere off the buffer is left to frustum culling");
+  expect(!culler.isOccluded(glm::vec3(0, 0, 100), 2.0f),
+         "sphere behind the camera is left to frustum culling");
+
+  // Too small on screen to hide anything
+  beginFrame(culler);
+  culler.addOccluder(glm::vec3(0, 0, -900), 1.0f);
+  culler.rasterize();
+  expect(culler.getOccluderCount() == 0, "tiny sphere is not an occluder");
+  expect(!culler.isOccluded(glm::vec3(0, 0, -950), 0.1f),
+         "nothing is hidden without occluders");
+}
+
+// Returns the final depth buffer
+std::vector<float> timeDenseScene(ThreadPool* pool) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> spread(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> distance(20.0f, 400.0f);
+
+  // Spheres scattered through the view volume
+  const auto randomSphere = [&](float radius) {
+    const float z = distance(rng);
+    return glm::vec4(spread(rng) * z * 0.8f, spread(rng) * z * 0.4f, -z,
+                     radius);
+  };
+  std::vector<glm::vec4> occluders;
+  for (size_t i = 0; i < DENSE_OCCLUDERS; i++) {
+    occluders.push_back(randomSphere(8.0f));
+  }
+  std::vector<glm::vec4> spheres;
+  for (size_t i = 0; i < DENSE_SPHERES; i++) {
+    spheres.push_back(randomSphere(0.5f));
+  }
+
+  OcclusionCuller culler(BUFFER_WIDTH, BUFFER_HEIGHT, pool);
+  double rasterizeTime = 0.0;
+  double testTime = 0.0;
+  size_t hidden = 0;
+  for (int frame = 0; frame < TIMED_FRAMES; frame++) {
+    auto start = Clock::now();
+    beginFrame(culler);
+    for (const glm::vec4& occluder : occluders) {
+      culler.addOccluder(glm::vec3(occluder), occluder.w);
+    }
+    culler.rasterize();
+    rasterizeTime += std::chrono::duration<double, std::micro>(
+                         Clock::now() - start)
+                         .count();
+
+    start = Clock::now();
+    hidden = 0;
+    for (const glm::vec4& sphere : spheres) {
+      hidden += culler.isOccluded(glm::vec3(sphere), sphere.w) ? 1 : 0;
+    }
+    testTime += std::chrono::duration<double, std::micro>(Clock::now() -
+                                                          start)
+                    .count();
+  }
+
+  std::printf(
+      "%s: %zu occluders rasterized in %.1f us, %zu spheres tested in "
+      "%.1f us (%.3f us each), %zu hidden\n",
+      pool ? "pool" : "single thread", culler.getOccluderCount(),
+      rasterizeTime / TIMED_FRAMES, DENSE_SPHERES, testTime / TIMED_FRAMES,
+      testTime / TIMED_FRAMES / DENSE_SPHERES, hidden);
+  return culler.getDepth();
+}
+}  // namespace
+
+int main() {
+  ThreadPool pool(WORKER_THREADS);
+
+  checkCases(nullptr);
+  checkCases(&pool);
+  const std::vector<float> serialDepth = timeDenseScene(nullptr);
+  const std::vector<float> parallelDepth = timeDenseScene(&pool);
+  expect(serialDepth == parallelDepth,
+         "pool and calling thread rasterize the same buffer");
+
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
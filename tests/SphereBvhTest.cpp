@@ -0,0 +1,258 @@
+// Checks SphereBvh queries against a brute-force scan over the same
+// spheres and times random rays through the tree.
+//
+//   sphere_bvh_test [sphereCount]   (default 1000000)
+//
+// Returns non-zero if any query disagrees with the scan.
+
+#include <core/spatial/SphereBvh.h>
+#include <core/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+// Rays checked against the scan; each one visits every sphere
+constexpr int CHECKED_RAYS = 200;
+constexpr int TIMED_RAYS = 20000;
+constexpr int CHECKED_QUERIES = 20;
+constexpr float WORLD_EXTENT = 1000.0f;
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+int failures = 0;
+
+void fail(const char* what, int index) {
+  std::printf("FAIL: %s (case %d)\n", what, index);
+  failures++;
+}
+
+// Entry distance along the ray, or the exit distance from inside
+bool bruteForceRaycast(const std::vector<glm::vec4>& spheres,
+                       const glm::vec3& origin, const glm::vec3& direction,
+                       SphereBvh::RayHit& hit) {
+  const float a = glm::dot(direction, direction);
+  bool found = false;
+  hit.distance = INFINITY;
+  for (size_t i = 0; i < spheres.size(); i++) {
+    const glm::vec3 offset = origin - glm::vec3(spheres[i]);
+    const float b = glm::dot(offset, direction);
+    const float c = glm::dot(offset, offset) - spheres[i].w * spheres[i].w;
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) {
+      continue;
+    }
+    const float root = std::sqrt(discriminant);
+    float t = (-b - root) / a;
+    if (t < 0.0f) {
+      t = (-b + root) / a;
+    }
+    if (t >= 0.0f && t < hit.distance) {
+      hit.distance = t;
+      hit.sphere = static_cast<uint32_t>(i);
+      found = true;
+    }
+  }
+  return found;
+}
+
+void checkRays(const SphereBvh& bvh, const std::vector<glm::vec4>& spheres,
+               std::mt19937& rng) {
+  std::uniform_real_distribution<float> coordinate(-WORLD_EXTENT,
+                                                   WORLD_EXTENT);
+  for (int i = 0; i < CHECKED_RAYS; i++) {
+    const glm::vec3 origin(coordinate(rng), coordinate(rng), coordinate(rng));
+    const glm::vec3 direction(coordinate(rng), coordinate(rng),
+                              coordinate(rng));
+
+    SphereBvh::RayHit hit;
+    SphereBvh::RayHit expected;
+    const bool found = bvh.raycast(origin, direction, INFINITY, hit);
+    const bool expectedFound =
+        bruteForceRaycast(spheres, origin, direction, expected);
+    // Overlapping spheres may tie; the distance is what must agree
+    if (found != expectedFound ||
+        (found && hit.sphere != expected.sphere &&
+         std::abs(hit.distance - expected.distance) >
+             1e-3f * expected.distance)) {
+      fail("raycast", i);
+    }
+  }
+}
+
+void checkRadius(const SphereBvh& bvh, const std::vector<glm::vec4>& spheres,
+                 std::mt19937& rng) {
+  std::uniform_real_distribution<float> coordinate(-WORLD_EXTENT,
+                                                   WORLD_EXTENT);
+  constexpr float RADIUS = 50.0f;
+  for (int i = 0; i < CHECKED_QUERIES; i++) {
+    const glm::vec3 center(coordinate(rng), coordinate(rng), coordinate(rng));
+    std::set<uint32_t> found;
+    bvh.queryRadius(center, RADIUS,
+                    [&](uint32_t sphere) { found.insert(sphere); });
+
+    std::set<uint32_t> expected;
+    for (size_t k = 0; k < spheres.size(); k++) {
+      const glm::vec3 offset = glm::vec3(spheres[k]) - center;
+      const float reach = RADIUS + spheres[k].w;
+      if (glm::dot(offset, offset) <= reach * reach) {
+        expected.insert(static_cast<uint32_t>(k));
+      }
+    }
+    if (found != expected) {
+      fail("queryRadius", i);
+    }
+  }
+}
+
+void checkNearest(const SphereBvh& bvh, const std::vector<glm::vec4>& spheres,
+                  std::mt19937& rng) {
+  std::uniform_real_distribution<float> coordinate(-WORLD_EXTENT,
+                                                   WORLD_EXTENT);
+  const size_t k = std::min<size_t>(8, spheres.size());
+  std::vector<SphereBvh::Neighbor> found;
+  std::vector<float> expected(spheres.size());
+  for (int i = 0; i < CHECKED_QUERIES; i++) {
+    const glm::vec3 point(coordinate(rng), coordinate(rng), coordinate(rng));
+    bvh.queryNearest(point, k, found);
+
+    for (size_t s = 0; s < spheres.size(); s++) {
+      expected[s] = std::max(
+          glm::length(point - glm::vec3(spheres[s])) - spheres[s].w, 0.0f);
+    }
+    std::partial_sort(expected.begin(), expected.begin() + k, expected.end());
+    if (found.size() != k) {
+      fail("queryNearest count", i);
+      continue;
+    }
+    for (size_t j = 0; j < k; j++) {
+      if (std::abs(found[j].distance - expected[j]) > 1e-3f) {
+        fail("queryNearest distance", i);
+        break;
+      }
+    }
+  }
+}
+
+void checkFrustum(const SphereBvh& bvh,
+                  const std::vector<glm::vec4>& spheres) {
+  // An axis-aligned box written as six inward-facing planes
+  const SphereBvh::Frustum frustum = {
+      glm::vec4(1, 0, 0, 100), glm::vec4(-1, 0, 0, 100),
+      glm::vec4(0, 1, 0, 300), glm::vec4(0, -1, 0, 100),
+      glm::vec4(0, 0, 1, 100), glm::vec4(0, 0, -1, 50)};
+
+  std::set<uint32_t> found;
+  bvh.queryFrustum(frustum, [&](uint32_t sphere) { found.insert(sphere); });
+
+  std::set<uint32_t> expected;
+  for (size_t k = 0; k < spheres.size(); k++) {
+    bool inside = true;
+    for (const glm::vec4& plane : frustum) {
+      if (glm::dot(glm::vec3(plane), glm::vec3(spheres[k])) + plane.w <
+          -spheres[k].w) {
+        inside = false;
+      }
+    }
+    if (inside) {
+      expected.insert(static_cast<uint32_t>(k));
+    }
+  }
+  if (found != expected) {
+    fail("queryFrustum", 0);
+  }
+}
+
+void timeRays(const SphereBvh& bvh, std::mt19937& rng) {
+  std::uniform_real_distribution<float> coordinate(-WORLD_EXTENT,
+                                                   WORLD_EXTENT);
+  std::vector<glm::vec3> rays(2 * TIMED_RAYS);
+  for (glm::vec3& value : rays) {
+    value = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+  }
+
+  int hits = 0;
+  const auto start = Clock::now();
+  for (int i = 0; i < TIMED_RAYS; i++) {
+    SphereBvh::RayHit hit;
+    hits += bvh.raycast(rays[2 * i], rays[2 * i + 1], INFINITY, hit) ? 1 : 0;
+  }
+  const double elapsed = millisecondsSince(start);
+  std::printf("%d random rays: %.2f us per ray (%d hits)\n", TIMED_RAYS,
+              elapsed * 1000.0 / TIMED_RAYS, hits);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count =
+      argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> coordinate(-WORLD_EXTENT,
+                                                   WORLD_EXTENT);
+  std::uniform_real_distribution<float> radius(0.1f, 3.0f);
+  std::vector<glm::vec4> spheres(count);
+  for (glm::vec4& sphere : spheres) {
+    sphere = glm::vec4(coordinate(rng), coordinate(rng), coordinate(rng),
+                       radius(rng));
+  }
+
+  ThreadPool pool;
+  SphereBvh bvh;
+  auto start = Clock::now();
+  bvh.build(spheres.data(), spheres.size(), &pool);
+  std::printf("Built %zu spheres in %.1f ms (%zu nodes, %zu KB)\n", count,
+              millisecondsSince(start), bvh.getNodeCount(),
+              bvh.getMemoryBytes() / 1024);
+
+  checkRays(bvh, spheres, rng);
+  checkRadius(bvh, spheres, rng);
+  checkNearest(bvh, spheres, rng);
+  checkFrustum(bvh, spheres);
+  timeRays(bvh, rng);
+
+  // Move everything a little and check the refitted tree the same way
+  std::uniform_real_distribution<float> nudge(-1.0f, 1.0f);
+  for (glm::vec4& sphere : spheres) {
+    sphere += glm::vec4(nudge(rng), nudge(rng), nudge(rng), 0.0f);
+  }
+  start = Clock::now();
+  bvh.refit(spheres.data(), spheres.size(), &pool);
+  std::printf("Refitted in %.1f ms\n", millisecondsSince(start));
+  checkRays(bvh, spheres, rng);
+  checkRadius(bvh, spheres, rng);
+
+  // Trees too small to fill a leaf or a parallel subtree
+  for (size_t small : {1, 2, 3, 4, 5, 7, 8, 9, 17, 100}) {
+    if (small > spheres.size()) {
+      break;
+    }
+    std::vector<glm::vec4> subset(spheres.begin(), spheres.begin() + small);
+    SphereBvh smallBvh;
+    smallBvh.build(subset.data(), subset.size(), &pool);
+    checkRays(smallBvh, subset, rng);
+    std::vector<SphereBvh::Neighbor> nearest;
+    smallBvh.queryNearest(glm::vec3(0.0f), 3, nearest);
+    if (nearest.size() != std::min<size_t>(3, small)) {
+      fail("queryNearest on a small tree", static_cast<int>(small));
+    }
+  }
+
+  if (failures > 0) {
+    std::printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("All queries match the brute-force scan\n");
+  return 0;
+}
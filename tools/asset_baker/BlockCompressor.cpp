@@ -0,0 +1,192 @@
+#include "BlockCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+constexpr int PIXELS_PER_BLOCK = 16;
+
+uint16_t packRGB565(const float* color) {
+  const int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+  const int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+  const int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(uint16_t packed, int* color) {
+  const int r = (packed >> 11) & 31;
+  const int g = (packed >> 5) & 63;
+  const int b = packed & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+// Principal axis of the block colours via a few power iterations on the
+// covariance matrix; good enough for endpoint selection and much cheaper
+// than a full cluster fit
+void principalAxis(const unsigned char* rgba, const float* mean, float* axis) {
+  float covariance[6] = {0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+    const float r = rgba[i * 4 + 0] - mean[0];
+    const float g = rgba[i * 4 + 1] - mean[1];
+    const float b = rgba[i * 4 + 2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  float v[3] = {1.0f, 1.0f, 1.0f};
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    const float x = covariance[0] * v[0] + covariance[1] * v[1] + covariance[2] * v[2];
+    const float y = covariance[1] * v[0] + covariance[3] * v[1] + covariance[4] * v[2];
+    const float z = covariance[2] * v[0] + covariance[4] * v[1] + covariance[5] * v[2];
+    const float length = std::sqrt(x * x + y * y + z * z);
+    if (length < 1e-6f) {
+      break;
+    }
+    v[0] = x / length;
+    v[1] = y / length;
+    v[2] = z / length;
+  }
+
+  axis[0] = v[0];
+  axis[1] = v[1];
+  axis[2] = v[2];
+}
+}  // namespace
+
+void BlockCompressor::encodeBC1(const unsigned char* rgba, unsigned char* out) {
+  encodeColorBlock(rgba, out);
+}
+
+void BlockCompressor::encodeBC3(const unsigned char* rgba, unsigned char* out) {
+  encodeAlphaBlock(rgba, out);
+  encodeColorBlock(rgba, out + 8);
+}
+
+void BlockCompressor::encodeColorBlock(const unsigned char* rgba,
+                                       unsigned char* out) {
+  float mean[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+    mean[0] += rgba[i * 4 + 0];
+    mean[1] += rgba[i * 4 + 1];
+    mean[2] += rgba[i * 4 + 2];
+  }
+  for (float& channel : mean) {
+    channel /= PIXELS_PER_BLOCK;
+  }
+
+  float axis[3];
+  principalAxis(rgba, mean, axis);
+
+  float minT = 0.0f;
+  float maxT = 0.0f;
+  for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+    const float t = (rgba[i * 4 + 0] - mean[0]) * axis[0] +
+                    (rgba[i * 4 + 1] - mean[1]) * axis[1] +
+                    (rgba[i * 4 + 2] - mean[2]) * axis[2];
+    minT = std::min(minT, t);
+    maxT = std::max(maxT, t);
+  }
+
+  float maxColor[3];
+  float minColor[3];
+  for (int c = 0; c < 3; ++c) {
+    maxColor[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    minColor[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+  }
+
+  uint16_t color0 = packRGB565(maxColor);
+  uint16_t color1 = packRGB565(minColor);
+  // color0 > color1 selects the opaque 4-colour mode
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+
+  out[0] = static_cast<unsigned char>(color0 & 0xFF);
+  out[1] = static_cast<unsigned char>(color0 >> 8);
+  out[2] = static_cast<unsigned char>(color1 & 0xFF);
+  out[3] = static_cast<unsigned char>(color1 >> 8);
+
+  if (color0 == color1) {
+    out[4] = out[5] = out[6] = out[7] = 0;
+    return;
+  }
+
+  int palette[4][3];
+  unpackRGB565(color0, palette[0]);
+  unpackRGB565(color1, palette[1]);
+  for (int c = 0; c < 3; ++c) {
+    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+  }
+
+  uint32_t indices = 0;
+  for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+    int bestIndex = 0;
+    int bestDistance = 1 << 30;
+    for (int p = 0; p < 4; ++p) {
+      const int dr = rgba[i * 4 + 0] - palette[p][0];
+      const int dg = rgba[i * 4 + 1] - palette[p][1];
+      const int db = rgba[i * 4 + 2] - palette[p][2];
+      const int distance = dr * dr + dg * dg + db * db;
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        bestIndex = p;
+      }
+    }
+    indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+  }
+
+  out[4] = static_cast<unsigned char>(indices & 0xFF);
+  out[5] = static_cast<unsigned char>((indices >> 8) & 0xFF);
+  out[6] = static_cast<unsigned char>((indices >> 16) & 0xFF);
+  out[7] = static_cast<unsigned char>((indices >> 24) & 0xFF);
+}
+
+void BlockCompressor::encodeAlphaBlock(const unsigned char* rgba,
+                                       unsigned char* out) {
+  int alphaMin = 255;
+  int alphaMax = 0;
+  for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+    alphaMin = std::min(alphaMin, static_cast<int>(rgba[i * 4 + 3]));
+    alphaMax = std::max(alphaMax, static_cast<int>(rgba[i * 4 + 3]));
+  }
+
+  out[0] = static_cast<unsigned char>(alphaMax);
+  out[1] = static_cast<unsigned char>(alphaMin);
+
+  uint64_t indices = 0;
+  if (alphaMax != alphaMin) {
+    // alpha0 > alpha1: eight interpolated values
+    int palette[8];
+    palette[0] = alphaMax;
+    palette[1] = alphaMin;
+    for (int p = 1; p < 7; ++p) {
+      palette[p + 1] = ((7 - p) * alphaMax + p * alphaMin) / 7;
+    }
+
+    for (int i = 0; i < PIXELS_PER_BLOCK; ++i) {
+      const int alpha = rgba[i * 4 + 3];
+      int bestIndex = 0;
+      int bestDistance = 256;
+      for (int p = 0; p < 8; ++p) {
+        const int distance = std::abs(alpha - palette[p]);
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          bestIndex = p;
+        }
+      }
+      indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+    }
+  }
+
+  for (int byte = 0; byte < 6; ++byte) {
+    out[2 + byte] = static_cast<unsigned char>((indices >> (byte * 8)) & 0xFF);
+  }
+}
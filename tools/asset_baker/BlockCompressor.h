@@ -0,0 +1,22 @@
+#ifndef SOLAR_SYSTEM_OPENGL_BLOCKCOMPRESSOR_H
+#define SOLAR_SYSTEM_OPENGL_BLOCKCOMPRESSOR_H
+
+#include <cstddef>
+
+// CPU encoders for S3TC/DXT blocks. Input is always a 4x4 block of RGBA8
+// pixels (64 bytes, row-major); edge blocks are expected to be padded by
+// the caller.
+class BlockCompressor {
+ public:
+  static constexpr size_t BC1_BLOCK_SIZE = 8;
+  static constexpr size_t BC3_BLOCK_SIZE = 16;
+
+  static void encodeBC1(const unsigned char* rgba, unsigned char* out);
+  static void encodeBC3(const unsigned char* rgba, unsigned char* out);
+
+ private:
+  static void encodeColorBlock(const unsigned char* rgba, unsigned char* out);
+  static void encodeAlphaBlock(const unsigned char* rgba, unsigned char* out);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_BLOCKCOMPRESSOR_H
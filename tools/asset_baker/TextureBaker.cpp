@@ -0,0 +1,285 @@
+#include "TextureBaker.h"
+
+#include "BlockCompressor.h"
+
+#include <core/texturing/KtxFile.h>
+#include <core/threading/ThreadPool.h>
+
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+size_t blockSizeFor(BakeFormat format) {
+  return format == BakeFormat::BC1 ? BlockCompressor::BC1_BLOCK_SIZE
+                                   : BlockCompressor::BC3_BLOCK_SIZE;
+}
+
+const char* formatName(BakeFormat format) {
+  switch (format) {
+    case BakeFormat::BC1: return "BC1";
+    case BakeFormat::BC3: return "BC3";
+    case BakeFormat::Uncompressed: return "uncompressed";
+    default: return "auto";
+  }
+}
+}  // namespace
+
+TextureBaker::TextureBaker(ThreadPool& threadPool) : threadPool_(threadPool) {}
+
+bool TextureBaker::bakeTexture(const std::string& inputPath,
+                               const std::string& outputPath,
+                               const BakeOptions& options) {
+  Surface base;
+  if (!loadSurface(inputPath, options.flipVertically, base)) {
+    return false;
+  }
+
+  const BakeFormat format = resolveFormat(options.format, base.channels);
+  std::vector<std::vector<Surface>> faceChains;
+  faceChains.push_back(buildMipChain(std::move(base), options.generateMips));
+
+  return writeKtx(outputPath, format, faceChains);
+}
+
+bool TextureBaker::bakeCubemap(const std::vector<std::string>& facePaths,
+                               const std::string& outputPath,
+                               const BakeOptions& options) {
+  if (facePaths.size() != 6) {
+    std::cerr << "Cubemap needs 6 faces, got " << facePaths.size() << std::endl;
+    return false;
+  }
+
+  std::vector<std::vector<Surface>> faceChains;
+  int channels = 0;
+  for (const auto& path : facePaths) {
+    Surface face;
+    if (!loadSurface(path, options.flipVertically, face)) {
+      return false;
+    }
+    if (!faceChains.empty() &&
+        (face.width != faceChains.front().front().width ||
+         face.height != faceChains.front().front().height ||
+         face.channels != channels)) {
+      std::cerr << "Cubemap face " << path
+                << " does not match the size/channels of the first face"
+                << std::endl;
+      return false;
+    }
+    channels = face.channels;
+    faceChains.push_back(buildMipChain(std::move(face), options.generateMips));
+  }
+
+  return writeKtx(outputPath, resolveFormat(options.format, channels),
+                  faceChains);
+}
+
+bool TextureBaker::loadSurface(const std::string& path, bool flipVertically,
+                               Surface& surface) const {
+  stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+
+  unsigned char* data = stbi_load(path.c_str(), &surface.width,
+                                  &surface.height, &surface.channels, 0);
+  if (!data) {
+    std::cerr << "Failed to load " << path << ": " << stbi_failure_reason()
+              << std::endl;
+    return false;
+  }
+
+  // Two-channel images are not used by the renderer, expand them to RGBA
+  if (surface.channels == 2) {
+    stbi_image_free(data);
+    data = stbi_load(path.c_str(), &surface.width, &surface.height,
+                     &surface.channels, 4);
+    surface.channels = 4;
+  }
+
+  const size_t size = static_cast<size_t>(surface.width) * surface.height *
+                      surface.channels;
+  surface.pixels.assign(data, data + size);
+  stbi_image_free(data);
+  return true;
+}
+
+std::vector<TextureBaker::Surface> TextureBaker::buildMipChain(
+    Surface base, bool generateMips) {
+  std::vector<Surface> chain;
+  chain.push_back(std::move(base));
+
+  while (generateMips &&
+         (chain.back().width > 1 || chain.back().height > 1)) {
+    chain.push_back(downsample(chain.back()));
+  }
+  return chain;
+}
+
+TextureBaker::Surface TextureBaker::downsample(const Surface& source) {
+  Surface result;
+  result.width = std::max(1, source.width / 2);
+  result.height = std::max(1, source.height / 2);
+  result.channels = source.channels;
+  result.pixels.resize(static_cast<size_t>(result.width) * result.height *
+                       result.channels);
+
+  // 2x2 box filter, matches what glGenerateMipmap does on most drivers
+  for (int y = 0; y < result.height; ++y) {
+    const int y0 = std::min(y * 2, source.height - 1);
+    const int y1 = std::min(y * 2 + 1, source.height - 1);
+    for (int x = 0; x < result.width; ++x) {
+      const int x0 = std::min(x * 2, source.width - 1);
+      const int x1 = std::min(x * 2 + 1, source.width - 1);
+      for (int c = 0; c < source.channels; ++c) {
+        const auto at = [&](int sx, int sy) {
+          return static_cast<int>(
+              source.pixels[(static_cast<size_t>(sy) * source.width + sx) *
+                                source.channels +
+                            c]);
+        };
+        const int sum = at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1);
+        result.pixels[(static_cast<size_t>(y) * result.width + x) *
+                          result.channels +
+                      c] = static_cast<unsigned char>((sum + 2) / 4);
+      }
+    }
+  }
+  return result;
+}
+
+BakeFormat TextureBaker::resolveFormat(BakeFormat requested, int channels) {
+  if (channels == 1) {
+    // Single-channel data gains nothing from colour block compression
+    return BakeFormat::Uncompressed;
+  }
+  if (requested != BakeFormat::Auto) {
+    return requested;
+  }
+  return channels == 4 ? BakeFormat::BC3 : BakeFormat::BC1;
+}
+
+std::vector<unsigned char> TextureBaker::encodeSurface(const Surface& surface,
+                                                       BakeFormat format) {
+  if (format == BakeFormat::Uncompressed) {
+    return padRows(surface);
+  }
+
+  const int blocksX = (surface.width + 3) / 4;
+  const int blocksY = (surface.height + 3) / 4;
+  const size_t blockSize = blockSizeFor(format);
+  std::vector<unsigned char> encoded(static_cast<size_t>(blocksX) * blocksY *
+                                     blockSize);
+
+  const auto encodeRows = [&surface, &encoded, format, blocksX, blockSize](
+                              int firstRow, int lastRow) {
+    unsigned char block[64];
+    for (int by = firstRow; by < lastRow; ++by) {
+      for (int bx = 0; bx < blocksX; ++bx) {
+        // Gather the 4x4 block as RGBA, clamping at the surface edge
+        for (int py = 0; py < 4; ++py) {
+          const int sy = std::min(by * 4 + py, surface.height - 1);
+          for (int px = 0; px < 4; ++px) {
+            const int sx = std::min(bx * 4 + px, surface.width - 1);
+            const unsigned char* src =
+                &surface.pixels[(static_cast<size_t>(sy) * surface.width + sx) *
+                                surface.channels];
+            unsigned char* dst = &block[(py * 4 + px) * 4];
+            dst[0] = src[0];
+            dst[1] = surface.channels > 1 ? src[1] : src[0];
+            dst[2] = surface.channels > 2 ? src[2] : src[0];
+            dst[3] = surface.channels > 3 ? src[3] : 255;
+          }
+        }
+
+        unsigned char* out =
+            &encoded[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+        if (format == BakeFormat::BC1) {
+          BlockCompressor::encodeBC1(block, out);
+        } else {
+          BlockCompressor::encodeBC3(block, out);
+        }
+      }
+    }
+  };
+
+  // A few jobs per worker keeps the pool busy without much scheduling cost
+  const int jobCount = std::max(
+      1, std::min(blocksY, static_cast<int>(threadPool_.getThreadCount()) * 4));
+  const int rowsPerJob = (blocksY + jobCount - 1) / jobCount;
+  for (int first = 0; first < blocksY; first += rowsPerJob) {
+    const int last = std::min(blocksY, first + rowsPerJob);
+    threadPool_.submit([&encodeRows, first, last] { encodeRows(first, last); });
+  }
+  threadPool_.waitIdle();
+
+  return encoded;
+}
+
+std::vector<unsigned char> TextureBaker::padRows(const Surface& surface) {
+  // KTX stores uncompressed rows with GL_UNPACK_ALIGNMENT 4
+  const size_t rowSize = static_cast<size_t>(surface.width) * surface.channels;
+  const size_t paddedRowSize = (rowSize + 3) & ~static_cast<size_t>(3);
+
+  std::vector<unsigned char> padded(paddedRowSize * surface.height, 0);
+  for (int y = 0; y < surface.height; ++y) {
+    std::copy_n(&surface.pixels[y * rowSize], rowSize,
+                &padded[y * paddedRowSize]);
+  }
+  return padded;
+}
+
+bool TextureBaker::writeKtx(const std::string& outputPath, BakeFormat format,
+                            const std::vector<std::vector<Surface>>& faceChains) {
+  const auto startTime = std::chrono::steady_clock::now();
+  const Surface& base = faceChains.front().front();
+
+  KtxTexture header;
+  header.width = static_cast<uint32_t>(base.width);
+  header.height = static_cast<uint32_t>(base.height);
+  header.faces = static_cast<uint32_t>(faceChains.size());
+  header.levels = static_cast<uint32_t>(faceChains.front().size());
+
+  const uint32_t baseFormat = base.channels == 1   ? KtxGL::RED
+                              : base.channels == 3 ? KtxGL::RGB
+                                                   : KtxGL::RGBA;
+  header.glBaseInternalFormat = baseFormat;
+  if (format == BakeFormat::Uncompressed) {
+    header.glType = KtxGL::UNSIGNED_BYTE;
+    header.glFormat = baseFormat;
+    header.glInternalFormat = base.channels == 1   ? KtxGL::R8
+                              : base.channels == 3 ? KtxGL::RGB8
+                                                   : KtxGL::RGBA8;
+  } else {
+    header.glType = 0;
+    header.glFormat = 0;
+    header.glInternalFormat = format == BakeFormat::BC1
+                                  ? KtxGL::COMPRESSED_RGB_S3TC_DXT1
+                                  : KtxGL::COMPRESSED_RGBA_S3TC_DXT5;
+  }
+
+  std::vector<std::vector<std::vector<unsigned char>>> levelData(header.levels);
+  size_t sourceBytes = 0;
+  size_t bakedBytes = 0;
+  for (uint32_t level = 0; level < header.levels; ++level) {
+    for (const auto& chain : faceChains) {
+      sourceBytes += chain[level].pixels.size();
+      levelData[level].push_back(encodeSurface(chain[level], format));
+      bakedBytes += levelData[level].back().size();
+    }
+  }
+
+  std::string error;
+  if (!KtxFile::write(outputPath, header, levelData, error)) {
+    std::cerr << "Failed to write " << outputPath << ": " << error << std::endl;
+    return false;
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  std::cout << "Baked " << outputPath << ": " << base.width << "x"
+            << base.height << (header.faces == 6 ? " cubemap" : "") << ", "
+            << header.levels << " levels, " << formatName(format) << ", "
+            << sourceBytes / 1024 << " KB -> " << bakedBytes / 1024 << " KB ("
+            << elapsed.count() << " ms)" << std::endl;
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef SOLAR_SYSTEM_OPENGL_TEXTUREBAKER_H
+#define SOLAR_SYSTEM_OPENGL_TEXTUREBAKER_H
+
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+enum class BakeFormat {
+  Auto,          // BC1 for RGB, BC3 for RGBA, uncompressed for single channel
+  Uncompressed,  // R8 / RGB8 / RGBA8
+  BC1,
+  BC3
+};
+
+struct BakeOptions {
+  BakeFormat format = BakeFormat::Auto;
+  bool generateMips = true;
+  bool flipVertically = false;
+};
+
+// Converts decoded images into GPU-ready KTX files: full mip chain built on
+// the CPU and optional S3TC block compression spread over the thread pool.
+class TextureBaker {
+ public:
+  explicit TextureBaker(ThreadPool& threadPool);
+
+  bool bakeTexture(const std::string& inputPath, const std::string& outputPath,
+                   const BakeOptions& options);
+  // faces in GL order: +X, -X, +Y, -Y, +Z, -Z
+  bool bakeCubemap(const std::vector<std::string>& facePaths,
+                   const std::string& outputPath, const BakeOptions& options);
+
+ private:
+  struct Surface {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;  // tightly packed rows
+  };
+
+  ThreadPool& threadPool_;
+
+  bool loadSurface(const std::string& path, bool flipVertically,
+                   Surface& surface) const;
+  static std::vector<Surface> buildMipChain(Surface base, bool generateMips);
+  static Surface downsample(const Surface& source);
+  static BakeFormat resolveFormat(BakeFormat requested, int channels);
+
+  std::vector<unsigned char> encodeSurface(const Surface& surface,
+                                           BakeFormat format);
+  static std::vector<unsigned char> padRows(const Surface& surface);
+
+  bool writeKtx(const std::string& outputPath, BakeFormat format,
+                const std::vector<std::vector<Surface>>& faceChains);
+};
+
+#endif  // SOLAR_SYSTEM_OPENGL_TEXTUREBAKER_H
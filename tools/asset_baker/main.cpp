@@ -0,0 +1,140 @@
+// Offline texture baker: converts the JPG/PNG sources under textures/ into
+// KTX files with a precomputed mip chain and optional S3TC compression, so the
+// runtime can upload them without decoding or calling glGenerateMipmap.
+
+#include "TextureBaker.h"
+
+#include <core/threading/ThreadPool.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+void printUsage() {
+  std::cout
+      << "Usage: asset_baker <input_dir> <output_dir> [options]\n"
+         "  --format auto|none|bc1|bc3  block compression (default: auto)\n"
+         "  --no-mips                   store only the base level\n"
+         "  --threads N                 encoder threads (default: all cores)\n"
+         "  --cubemap NAME              faces NAME1..NAME6 become NAME.ktx\n"
+         "                              (default: skybox)\n";
+}
+
+bool parseFormat(const std::string& value, BakeFormat& format) {
+  if (value == "auto") format = BakeFormat::Auto;
+  else if (value == "none") format = BakeFormat::Uncompressed;
+  else if (value == "bc1") format = BakeFormat::BC1;
+  else if (value == "bc3") format = BakeFormat::BC3;
+  else return false;
+  return true;
+}
+
+bool isImage(const fs::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension == ".jpg" || extension == ".jpeg" || extension == ".png";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printUsage();
+    return 1;
+  }
+
+  const fs::path inputDir = argv[1];
+  const fs::path outputDir = argv[2];
+  BakeOptions options;
+  size_t threadCount = 0;
+  std::string cubemapName = "skybox";
+
+  for (int i = 3; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--format" && i + 1 < argc) {
+      if (!parseFormat(argv[++i], options.format)) {
+        std::cerr << "Unknown format: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--no-mips") {
+      options.generateMips = false;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threadCount = static_cast<size_t>(std::stoul(argv[++i]));
+    } else if (arg == "--cubemap" && i + 1 < argc) {
+      cubemapName = argv[++i];
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  if (!fs::is_directory(inputDir)) {
+    std::cerr << "Input directory not found: " << inputDir << std::endl;
+    return 1;
+  }
+  fs::create_directories(outputDir);
+
+  ThreadPool threadPool(threadCount);
+  TextureBaker baker(threadPool);
+
+  std::vector<fs::path> textures;
+  std::map<int, fs::path> cubemapFaces;
+  for (const auto& entry : fs::directory_iterator(inputDir)) {
+    if (!entry.is_regular_file() || !isImage(entry.path())) {
+      continue;
+    }
+
+    // NAME1..NAME6 are the cubemap faces in GL order (+X, -X, +Y, -Y, +Z, -Z)
+    const std::string stem = entry.path().stem().string();
+    if (stem.size() == cubemapName.size() + 1 &&
+        stem.compare(0, cubemapName.size(), cubemapName) == 0 &&
+        stem.back() >= '1' && stem.back() <= '6') {
+      cubemapFaces[stem.back() - '1'] = entry.path();
+      continue;
+    }
+    textures.push_back(entry.path());
+  }
+  std::sort(textures.begin(), textures.end());
+
+  int failures = 0;
+  for (const auto& texture : textures) {
+    const fs::path output =
+        outputDir / texture.filename().replace_extension(".ktx");
+    if (!baker.bakeTexture(texture.string(), output.string(), options)) {
+      ++failures;
+    }
+  }
+
+  if (!cubemapFaces.empty()) {
+    if (cubemapFaces.size() != 6) {
+      std::cerr << "Found " << cubemapFaces.size() << " of 6 faces for cubemap '"
+                << cubemapName << "', skipping" << std::endl;
+      ++failures;
+    } else {
+      std::vector<std::string> faces;
+      for (const auto& [index, path] : cubemapFaces) {
+        faces.push_back(path.string());
+      }
+
+      // The runtime loads cubemap faces flipped, bake them the same way
+      BakeOptions cubemapOptions = options;
+      cubemapOptions.flipVertically = true;
+      const fs::path output = outputDir / (cubemapName + ".ktx");
+      if (!baker.bakeCubemap(faces, output.string(), cubemapOptions)) {
+        ++failures;
+      }
+    }
+  }
+
+  if (failures > 0) {
+    std::cerr << failures << " texture(s) failed to bake" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+// Packs runtime assets into a single file that VirtualFileSystem memory-maps
+// at startup. Keys are the paths relative to <root_dir>, e.g.
+// "textures/sun.jpg", matching what the app asks for as "../textures/sun.jpg".
+
+#include <core/filesystem/PackFormat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct PackedFile {
+  std::string path;  // normalized key
+  fs::path source;
+  uint64_t hash = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+void printUsage() {
+  std::cout << "Usage: asset_packer <output.pak> <root_dir> <dir_or_file>...\n"
+               "  Entries are stored relative to root_dir.\n";
+}
+
+void writePadding(std::ofstream& out, uint64_t& position, uint64_t alignment) {
+  static const char zeros[64] = {};
+  const uint64_t padding = (alignment - position % alignment) % alignment;
+  out.write(zeros, static_cast<std::streamsize>(padding));
+  position += padding;
+}
+
+bool collect(const fs::path& root, const fs::path& input,
+             std::vector<PackedFile>& files) {
+  const fs::path full = root / input;
+  if (fs::is_regular_file(full)) {
+    files.push_back({Pack::normalizePath(input.generic_string()), full});
+    return true;
+  }
+  if (!fs::is_directory(full)) {
+    // Optional asset folders (e.g. audio/) may not be checked out
+    std::cerr << "Skipping missing " << full << std::endl;
+    return true;
+  }
+
+  for (const auto& entry : fs::recursive_directory_iterator(full)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    const fs::path relative = fs::relative(entry.path(), root);
+    files.push_back(
+        {Pack::normalizePath(relative.generic_string()), entry.path()});
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printUsage();
+    return 1;
+  }
+
+  const fs::path outputPath = argv[1];
+  const fs::path root = argv[2];
+
+  std::vector<PackedFile> files;
+  for (int i = 3; i < argc; ++i) {
+    if (!collect(root, argv[i], files)) {
+      return 1;
+    }
+  }
+
+  // Data is laid out in path order so files in one directory are read
+  // sequentially; the index itself is sorted by hash for lookups
+  std::sort(files.begin(), files.end(),
+            [](const PackedFile& a, const PackedFile& b) {
+              return a.path < b.path;
+            });
+
+  std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "Failed to open " << outputPath << " for writing"
+              << std::endl;
+    return 1;
+  }
+
+  Pack::Header header{};
+  std::memcpy(header.magic, Pack::MAGIC, sizeof(header.magic));
+  header.version = Pack::VERSION;
+  header.entryCount = static_cast<uint32_t>(files.size());
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t position = sizeof(header);
+
+  std::vector<char> buffer;
+  for (auto& file : files) {
+    writePadding(out, position, Pack::DATA_ALIGNMENT);
+
+    std::ifstream in(file.source, std::ios::binary | std::ios::ate);
+    if (!in) {
+      std::cerr << "Failed to read " << file.source << std::endl;
+      return 1;
+    }
+    const std::streamsize size = in.tellg();
+    in.seekg(0, std::ios::beg);
+    buffer.resize(static_cast<size_t>(size));
+    in.read(buffer.data(), size);
+
+    file.hash = Pack::hashPath(file.path);
+    file.offset = position;
+    file.size = static_cast<uint64_t>(size);
+    out.write(buffer.data(), size);
+    position += file.size;
+  }
+
+  // Index sorted by hash, ties broken by path so lookups can scan collisions
+  std::vector<const PackedFile*> byHash;
+  for (const auto& file : files) {
+    byHash.push_back(&file);
+  }
+  std::sort(byHash.begin(), byHash.end(),
+            [](const PackedFile* a, const PackedFile* b) {
+              return a->hash != b->hash ? a->hash < b->hash
+                                        : a->path < b->path;
+            });
+
+  writePadding(out, position, alignof(Pack::Entry));
+  header.indexOffset = position;
+
+  uint32_t stringOffset = 0;
+  for (const PackedFile* file : byHash) {
+    Pack::Entry entry{};
+    entry.pathHash = file->hash;
+    entry.offset = file->offset;
+    entry.size = file->size;
+    entry.pathOffset = stringOffset;
+    entry.pathLength = static_cast<uint32_t>(file->path.size());
+    out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    position += sizeof(entry);
+    stringOffset += entry.pathLength;
+  }
+
+  header.stringsOffset = position;
+  for (const PackedFile* file : byHash) {
+    out.write(file->path.data(),
+              static_cast<std::streamsize>(file->path.size()));
+    position += file->path.size();
+  }
+
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!out) {
+    std::cerr << "Failed to write " << outputPath << std::endl;
+    return 1;
+  }
+
+  std::cout << "Packed " << files.size() << " files into " << outputPath
+            << " (" << position / 1024 << " KB)" << std::endl;
+  return 0;
+}